@@ -1,5 +1,6 @@
 
 #include "NanoApp.h"
+#include "gui/nanogui/profiler.h"
 
 NanoApp::NanoApp()
 	: gui(nullptr)
@@ -91,6 +92,14 @@ void NanoApp::keyDown(KeyEvent event)
 		case KeyEvent::KEY_f:
 			setFullScreen(!isFullScreen());
 			break;
+
+		case KeyEvent::KEY_p:
+			gui->toggleProfile();
+			break;
+
+		case KeyEvent::KEY_t:
+			nanogui::Profiler::writeChromeTrace((getAppPath() / "nanogui_trace.json").string());
+			break;
 	}
 }
 
@@ -0,0 +1,22 @@
+// The demo windows of View, shared with the offline tools in bench/
+
+#pragma once
+
+#include "nanogui/screen.h"
+
+NAMESPACE_BEGIN (nanogui)
+class ImagePanel;
+class ImageView;
+class ProgressBar;
+NAMESPACE_END (nanogui)
+
+/// The demo widgets that are updated after they were created
+struct DemoWidgets
+{
+   nanogui::ImagePanel * imagePanel = nullptr;
+   nanogui::ImageView * imageView = nullptr;
+   nanogui::ProgressBar * progress = nullptr;
+};
+
+/// Create the demo windows on \c screen, which must have a theme, and lay them out
+DemoWidgets createDemoWindows (nanogui::Screen * screen);
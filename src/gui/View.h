@@ -7,6 +7,7 @@
 #include <cinder/app/Window.h>
 #include "nanogui/screen.h"
 #include "util/Performance.h"
+#include "util/NanoUtil.h"
 
 typedef std::shared_ptr<class View> ViewRef;
 
@@ -22,6 +23,7 @@ class View : public nanogui::Screen
 
       void create (ci::app::WindowRef & ciWindow);
       void draw (double time = 0.0);
+      void drawOverlay (NVGcontext * ctx) override;
       void resize (glm::ivec2 size)
       {
          setSize (size);
@@ -33,10 +35,17 @@ class View : public nanogui::Screen
       bool mouseUp (MouseEvent e);
 
       void updatePerfGraph (float dt, float cpuTime);
+      /// Toggle the flame graph of the last frame's profiler zones
+      void toggleProfile()
+      {
+         mShowProfile = !mShowProfile;
+      }
 
    private:
-      PerfGraph fps, cpuGraph, gpuGraph;
+      PerfGraph fps, cpuGraph, gpuGraph, drawCallGraph, uploadGraph;
       GPUtimer gpuTimer;
 	  nanogui::ProgressBar * mProgress = nullptr;
+      std::unique_ptr<ImageDirectoryLoader> mIconLoader;
+      bool mShowProfile = false;
 
 }; // end class View
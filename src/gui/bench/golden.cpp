@@ -0,0 +1,322 @@
+/*
+   bench/golden.cpp -- Golden image regression check of the demo windows
+
+   Creates the windows of the demo (see Demo.h) on a screen drawn by the software
+   renderer of nanovg_sw.h, without a window or an OpenGL context, and renders each
+   window and each popup on its own. Every result is written as PNG and compared
+   with the golden image of the same name.
+
+   Build from src/gui with the Cinder include paths, e.g.
+     cc -O2 -c nanovg/nanovg.c
+     c++ -O2 -std=c++14 bench/golden.cpp Demo.cpp <the .cpp files of nanogui/> nanovg.o <Cinder libraries> -o golden
+   and run
+     golden [-update] [-golden DIR] [-out DIR] [-threshold N] [-pixels F] [-sdf] [-tessellation N] [-glyphs N]
+
+   -golden      directory of the golden images (default bench/golden)
+   -out         directory the rendered images, and the differences of failed ones, are written to (default golden_out)
+   -update      write the rendered images as the new golden images instead of comparing
+   -threshold   largest difference of a color channel (0-255) that is still equal (default 0)
+   -pixels      fraction of the pixels that may differ by more than the threshold (default 0)
+
+   The remaining options render with the optimizations of the Screen enabled, to check
+   that they do not change the output: distance field text, deferred tessellation on N
+   threads and glyph rasterization on N threads. Distance field glyphs are not pixel exact,
+   compare them with a tolerance, e.g. -threshold 64 -pixels 0.015.
+
+   Returns 0 when every image matched its golden image.
+*/
+
+#include "../Demo.h"
+#include "../nanogui/window.h"
+#include "../nanogui/popupbutton.h"
+#include "../nanogui/theme.h"
+#include "../nanogui/imagepanel.h"
+#include "../nanogui/imageview.h"
+#include "../nanovg/nanovg.h"
+#include "../nanovg/stb_image.h"
+#define NANOVG_SW_IMPLEMENTATION
+#include "../nanovg/nanovg_sw.h"
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include "../nanovg/stb_image_write.h"
+#include <cinder/Filesystem.h>
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace nanogui;
+using namespace cinder;
+
+static const int Width = 1024;
+static const int Height = 768;
+/* Frames drawn at most until glyphs rasterized by threads have arrived */
+static const int MaxFrames = 100;
+
+struct Options
+{
+   std::string goldenDir = "bench/golden";
+   std::string outDir = "golden_out";
+   bool update = false;
+   int threshold = 0;
+   double pixels = 0;
+   bool sdf = false;
+   int tessellationThreads = 0;
+   int glyphThreads = 0;
+};
+
+/// A rendered image, RGBA8 rows top to bottom
+struct Image
+{
+   int width = 0, height = 0;
+   std::vector<unsigned char> pixels;
+};
+
+/// Compare two images, return whether they are equal within the options' tolerance
+static bool compare (const Image & a, const Image & b, const Options & options, Image * diff, std::string * message)
+{
+   if (a.width != b.width || a.height != b.height)
+   {
+      *message = "size " + std::to_string (a.width) + "x" + std::to_string (a.height) +
+                 ", golden " + std::to_string (b.width) + "x" + std::to_string (b.height);
+      return false;
+   }
+   diff->width = a.width;
+   diff->height = a.height;
+   diff->pixels.resize (a.pixels.size());
+   int differing = 0, maxDelta = 0;
+   for (size_t i = 0; i < a.pixels.size(); i += 4)
+   {
+      int delta = 0;
+      for (int c = 0; c < 4; c++)
+         delta = std::max (delta, std::abs (a.pixels[i + c] - b.pixels[i + c]));
+      maxDelta = std::max (maxDelta, delta);
+      /* Differences in red over a dimmed gray copy of the rendered image */
+      unsigned char gray = (unsigned char) ((a.pixels[i] + a.pixels[i + 1] + a.pixels[i + 2]) / 12);
+      bool differs = delta > options.threshold;
+      diff->pixels[i + 0] = differs ? 255 : gray;
+      diff->pixels[i + 1] = differs ? 0 : gray;
+      diff->pixels[i + 2] = differs ? 0 : gray;
+      diff->pixels[i + 3] = 255;
+      if (differs)
+         differing++;
+   }
+   double fraction = (double)differing / (a.width * a.height);
+   char str[128];
+   snprintf (str, sizeof (str), "%d pixels (%.4f%%) differ, max difference %d", differing, fraction * 100, maxDelta);
+   *message = str;
+   return fraction <= options.pixels;
+}
+
+/// Draw the screen until no glyphs are pending, return the region of \c window including its drop shadow
+static Image render (Screen * screen, const Window * window)
+{
+   NVGcontext * ctx = screen->getContext();
+   for (int i = 0; i < MaxFrames; i++)
+   {
+      nvgswClear (ctx, nvgRGBA (43, 51, 63, 255));
+      screen->performLayout (ctx);
+      screen->drawWidgets();
+      if (nvgPendingGlyphs (ctx) == 0)
+         break;
+   }
+   /* Popups draw their anchor arrow left of their bounds */
+   int pad = screen->theme()->mWindowDropShadowSize + 16;
+   int x0 = std::max (window->position().x - pad, 0), y0 = std::max (window->position().y - pad, 0);
+   int x1 = std::min (window->position().x + window->size().x + pad, Width);
+   int y1 = std::min (window->position().y + window->size().y + pad, Height);
+
+   int w, h;
+   const unsigned char * pixels = nvgswPixels (ctx, &w, &h);
+   Image image;
+   image.width = std::max (x1 - x0, 0);
+   image.height = std::max (y1 - y0, 0);
+   for (int y = y0; y < y1; y++)
+      image.pixels.insert (image.pixels.end(), pixels + (y * w + x0) * 4, pixels + (y * w + x1) * 4);
+   return image;
+}
+
+static bool writePng (const std::string & path, const Image & image)
+{
+   return stbi_write_png (path.c_str(), image.width, image.height, 4, image.pixels.data(), image.width * 4) != 0;
+}
+
+static bool loadPng (const std::string & path, Image * image)
+{
+   int n;
+   stbi_set_unpremultiply_on_load (0);
+   unsigned char * pixels = stbi_load (path.c_str(), &image->width, &image->height, &n, 4);
+   if (pixels == nullptr)
+      return false;
+   image->pixels.assign (pixels, pixels + image->width * image->height * 4);
+   stbi_image_free (pixels);
+   return true;
+}
+
+/// Return the button below \c widget which opens \c popup
+static PopupButton * findPopupButton (Widget * widget, const Popup * popup)
+{
+   PopupButton * button = dynamic_cast<PopupButton *> (widget);
+   if (button && button->popup() == popup)
+      return button;
+   for (Widget * child : widget->children())
+      if ((button = findPopupButton (child, popup)) != nullptr)
+         return button;
+   return nullptr;
+}
+
+/// Render one window, with the other windows hidden, and compare or update its golden image
+static bool check (Screen * screen, Window * window, const std::string & name, const Options & options)
+{
+   /* A popup is shown together with the windows it is attached to, with their buttons pushed */
+   std::vector<Window *> shown;
+   for (Window * w = window; w != nullptr;)
+   {
+      shown.push_back (w);
+      Popup * popup = dynamic_cast<Popup *> (w);
+      w = popup ? popup->parentWindow() : nullptr;
+   }
+   for (Widget * child : screen->children())
+   {
+      bool visible = std::find (shown.begin(), shown.end(), child) != shown.end();
+      child->setVisible (visible);
+      if (Popup * popup = dynamic_cast<Popup *> (child))
+         findPopupButton (screen, popup)->setPushed (visible);
+   }
+
+   Image image = render (screen, window);
+   std::string file = name + ".png";
+   if (options.update)
+   {
+      bool ok = writePng (options.goldenDir + "/" + file, image);
+      printf ("%-24s %s\n", name.c_str(), ok ? "updated" : "could not be written");
+      return ok;
+   }
+   if (!writePng (options.outDir + "/" + file, image))
+      printf ("%-24s could not be written to %s\n", name.c_str(), options.outDir.c_str());
+
+   Image golden, diff;
+   std::string message;
+   if (!loadPng (options.goldenDir + "/" + file, &golden))
+   {
+      printf ("%-24s FAILED, no golden image\n", name.c_str());
+      return false;
+   }
+   bool ok = compare (image, golden, options, &diff, &message);
+   printf ("%-24s %s, %s\n", name.c_str(), ok ? "ok" : "FAILED", message.c_str());
+   if (!ok && diff.width > 0)
+      writePng (options.outDir + "/" + name + ".diff.png", diff);
+   return ok;
+}
+
+/// Return a title or caption as a file name, e.g. "button_demo"
+static std::string fileName (const std::string & title)
+{
+   std::string name;
+   for (char c : title)
+      name += (c == ' ') ? '_' : (char)std::tolower ((unsigned char)c);
+   return name;
+}
+
+int main (int argc, char ** argv)
+{
+   Options options;
+   for (int i = 1; i < argc; i++)
+   {
+      std::string arg = argv[i];
+      bool value = i + 1 < argc;
+      if (arg == "-update")
+         options.update = true;
+      else
+         if (arg == "-sdf")
+            options.sdf = true;
+         else
+            if (arg == "-golden" && value)
+               options.goldenDir = argv[++i];
+            else
+               if (arg == "-out" && value)
+                  options.outDir = argv[++i];
+               else
+                  if (arg == "-threshold" && value)
+                     options.threshold = std::atoi (argv[++i]);
+                  else
+                     if (arg == "-pixels" && value)
+                        options.pixels = std::atof (argv[++i]);
+                     else
+                        if (arg == "-tessellation" && value)
+                           options.tessellationThreads = std::atoi (argv[++i]);
+                        else
+                           if (arg == "-glyphs" && value)
+                              options.glyphThreads = std::atoi (argv[++i]);
+                           else
+                           {
+                              fprintf (stderr, "usage: %s [-update] [-golden DIR] [-out DIR] [-threshold N] [-pixels F] "
+                                       "[-sdf] [-tessellation N] [-glyphs N]\n", argv[0]);
+                              return 2;
+                           }
+   }
+   fs::create_directories (options.update ? options.goldenDir : options.outDir);
+
+   NVGcontext * ctx = nvgCreateSW (Width, Height);
+   if (ctx == nullptr)
+   {
+      fprintf (stderr, "Could not create the software renderer!\n");
+      return 2;
+   }
+   int failed = 0, checked = 0;
+   try
+   {
+      ref<Screen> screen = new Screen (ctx);
+      screen->setTheme (new Theme (ctx));
+      screen->setSize (ivec2 (Width, Height));
+      screen->setDistanceFieldText (options.sdf);
+      screen->setTessellationThreads (options.tessellationThreads);
+      screen->setGlyphThreads (options.glyphThreads);
+
+      DemoWidgets demo = createDemoWindows (screen.get());
+      /* The demo loads its images from disk, generated ones are used instead */
+      ImagePanel::Images images;
+      std::vector<unsigned char> pixels (32 * 32 * 4);
+      for (int i = 0; i < 8; i++)
+      {
+         for (size_t p = 0; p < pixels.size(); p += 4)
+         {
+            int x = (int) (p / 4) % 32, y = (int) (p / 4) / 32;
+            pixels[p + 0] = (unsigned char) (i * 31 + x * 8);
+            pixels[p + 1] = (unsigned char) (255 - y * 8);
+            pixels[p + 2] = (unsigned char) ((x ^ y) * 8);
+            pixels[p + 3] = 255;
+         }
+         images.push_back (std::make_pair (nvgCreateImageRGBA (ctx, 32, 32, 0, pixels.data()), "icon" + std::to_string (i + 1)));
+      }
+      demo.imagePanel->setImages (images);
+      demo.imageView->setImage (images[0].first);
+
+      std::vector<Window *> windows;
+      for (Widget * child : screen->children())
+         if (Window * window = dynamic_cast<Window *> (child))
+            windows.push_back (window);
+      for (Window * window : windows)
+      {
+         /* Popups have no title, they are named after their button */
+         const Popup * popup = dynamic_cast<Popup *> (window);
+         PopupButton * button = popup ? findPopupButton (screen.get(), popup) : nullptr;
+         std::string name = button ? "popup_" + fileName (button->caption()) : fileName (window->title());
+         checked++;
+         if (!check (screen.get(), window, name, options))
+            failed++;
+      }
+   }
+   catch (const std::exception & e)
+   {
+      fprintf (stderr, "%s\n", e.what());
+      nvgDeleteSW (ctx);
+      return 2;
+   }
+   nvgDeleteSW (ctx);
+   if (!options.update)
+      printf ("%d of %d images match\n", checked - failed, checked);
+   return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,365 @@
+/*
+   bench/uibench.cpp -- Deterministic offline benchmark of the widget library
+
+   Builds synthetic widget trees, replays a fixed script of mouse input through
+   the Screen callbacks and draws every frame with the software renderer of
+   nanovg_sw.h, without a window or an OpenGL context. Reports the median and
+   99th percentile of the layout, draw, tessellation and flush times per frame
+   as JSON, e.g. for tracking regressions between builds.
+
+   Build from src/gui with the Cinder include paths, e.g.
+     cc -O2 -c nanovg/nanovg.c
+     c++ -O2 -std=c++14 bench/uibench.cpp <the .cpp files of nanogui/> nanovg.o <Cinder libraries> -o uibench
+   and run
+     uibench [-frames N] [-threads N] [-o results.json]
+
+   - layout: Screen::performLayout(), preferred sizes that did not change come from the cache
+   - draw: Widget::draw() of the whole tree, recording the NanoVG commands
+   - tessellation: nvgEndFrame() without the back-end calls; the paths are tessellated there
+     by -threads threads (default 1, see nvgDeferTessellation())
+   - flush: the render calls of the back-end, which rasterizes the frame as they arrive
+
+   The input, the widget trees and therefore the rendered pixels are the same on every
+   run, a checksum of the last frame of each scenario is part of the output.
+*/
+
+#include "../nanogui/screen.h"
+#include "../nanogui/window.h"
+#include "../nanogui/theme.h"
+#include "../nanogui/layout.h"
+#include "../nanogui/label.h"
+#include "../nanogui/button.h"
+#include "../nanogui/checkbox.h"
+#include "../nanogui/vscrollpanel.h"
+#include "../nanogui/imagepanel.h"
+#include "../nanovg/nanovg.h"
+#define NANOVG_SW_IMPLEMENTATION
+#include "../nanovg/nanovg_sw.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+using namespace nanogui;
+
+static const int Width = 1280;
+static const int Height = 720;
+static const int WarmupFrames = 10;
+
+typedef std::chrono::steady_clock Clock;
+
+static double elapsed (Clock::time_point start)
+{
+   return std::chrono::duration<double, std::milli> (Clock::now() - start).count();
+}
+
+/* The back-end is timed by wrapping its render calls in the parameters of the context */
+static NVGparams backend;
+static double backendTime = 0;
+
+static void timedRenderFlush (void * uptr)
+{
+   Clock::time_point start = Clock::now();
+   backend.renderFlush (uptr);
+   backendTime += elapsed (start);
+}
+
+static void timedRenderFill (void * uptr, NVGpaint * paint, NVGscissor * scissor, float fringe,
+                             const float * bounds, const NVGpath * paths, int npaths)
+{
+   Clock::time_point start = Clock::now();
+   backend.renderFill (uptr, paint, scissor, fringe, bounds, paths, npaths);
+   backendTime += elapsed (start);
+}
+
+static void timedRenderStroke (void * uptr, NVGpaint * paint, NVGscissor * scissor, float fringe,
+                               float strokeWidth, const NVGpath * paths, int npaths)
+{
+   Clock::time_point start = Clock::now();
+   backend.renderStroke (uptr, paint, scissor, fringe, strokeWidth, paths, npaths);
+   backendTime += elapsed (start);
+}
+
+static void timedRenderTriangles (void * uptr, NVGpaint * paint, NVGscissor * scissor,
+                                  const NVGvertex * verts, int nverts)
+{
+   Clock::time_point start = Clock::now();
+   backend.renderTriangles (uptr, paint, scissor, verts, nverts);
+   backendTime += elapsed (start);
+}
+
+/// Per frame times of one phase in milliseconds
+struct Samples
+{
+   std::vector<double> times;
+
+   double percentile (double p) const
+   {
+      if (times.empty())
+         return 0;
+      std::vector<double> sorted (times);
+      std::sort (sorted.begin(), sorted.end());
+      size_t rank = (size_t)std::ceil (p * sorted.size());
+      return sorted[std::min (sorted.size(), std::max (rank, (size_t)1)) - 1];
+   }
+};
+
+struct Result
+{
+   std::string name;
+   int widgets = 0;
+   Samples layout, draw, tessellation, flush;
+   double drawCalls = 0, verts = 0;
+   unsigned int checksum = 0;
+};
+
+static int countWidgets (const Widget * widget)
+{
+   int n = 1;
+   for (const Widget * child : widget->children())
+      n += countWidgets (child);
+   return n;
+}
+
+/* Widget trees */
+
+static void buildWindows (Screen * screen, int windows, int widgets)
+{
+   for (int i = 0; i < windows; i++)
+   {
+      Window * window = new Window (screen, "Window " + std::to_string (i));
+      window->setPosition (ivec2 (15 + (i % 6) * 210, 15 + (i / 6) * 40));
+      window->setLayout (new GroupLayout());
+      for (int j = 0; j < widgets; j++)
+      {
+         std::string caption = "Item " + std::to_string (j);
+         switch (j % 3)
+         {
+            case 0:
+               new Button (window, caption);
+               break;
+            case 1:
+               new Label (window, caption, j % 2 ? "sans-bold" : "sans");
+               break;
+            default:
+               new CheckBox (window, caption);
+               break;
+         }
+      }
+   }
+}
+
+static void buildNested (Screen * screen, int depth)
+{
+   Window * window = new Window (screen, "Nested");
+   window->setPosition (ivec2 (15, 15));
+   window->setLayout (new GroupLayout());
+   Widget * parent = window;
+   for (int i = 0; i < depth; i++)
+   {
+      new Label (parent, "Level " + std::to_string (i), "sans-bold");
+      new Button (parent, "Button");
+      new CheckBox (parent, "Check box");
+      Widget * group = new Widget (parent);
+      group->setLayout (new GroupLayout (4, 2, 4, 6));
+      parent = group;
+   }
+}
+
+static void buildImagePanel (Screen * screen, int images)
+{
+   NVGcontext * ctx = screen->getContext();
+   std::vector<unsigned char> pixels (32 * 32 * 4);
+   ImagePanel::Images data;
+   for (int i = 0; i < images; i++)
+   {
+      for (size_t p = 0; p < pixels.size(); p += 4)
+      {
+         size_t x = (p / 4) % 32, y = (p / 4) / 32;
+         pixels[p + 0] = (unsigned char) (i * 37 + x * 8);
+         pixels[p + 1] = (unsigned char) (i * 11 + y * 8);
+         pixels[p + 2] = (unsigned char) (x ^ y) * 8;
+         pixels[p + 3] = 255;
+      }
+      data.push_back (std::make_pair (nvgCreateImageRGBA (ctx, 32, 32, 0, pixels.data()), "image" + std::to_string (i)));
+   }
+   Window * window = new Window (screen, "Images");
+   window->setPosition (ivec2 (15, 15));
+   window->setLayout (new GroupLayout());
+   VScrollPanel * vscroll = new VScrollPanel (window);
+   vscroll->setFixedSize (ivec2 (1000, 600));
+   ImagePanel * panel = new ImagePanel (vscroll);
+   panel->setImages (data);
+}
+
+/* Frames */
+
+// The scripted input of a frame: the cursor moves on a Lissajous curve and
+// clicks every 20 frames, which also drags windows by their header.
+static void replayInput (Screen * screen, int frame)
+{
+   double x = Width * (0.5 + 0.45 * std::sin (frame * 0.05));
+   double y = Height * (0.5 + 0.45 * std::sin (frame * 0.031));
+   screen->cursorPosCallbackEvent (x, y);
+   if (frame % 20 == 0)
+      screen->mouseButtonCallbackEvent (MOUSE_BUTTON_LEFT, PRESS, 0);
+   else
+      if (frame % 20 == 3)
+         screen->mouseButtonCallbackEvent (MOUSE_BUTTON_LEFT, RELEASE, 0);
+}
+
+// What Screen::drawWidgets() does for a screen with an existing context, in separately timed phases
+static void drawFrame (Screen * screen, Result * result)
+{
+   NVGcontext * ctx = screen->getContext();
+   nvgswClear (ctx, nvgRGBA (40, 40, 40, 255));
+
+   Clock::time_point start = Clock::now();
+   screen->performLayout (ctx);
+   double layout = elapsed (start);
+
+   // Paths that are not deferred (e.g. text) reach the back-end while drawing
+   backendTime = 0;
+   start = Clock::now();
+   nvgBeginFrame (ctx, Width, Height, screen->pixelRatio());
+   screen->draw (ctx);
+   double draw = elapsed (start) - backendTime;
+
+   double drawBackend = backendTime;
+   start = Clock::now();
+   nvgEndFrame (ctx);
+   double endFrame = elapsed (start) - (backendTime - drawBackend);
+
+   if (result)
+   {
+      NVGframeStats stats;
+      nvgGetFrameStats (ctx, &stats);
+      result->layout.times.push_back (layout);
+      result->draw.times.push_back (draw);
+      result->tessellation.times.push_back (endFrame);
+      result->flush.times.push_back (backendTime);
+      result->drawCalls += stats.drawCalls;
+      result->verts += stats.verts;
+   }
+}
+
+static Result runScenario (const char * name, const std::function<void (Screen *)> & build, int frames, int threads)
+{
+   Result result;
+   result.name = name;
+   NVGcontext * ctx = nvgCreateSW (Width, Height);
+   if (ctx == nullptr)
+      throw std::runtime_error ("Could not create the software renderer!");
+   NVGparams * params = nvgInternalParams (ctx);
+   backend = *params;
+   params->renderFlush = timedRenderFlush;
+   params->renderFill = timedRenderFill;
+   params->renderStroke = timedRenderStroke;
+   params->renderTriangles = timedRenderTriangles;
+   nvgDeferTessellation (ctx, threads);
+   {
+      ref<Screen> screen = new Screen (ctx);
+      screen->setTheme (new Theme (ctx));
+      screen->setSize (ivec2 (Width, Height));
+      build (screen.get());
+      screen->performLayout (ctx);
+      result.widgets = countWidgets (screen.get());
+
+      // Fill the font atlas and the path caches before measuring
+      for (int i = 0; i < WarmupFrames; i++)
+         drawFrame (screen.get(), nullptr);
+      for (int i = 0; i < frames; i++)
+      {
+         replayInput (screen.get(), i);
+         drawFrame (screen.get(), &result);
+      }
+   }
+   result.drawCalls /= frames;
+   result.verts /= frames;
+
+   int w, h;
+   const unsigned char * pixels = nvgswPixels (ctx, &w, &h);
+   result.checksum = 2166136261u;
+   for (size_t i = 0; i < (size_t)w * h * 4; i++)
+      result.checksum = (result.checksum ^ pixels[i]) * 16777619u;
+   nvgDeleteSW (ctx);
+   return result;
+}
+
+static void writeSamples (FILE * f, const char * name, const Samples & samples)
+{
+   fprintf (f, "      \"%s\": { \"p50\": %.4f, \"p99\": %.4f },\n", name,
+            samples.percentile (0.5), samples.percentile (0.99));
+}
+
+int main (int argc, char ** argv)
+{
+   int frames = 300, threads = 1;
+   const char * path = nullptr;
+   for (int i = 1; i < argc; i++)
+   {
+      if (std::strcmp (argv[i], "-frames") == 0 && i + 1 < argc)
+         frames = std::max (1, std::atoi (argv[++i]));
+      else
+         if (std::strcmp (argv[i], "-threads") == 0 && i + 1 < argc)
+            threads = std::max (1, std::atoi (argv[++i]));
+         else
+            if (std::strcmp (argv[i], "-o") == 0 && i + 1 < argc)
+               path = argv[++i];
+            else
+            {
+               fprintf (stderr, "usage: %s [-frames N] [-threads N] [-o results.json]\n", argv[0]);
+               return 1;
+            }
+   }
+
+   std::vector<Result> results;
+   try
+   {
+      results.push_back (runScenario ("windows", [] (Screen * screen)
+      {
+         buildWindows (screen, 12, 24);
+      }, frames, threads));
+      results.push_back (runScenario ("nested", [] (Screen * screen)
+      {
+         buildNested (screen, 16);
+      }, frames, threads));
+      results.push_back (runScenario ("imagepanel", [] (Screen * screen)
+      {
+         buildImagePanel (screen, 600);
+      }, frames, threads));
+   }
+   catch (const std::exception & e)
+   {
+      fprintf (stderr, "%s\n", e.what());
+      return 1;
+   }
+
+   FILE * f = path ? fopen (path, "w") : stdout;
+   if (f == nullptr)
+   {
+      fprintf (stderr, "Could not write %s\n", path);
+      return 1;
+   }
+   fprintf (f, "{\n  \"width\": %d,\n  \"height\": %d,\n  \"frames\": %d,\n  \"tessellationThreads\": %d,\n  \"unit\": \"ms\",\n  \"scenarios\": [\n",
+            Width, Height, frames, threads);
+   for (size_t i = 0; i < results.size(); i++)
+   {
+      const Result & r = results[i];
+      fprintf (f, "    {\n      \"name\": \"%s\",\n      \"widgets\": %d,\n", r.name.c_str(), r.widgets);
+      writeSamples (f, "layout", r.layout);
+      writeSamples (f, "draw", r.draw);
+      writeSamples (f, "tessellation", r.tessellation);
+      writeSamples (f, "flush", r.flush);
+      fprintf (f, "      \"drawCalls\": %.1f,\n      \"verts\": %.0f,\n      \"checksum\": \"%08x\"\n    }%s\n",
+               r.drawCalls, r.verts, r.checksum, i + 1 < results.size() ? "," : "");
+   }
+   fprintf (f, "  ]\n}\n");
+   if (path)
+      fclose (f);
+   return 0;
+}
@@ -15,13 +15,17 @@ Button::Button (Widget * parent, const std::string & caption, int icon)
    : Widget (parent), mCaption (caption), mIcon (icon),
      mIconPosition (IconPosition::LeftCentered), mPushed (false),
      mFlags (NormalButton), mBackgroundColor (Colour (0, 0)),
-     mTextColor (Colour (0, 0))
+     mTextColor (Colour (0, 0)),
+     mCaptionShadowRun (nvgCreateTextRun()),
+     mCaptionRun (nvgCreateTextRun())
 {
 }
 
 // dtor
 Button::~Button ()
 {
+   nvgDeleteTextRun (mCaptionShadowRun);
+   nvgDeleteTextRun (mCaptionRun);
 }
 
 ivec2 Button::preferredSize (NVGcontext * ctx) const
@@ -71,7 +75,7 @@ bool Button::mouseButtonEvent (const ivec2 & p, int button, bool down, int modif
                {
                   Button * b = dynamic_cast<Button *> (widget);
                   if (b != this && b && b->flags() & RadioButton)
-                     b->mPushed = false;
+                     b->setPushed (false);
                }
             }
             else
@@ -79,7 +83,7 @@ bool Button::mouseButtonEvent (const ivec2 & p, int button, bool down, int modif
                for (auto b : mButtonGroup)
                {
                   if (b != this && b->flags() & RadioButton)
-                     b->mPushed = false;
+                     b->setPushed (false);
                }
             }
          }
@@ -89,7 +93,7 @@ bool Button::mouseButtonEvent (const ivec2 & p, int button, bool down, int modif
             {
                Button * b = dynamic_cast<Button *> (widget);
                if (b != this && b && b->flags() & PopupButton)
-                  b->mPushed = false;
+                  b->setPushed (false);
             }
          }
          if (mFlags & ToggleButton)
@@ -105,6 +109,8 @@ bool Button::mouseButtonEvent (const ivec2 & p, int button, bool down, int modif
             if (mFlags & NormalButton)
                mPushed = false;
          }
+      if (pushedBackup != mPushed)
+         markDirty();
       if (pushedBackup != mPushed && mChangeCallback)
          mChangeCallback (mPushed);
       return true;
@@ -128,13 +134,11 @@ void Button::draw (NVGcontext * ctx)
          gradTop = mTheme->mButtonGradientTopFocused;
          gradBot = mTheme->mButtonGradientBotFocused;
       }
-   nvgBeginPath (ctx);
-   nvgRoundedRect (ctx, mPos.x + 1, mPos.y + 1.0f, mSize.x - 2,
-                   mSize.y - 2, mTheme->mButtonCornerRadius - 1);
    if (mBackgroundColor.a != 0)
    {
-      nvgFillColor (ctx, Colour (mBackgroundColor.r, mBackgroundColor.g, mBackgroundColor.b, 1.f));
-      nvgFill (ctx);
+      nvgFillRoundedRectFast (ctx, mPos.x + 1, mPos.y + 1.0f, mSize.x - 2,
+                              mSize.y - 2, mTheme->mButtonCornerRadius - 1,
+                              Colour (mBackgroundColor.r, mBackgroundColor.g, mBackgroundColor.b, 1.f));
       if (mPushed)
          gradTop.a = gradBot.a = 0.8f;
       else
@@ -145,6 +149,9 @@ void Button::draw (NVGcontext * ctx)
    }
    NVGpaint bg = nvgLinearGradient (ctx, mPos.x, mPos.y, mPos.x,
                                     mPos.y + mSize.y, gradTop, gradBot);
+   nvgBeginPath (ctx);
+   nvgRoundedRect (ctx, mPos.x + 1, mPos.y + 1.0f, mSize.x - 2,
+                   mSize.y - 2, mTheme->mButtonCornerRadius - 1);
    nvgFillPaint (ctx, bg);
    nvgFill (ctx);
    nvgBeginPath (ctx);
@@ -222,9 +229,9 @@ void Button::draw (NVGcontext * ctx)
    nvgFontFace (ctx, "sans-bold");
    nvgTextAlign (ctx, NVG_ALIGN_LEFT | NVG_ALIGN_MIDDLE);
    nvgFillColor (ctx, mTheme->mTextColorShadow);
-   nvgText (ctx, textPos.x, textPos.y, mCaption.c_str(), nullptr);
+   nvgTextRun (ctx, mCaptionShadowRun, textPos.x, textPos.y, mCaption.c_str(), nullptr);
    nvgFillColor (ctx, textColor);
-   nvgText (ctx, textPos.x, textPos.y + 1, mCaption.c_str(), nullptr);
+   nvgTextRun (ctx, mCaptionRun, textPos.x, textPos.y + 1, mCaption.c_str(), nullptr);
 }
 
 NAMESPACE_END (nanogui)
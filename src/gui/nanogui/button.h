@@ -49,6 +49,8 @@ class Button : public Widget
       void setCaption (const std::string & caption)
       {
          mCaption = caption;
+         invalidateLayout();
+         markDirty();
       }
 
       const Colour & backgroundColor() const
@@ -58,6 +60,7 @@ class Button : public Widget
       void setBackgroundColor (const Colour & backgroundColor)
       {
          mBackgroundColor = backgroundColor;
+         markDirty();
       }
 
       const Colour & textColor() const
@@ -67,6 +70,7 @@ class Button : public Widget
       void setTextColor (const Colour & textColor)
       {
          mTextColor = textColor;
+         markDirty();
       }
 
       int icon() const
@@ -76,6 +80,8 @@ class Button : public Widget
       void setIcon (int icon)
       {
          mIcon = icon;
+         invalidateLayout();
+         markDirty();
       }
 
       int flags() const
@@ -85,6 +91,7 @@ class Button : public Widget
       void setFlags (int buttonFlags)
       {
          mFlags = buttonFlags;
+         markDirty();
       }
 
       IconPosition iconPosition() const
@@ -94,6 +101,8 @@ class Button : public Widget
       void setIconPosition (IconPosition iconPosition)
       {
          mIconPosition = iconPosition;
+         invalidateLayout();
+         markDirty();
       }
 
       bool pushed() const
@@ -102,7 +111,10 @@ class Button : public Widget
       }
       void setPushed (bool pushed)
       {
+         if (mPushed == pushed)
+            return;
          mPushed = pushed;
+         markDirty();
       }
 
       /// Set the push callback (for any type of button)
@@ -150,6 +162,8 @@ class Button : public Widget
       std::function<void()> mCallback;
       std::function<void (bool)> mChangeCallback;
       std::vector<Button *> mButtonGroup;
+      /* The shadow is drawn a pixel above the caption, each keeps its own quads */
+      NVGtextRun * mCaptionShadowRun, * mCaptionRun;
 }; // end class Button
 
 
@@ -19,7 +19,12 @@ NAMESPACE_BEGIN (nanogui)
 CheckBox::CheckBox (Widget * parent, const std::string & caption,
                     const std::function<void (bool) > & callback)
    : Widget (parent), mCaption (caption), mPushed (false), mChecked (false),
-     mCallback (callback) { }
+     mCallback (callback), mCaptionRun (nvgCreateTextRun()) { }
+
+CheckBox::~CheckBox()
+{
+   nvgDeleteTextRun (mCaptionRun);
+}
 
 bool CheckBox::mouseButtonEvent (const ivec2 & p, int button, bool down,
                                  int modifiers)
@@ -29,6 +34,7 @@ bool CheckBox::mouseButtonEvent (const ivec2 & p, int button, bool down,
       return false;
    if (button == MOUSE_BUTTON_LEFT)
    {
+      markDirty();
       if (down)
          mPushed = true;
       else
@@ -67,15 +73,18 @@ void CheckBox::draw (NVGcontext * ctx)
    nvgFillColor (ctx,
                  mEnabled ? mTheme->mTextColor : mTheme->mDisabledTextColor);
    nvgTextAlign (ctx, NVG_ALIGN_LEFT | NVG_ALIGN_MIDDLE);
-   nvgText (ctx, mPos.x + 1.2f * mSize.y + 5, mPos.y + mSize.y * 0.5f,
-            mCaption.c_str(), nullptr);
+   nvgTextRun (ctx, mCaptionRun, mPos.x + 1.2f * mSize.y + 5, mPos.y + mSize.y * 0.5f,
+               mCaption.c_str(), nullptr);
    NVGpaint bg = nvgBoxGradient (ctx, mPos.x + 1.5f, mPos.y + 1.5f,
                                  mSize.y - 2.0f, mSize.y - 2.0f, 3, 3,
                                  mPushed ? Colour (0, 100) : Colour (0, 32),
                                  Colour (0, 0, 0, 180));
+   const float box[] = { mPos.x + 1.0f, mPos.y + 1.0f, mSize.y - 2.0f,
+                         mSize.y - 2.0f, 3
+                       };
    nvgBeginPath (ctx);
-   nvgRoundedRect (ctx, mPos.x + 1.0f, mPos.y + 1.0f, mSize.y - 2.0f,
-                   mSize.y - 2.0f, 3);
+   if (!nvgCachedPath (ctx, RoundedRectShape, box, 5))
+      nvgRoundedRect (ctx, box[0], box[1], box[2], box[3], box[4]);
    nvgFillPaint (ctx, bg);
    nvgFill (ctx);
    if (mChecked)
@@ -20,6 +20,7 @@ class  CheckBox : public Widget
    public:
       CheckBox (Widget * parent, const std::string & caption = "Untitled",
                 const std::function<void (bool)> & callback = std::function<void (bool)>());
+      virtual ~CheckBox();
 
       const std::string & caption() const
       {
@@ -28,6 +29,8 @@ class  CheckBox : public Widget
       void setCaption (const std::string & caption)
       {
          mCaption = caption;
+         invalidateLayout();
+         markDirty();
       }
 
       const bool & checked() const
@@ -37,6 +40,7 @@ class  CheckBox : public Widget
       void setChecked (const bool & checked)
       {
          mChecked = checked;
+         markDirty();
       }
 
       const bool & pushed() const
@@ -46,6 +50,7 @@ class  CheckBox : public Widget
       void setPushed (const bool & pushed)
       {
          mPushed = pushed;
+         markDirty();
       }
 
       std::function<void (bool)> callback() const
@@ -64,6 +69,7 @@ class  CheckBox : public Widget
       std::string mCaption;
       bool mPushed, mChecked;
       std::function<void (bool)> mCallback;
+      NVGtextRun * mCaptionRun;
 };
 
 NAMESPACE_END (nanogui)
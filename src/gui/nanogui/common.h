@@ -31,6 +31,8 @@
 struct NVGcontext;
 struct NVGcolor;
 struct NVGglyphPosition;
+struct NVGrecording;
+struct NVGtextRun;
 
 NAMESPACE_BEGIN (nanogui)
 
@@ -47,6 +49,12 @@ enum class Cursor
    CursorCount
 };
 
+/* Shapes of the paths kept by nvgCachedPath(), i.e. the commands that build them from its values */
+enum CachedShape
+{
+   RoundedRectShape = 1   // nvgRoundedRect (x, y, w, h, r)
+};
+
 /* Import some common glm types */
 using ci::ivec2;
 using ci::ivec3;
@@ -152,6 +160,7 @@ class PopupButton;
 class ProgressBar;
 class Screen;
 class Slider;
+class SpatialIndex;
 class TextBox;
 class Theme;
 class ToolButton;
@@ -45,7 +45,12 @@ int ImagePanel::indexForPosition (const ivec2 & p) const
 bool ImagePanel::mouseMotionEvent (const ivec2 & p, const ivec2 & /* rel */,
                                    int /* button */, int /* modifiers */)
 {
-   mMouseIndex = indexForPosition (p);
+   int index = indexForPosition (p);
+   if (index != mMouseIndex)
+   {
+      mMouseIndex = index;
+      markDirty();
+   }
    return true;
 }
 
@@ -101,12 +106,7 @@ void ImagePanel::draw (NVGcontext * ctx)
       NVGpaint shadowPaint =
          nvgBoxGradient (ctx, p.x - 1, p.y, mThumbSize + 2, mThumbSize + 2, 5, 3,
                          nvgRGBA (0, 0, 0, 128), nvgRGBA (0, 0, 0, 0));
-      nvgBeginPath (ctx);
-      nvgRect (ctx, p.x - 5, p.y - 5, mThumbSize + 10, mThumbSize + 10);
-      nvgRoundedRect (ctx, p.x, p.y, mThumbSize, mThumbSize, 6);
-      nvgPathWinding (ctx, NVG_HOLE);
-      nvgFillPaint (ctx, shadowPaint);
-      nvgFill (ctx);
+      nvgDropShadowFast (ctx, p.x, p.y, mThumbSize, mThumbSize, 6, 5, shadowPaint);
       nvgBeginPath (ctx);
       nvgRoundedRect (ctx, p.x + 0.5f, p.y + 0.5f, mThumbSize - 1, mThumbSize - 1, 4 - 0.5f);
       nvgStrokeWidth (ctx, 1.0f);
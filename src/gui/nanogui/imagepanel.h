@@ -27,6 +27,8 @@ class ImagePanel : public Widget
       void setImages (const Images & data)
       {
          mImages = data;
+         invalidateLayout();
+         markDirty();
       }
       const Images & images() const
       {
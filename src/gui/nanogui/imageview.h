@@ -25,6 +25,8 @@ class  ImageView : public Widget
       void setImage (int img)
       {
          mImage = img;
+         invalidateLayout();
+         markDirty();
       }
       int  image() const
       {
@@ -16,12 +16,18 @@
 NAMESPACE_BEGIN (nanogui)
 
 Label::Label (Widget * parent, const std::string & caption, const std::string & font, int fontSize)
-   : Widget (parent), mCaption (caption), mFont (font)
+   : Widget (parent), mCaption (caption), mFont (font), mCaptionRun (nvgCreateTextRun())
 {
    mFontSize = fontSize < 0 ? mTheme->mStandardFontSize : fontSize;
    mColor = mTheme->mTextColor;
 }
 
+// dtor
+Label::~Label()
+{
+   nvgDeleteTextRun (mCaptionRun);
+}
+
 ivec2 Label::preferredSize (NVGcontext * ctx) const
 {
    if (mCaption == "")
@@ -61,7 +67,7 @@ void Label::draw (NVGcontext * ctx)
    else
    {
       nvgTextAlign (ctx, NVG_ALIGN_LEFT | NVG_ALIGN_MIDDLE);
-      nvgText (ctx, mPos.x, mPos.y + mSize.y * 0.5f, mCaption.c_str(), nullptr);
+      nvgTextRun (ctx, mCaptionRun, mPos.x, mPos.y + mSize.y * 0.5f, mCaption.c_str(), nullptr);
    }
 }
 
@@ -28,6 +28,7 @@ class Label : public Widget
    public:
       Label (Widget * parent, const std::string & caption,
              const std::string & font = "sans", int fontSize = -1);
+      virtual ~Label();
 
       /// Get the label's text caption
       const std::string & caption() const
@@ -38,12 +39,16 @@ class Label : public Widget
       void setCaption (const std::string & caption)
       {
          mCaption = caption;
+         invalidateLayout();
+         markDirty();
       }
 
       /// Set the currently active font (2 are available by default: 'sans' and 'sans-bold')
       void setFont (const std::string & font)
       {
          mFont = font;
+         invalidateLayout();
+         markDirty();
       }
       /// Get the currently active font
       const std::string & font() const
@@ -61,6 +66,7 @@ class Label : public Widget
       void setColor (Colour color)
       {
          mColor = color;
+         markDirty();
       }
 
       /// Compute the size needed to fully display the label
@@ -73,6 +79,7 @@ class Label : public Widget
       std::string mCaption;
       std::string mFont;
       Colour  mColor;
+      NVGtextRun * mCaptionRun;
 };
 
 NAMESPACE_END (nanogui)
\ No newline at end of file
@@ -40,7 +40,7 @@ ivec2 BoxLayout::preferredSize (NVGcontext * ctx, const Widget * widget) const
          first = false;
       else
          size[axis1] += mSpacing;
-      ivec2 ps = w->preferredSize (ctx), fs = w->fixedSize();
+      ivec2 ps = w->cachedPreferredSize (ctx), fs = w->fixedSize();
       ivec2 targetSize (
          fs[0] ? fs[0] : ps[0],
          fs[1] ? fs[1] : ps[1]
@@ -70,7 +70,7 @@ void BoxLayout::performLayout (NVGcontext * ctx, Widget * widget) const
          first = false;
       else
          position += mSpacing;
-      ivec2 ps = w->preferredSize (ctx), fs = w->fixedSize();
+      ivec2 ps = w->cachedPreferredSize (ctx), fs = w->fixedSize();
       ivec2 targetSize (
          fs[0] ? fs[0] : ps[0],
          fs[1] ? fs[1] : ps[1]
@@ -95,7 +95,7 @@ void BoxLayout::performLayout (NVGcontext * ctx, Widget * widget) const
       }
       w->setPosition (pos);
       w->setSize (targetSize);
-      w->performLayout (ctx);
+      w->updateLayout (ctx);
       position += targetSize[axis1];
    }
 }
@@ -114,7 +114,7 @@ ivec2 GroupLayout::preferredSize (NVGcontext * ctx, const Widget * widget) const
       if (!first)
          height += (label == nullptr) ? mSpacing : mGroupSpacing;
       first = false;
-      ivec2 ps = c->preferredSize (ctx), fs = c->fixedSize();
+      ivec2 ps = c->cachedPreferredSize (ctx), fs = c->fixedSize();
       ivec2 targetSize (
          fs[0] ? fs[0] : ps[0],
          fs[1] ? fs[1] : ps[1]
@@ -145,7 +145,7 @@ void GroupLayout::performLayout (NVGcontext * ctx, Widget * widget) const
       first = false;
       bool indentCur = indent && label == nullptr;
       ivec2 ps = ivec2 (availableWidth - (indentCur ? mGroupIndent : 0),
-                        c->preferredSize (ctx).y);
+                        c->cachedPreferredSize (ctx).y);
       ivec2 fs = c->fixedSize();
       ivec2 targetSize (
          fs[0] ? fs[0] : ps[0],
@@ -153,7 +153,7 @@ void GroupLayout::performLayout (NVGcontext * ctx, Widget * widget) const
       );
       c->setPosition (ivec2 (mMargin + (indentCur ? mGroupIndent : 0), height));
       c->setSize (targetSize);
-      c->performLayout (ctx);
+      c->updateLayout (ctx);
       height += targetSize.y;
       if (label)
          indent = !label->caption().empty();
@@ -197,7 +197,7 @@ void GridLayout::computeLayout (NVGcontext * ctx, const Widget * widget, std::ve
          if (child >= numChildren)
             return;
          Widget * w = widget->children()[child++];
-         ivec2 ps = w->preferredSize (ctx);
+         ivec2 ps = w->cachedPreferredSize (ctx);
          ivec2 fs = w->fixedSize();
          ivec2 targetSize (
             fs[0] ? fs[0] : ps[0],
@@ -258,7 +258,7 @@ void GridLayout::performLayout (NVGcontext * ctx, Widget * widget) const
          if (child >= numChildren)
             return;
          Widget * w = widget->children()[child++];
-         ivec2 ps = w->preferredSize (ctx);
+         ivec2 ps = w->cachedPreferredSize (ctx);
          ivec2 fs = w->fixedSize();
          ivec2 targetSize (
             fs[0] ? fs[0] : ps[0],
@@ -287,7 +287,7 @@ void GridLayout::performLayout (NVGcontext * ctx, Widget * widget) const
          }
          w->setPosition (itemPos);
          w->setSize (targetSize);
-         w->performLayout (ctx);
+         w->updateLayout (ctx);
          pos[axis1] += grid[axis1][i1] + mSpacing[axis1];
       }
       pos[axis2] += grid[axis2][i2] + mSpacing[axis2];
@@ -334,7 +334,7 @@ void AdvancedGridLayout::performLayout (NVGcontext * ctx, Widget * widget) const
          Anchor anchor = this->anchor (w);
          int itemPos = grid[axis][anchor.pos[axis]];
          int cellSize = grid[axis][anchor.pos[axis] + anchor.size[axis]] - itemPos;
-         int ps = w->preferredSize (ctx)[axis], fs = w->fixedSize()[axis];
+         int ps = w->cachedPreferredSize (ctx)[axis], fs = w->fixedSize()[axis];
          int targetSize = fs ? fs : ps;
          switch (anchor.align[axis])
          {
@@ -355,7 +355,7 @@ void AdvancedGridLayout::performLayout (NVGcontext * ctx, Widget * widget) const
          size[axis] = targetSize;
          w->setPosition (pos);
          w->setSize (size);
-         w->performLayout (ctx);
+         w->updateLayout (ctx);
       }
    }
 }
@@ -386,7 +386,7 @@ void AdvancedGridLayout::computeLayout (NVGcontext * ctx, const Widget * widget,
             const Anchor & anchor = pair.second;
             if ((anchor.size[axis] == 1) != (phase == 0))
                continue;
-            int ps = w->preferredSize (ctx)[axis], fs = w->fixedSize()[axis];
+            int ps = w->cachedPreferredSize (ctx)[axis], fs = w->fixedSize()[axis];
             int targetSize = fs ? fs : ps;
             if (anchor.pos[axis] + anchor.size[axis] > grid.size())
                throw std::runtime_error (
@@ -20,6 +20,8 @@ Popup::Popup (Widget * parent, Window * parentWindow)
    : Window (parent, ""), mParentWindow (parentWindow),
      mAnchorPos (ivec2 (0)), mAnchorHeight (30)
 {
+   /* draw() follows the parent window, so it has to run every frame */
+   mRetained = false;
 }
 
 void Popup::performLayout (NVGcontext * ctx)
@@ -30,15 +32,15 @@ void Popup::performLayout (NVGcontext * ctx)
    {
       mChildren[0]->setPosition (ivec2 (0));
       mChildren[0]->setSize (mSize);
-      mChildren[0]->performLayout (ctx);
+      mChildren[0]->updateLayout (ctx);
    }
 }
 
 void Popup::refreshRelativePlacement()
 {
    mParentWindow->refreshRelativePlacement();
-   mVisible &= mParentWindow->visibleRecursive();
-   mPos = mParentWindow->position() + mAnchorPos - ivec2 (0, mAnchorHeight);
+   setVisible (mVisible && mParentWindow->visibleRecursive());
+   setPosition (mParentWindow->position() + mAnchorPos - ivec2 (0, mAnchorHeight));
 }
 
 void Popup::draw (NVGcontext * ctx)
@@ -51,18 +53,14 @@ void Popup::draw (NVGcontext * ctx)
    NVGpaint shadowPaint = nvgBoxGradient (
                              ctx, mPos.x, mPos.y, mSize.x, mSize.y, cr * 2, ds * 2,
                              mTheme->mDropShadow, mTheme->mTransparent);
+   nvgDropShadowFast (ctx, mPos.x, mPos.y, mSize.x, mSize.y, cr, ds, shadowPaint);
+   /* Draw the window body and its anchor arrow as two convex fills. The arrow ends at the
+      left edge of the body, overlapping it would blend a translucent color twice. */
+   nvgFillRoundedRectFast (ctx, mPos.x, mPos.y, mSize.x, mSize.y, cr, mTheme->mWindowPopup);
    nvgBeginPath (ctx);
-   nvgRect (ctx, mPos.x - ds, mPos.y - ds, mSize.x + 2 * ds, mSize.y + 2 * ds);
-   nvgRoundedRect (ctx, mPos.x, mPos.y, mSize.x, mSize.y, cr);
-   nvgPathWinding (ctx, NVG_HOLE);
-   nvgFillPaint (ctx, shadowPaint);
-   nvgFill (ctx);
-   /* Draw window */
-   nvgBeginPath (ctx);
-   nvgRoundedRect (ctx, mPos.x, mPos.y, mSize.x, mSize.y, cr);
    nvgMoveTo (ctx, mPos.x - 15, mPos.y + mAnchorHeight);
-   nvgLineTo (ctx, mPos.x + 1, mPos.y + mAnchorHeight - 15);
-   nvgLineTo (ctx, mPos.x + 1, mPos.y + mAnchorHeight + 15);
+   nvgLineTo (ctx, mPos.x, mPos.y + mAnchorHeight - 15);
+   nvgLineTo (ctx, mPos.x, mPos.y + mAnchorHeight + 15);
    nvgFillColor (ctx, mTheme->mWindowPopup);
    nvgFill (ctx);
    Widget::draw (ctx);
@@ -36,6 +36,7 @@ class Popup : public Window
       void setAnchorPos (const ivec2 & anchorPos)
       {
          mAnchorPos = anchorPos;
+         markDirty();
       }
       /// Set the anchor position in the parent window; the placement of the popup is relative to it
       const ivec2 & anchorPos() const
@@ -47,6 +48,7 @@ class Popup : public Window
       void setAnchorHeight (int anchorHeight)
       {
          mAnchorHeight = anchorHeight;
+         markDirty();
       }
       /// Return the anchor height; this determines the vertical shift relative to the anchor position
       int anchorHeight() const
@@ -28,6 +28,7 @@ class  PopupButton : public Button
       void setChevronIcon (int icon)
       {
          mChevronIcon = icon;
+         markDirty();
       }
       int chevronIcon() const
       {
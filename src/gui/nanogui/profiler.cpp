@@ -0,0 +1,389 @@
+/*
+   src/profiler.cpp -- Hierarchical CPU profiler with scoped zones, a flame
+   graph overlay and Chrome trace export
+
+   NanoGUI was developed by Wenzel Jakob <wenzel@inf.ethz.ch>.
+   The widget drawing code is based on the NanoVG demo application
+   by Mikko Mononen.
+
+   All rights reserved. Use of this source code is governed by a
+   BSD-style license that can be found in the LICENSE.txt file.
+*/
+
+#include "profiler.h"
+#include "widget.h"
+#include "../nanovg/nanovg.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#if defined(__GNUG__)
+   #include <cxxabi.h>
+   #include <cstdlib>
+#endif
+
+NAMESPACE_BEGIN (nanogui)
+
+/* Ring of the completed zones of a thread. Only its thread writes it, the
+   mutex guards against the readers, so it is hardly ever contended */
+struct ProfileBuffer
+{
+   std::mutex mutex;
+   std::vector<Profiler::Zone> zones;
+   size_t head = 0, count = 0;
+   int depth = 0;
+   int thread = 0;
+   bool inUse = true;
+};
+
+std::atomic<bool> Profiler::sEnabled (false);
+
+namespace
+{
+   typedef std::chrono::steady_clock Clock;
+
+   const Clock::time_point epoch = Clock::now();
+
+   double now()
+   {
+      return std::chrono::duration<double> (Clock::now() - epoch).count();
+   }
+
+   std::mutex buffersMutex;
+   /* Buffers outlive their thread, so that the trace keeps its zones, and
+      are handed to the next thread that starts recording */
+   std::vector<std::unique_ptr<ProfileBuffer>> buffers;
+   ProfileBuffer * uiBuffer = nullptr;
+   double lastFrame = -1, frameStart = -1, frameEnd = -1;
+
+   struct ThreadBuffer
+   {
+      ProfileBuffer * buffer = nullptr;
+      ~ThreadBuffer()
+      {
+         if (!buffer)
+            return;
+         std::lock_guard<std::mutex> lock (buffersMutex);
+         buffer->inUse = false;
+         buffer->depth = 0;
+      }
+   };
+   thread_local ThreadBuffer threadBuffer;
+
+   ProfileBuffer * currentBuffer()
+   {
+      if (threadBuffer.buffer)
+         return threadBuffer.buffer;
+      std::lock_guard<std::mutex> lock (buffersMutex);
+      for (auto & buffer : buffers)
+      {
+         if (!buffer->inUse)
+         {
+            buffer->inUse = true;
+            threadBuffer.buffer = buffer.get();
+            return buffer.get();
+         }
+      }
+      buffers.emplace_back (new ProfileBuffer());
+      ProfileBuffer * buffer = buffers.back().get();
+      buffer->zones.resize (Profiler::RingSize);
+      buffer->thread = (int)buffers.size() - 1;
+      threadBuffer.buffer = buffer;
+      return buffer;
+   }
+
+   typedef std::vector<std::pair<int, Profiler::Zone>> ThreadZones;
+
+   /* Copy the zones of every buffer, oldest first, that start within [from, to), with their thread */
+   void collect (ThreadZones & zones, double from, double to)
+   {
+      std::lock_guard<std::mutex> lock (buffersMutex);
+      for (auto & buffer : buffers)
+      {
+         std::lock_guard<std::mutex> bufferLock (buffer->mutex);
+         size_t first = (buffer->head + Profiler::RingSize - buffer->count) % Profiler::RingSize;
+         for (size_t i = 0; i < buffer->count; i++)
+         {
+            const Profiler::Zone & zone = buffer->zones[ (first + i) % Profiler::RingSize];
+            if (zone.start >= from && zone.start < to)
+               zones.push_back (std::make_pair (buffer->thread, zone));
+         }
+      }
+   }
+
+   std::string typeName (const std::type_info * type)
+   {
+      if (!type)
+         return std::string();
+      static std::mutex namesMutex;
+      static std::map<const std::type_info *, std::string> names;
+      std::lock_guard<std::mutex> lock (namesMutex);
+      auto it = names.find (type);
+      if (it != names.end())
+         return it->second;
+      std::string name = type->name();
+#if defined(__GNUG__)
+      int status = 0;
+      char * demangled = abi::__cxa_demangle (name.c_str(), nullptr, nullptr, &status);
+      if (status == 0 && demangled)
+         name = demangled;
+      std::free (demangled);
+#endif
+      for (const char * prefix : { "class ", "struct ", "nanogui::" })
+      {
+         size_t pos;
+         while ((pos = name.find (prefix)) != std::string::npos)
+            name.erase (pos, strlen (prefix));
+      }
+      names[type] = name;
+      return name;
+   }
+
+   std::string jsonString (const std::string & str)
+   {
+      std::string result = "\"";
+      for (char c : str)
+      {
+         if (c == '"' || c == '\\')
+         {
+            result += '\\';
+            result += c;
+         }
+         else
+            if ((unsigned char)c < 0x20)
+            {
+               char hex[8];
+               snprintf (hex, sizeof (hex), "\\u%04x", c);
+               result += hex;
+            }
+            else
+               result += c;
+      }
+      return result + "\"";
+   }
+}
+
+void Profiler::setEnabled (bool enabled)
+{
+   sEnabled = enabled;
+}
+
+void Profiler::frame()
+{
+   double t = now();
+   std::lock_guard<std::mutex> lock (buffersMutex);
+   if (lastFrame >= 0)
+   {
+      frameStart = lastFrame;
+      frameEnd = t;
+   }
+   lastFrame = t;
+   if (enabled() && threadBuffer.buffer)
+      uiBuffer = threadBuffer.buffer;
+}
+
+void Profiler::clear()
+{
+   std::lock_guard<std::mutex> lock (buffersMutex);
+   for (auto & buffer : buffers)
+   {
+      std::lock_guard<std::mutex> bufferLock (buffer->mutex);
+      buffer->head = buffer->count = 0;
+   }
+}
+
+std::vector<Profiler::Stats> Profiler::zoneStats()
+{
+   ThreadZones zones;
+   collect (zones, frameStart, frameEnd);
+   std::map<std::tuple<std::string, std::string, std::string>, Stats> stats;
+   for (auto & threadZone : zones)
+   {
+      const Zone & zone = threadZone.second;
+      std::string type = typeName (zone.type);
+      Stats & s = stats[std::make_tuple (std::string (zone.name), type, zone.id)];
+      if (s.calls == 0)
+      {
+         s.name = zone.name;
+         s.type = type;
+         s.id = zone.id;
+      }
+      s.calls++;
+      s.total += zone.end - zone.start;
+      s.max = std::max (s.max, zone.end - zone.start);
+   }
+   std::vector<Stats> result;
+   for (auto & s : stats)
+      result.push_back (s.second);
+   std::sort (result.begin(), result.end(), [] (const Stats & a, const Stats & b)
+   {
+      return a.total > b.total;
+   });
+   return result;
+}
+
+void Profiler::drawFlameGraph (NVGcontext * ctx, float x, float y, float w, float h)
+{
+   if (frameEnd < 0)
+      return;
+   ThreadZones zones;
+   collect (zones, frameStart, frameEnd);
+   int uiThread = uiBuffer ? uiBuffer->thread : 0;
+
+   /* One band per thread with zones, the UI thread on top, a row per depth */
+   std::map<int, int> bandDepth;
+   for (auto & threadZone : zones)
+   {
+      int & rows = bandDepth[threadZone.first == uiThread ? -1 : threadZone.first];
+      rows = std::max (rows, threadZone.second.depth + 1);
+   }
+   std::map<int, int> bandRow;
+   int rows = 0;
+   for (auto & band : bandDepth)
+   {
+      bandRow[band.first] = rows;
+      rows += band.second;
+   }
+
+   const float header = 16.0f;
+   float rowHeight = rows > 0 ? std::min (14.0f, (h - header) / rows) : 14.0f;
+   double budget = 1.0 / 60.0;
+   double span = std::max (frameEnd - frameStart, budget);
+   float scale = (float) (w / span);
+
+   nvgSave (ctx);
+   nvgBeginPath (ctx);
+   nvgRect (ctx, x, y, w, h);
+   nvgFillColor (ctx, nvgRGBA (0, 0, 0, 160));
+   nvgFill (ctx);
+
+   nvgFontFace (ctx, "sans");
+   nvgFontSize (ctx, 12.0f);
+   nvgTextAlign (ctx, NVG_ALIGN_LEFT | NVG_ALIGN_MIDDLE);
+   for (auto & threadZone : zones)
+   {
+      const Zone & zone = threadZone.second;
+      float zx = x + (float) (zone.start - frameStart) * scale;
+      float zy = y + header + (bandRow[threadZone.first == uiThread ? -1 : threadZone.first] + zone.depth) * rowHeight;
+      float zw = std::max (1.0f, (float) (zone.end - zone.start) * scale);
+      unsigned hash = 2166136261u;
+      for (const char * c = zone.name; *c; c++)
+         hash = (hash ^ (unsigned char) *c) * 16777619u;
+      nvgBeginPath (ctx);
+      nvgRect (ctx, zx, zy, zw, rowHeight - 1);
+      nvgFillColor (ctx, nvgHSLA ((hash % 360) / 360.0f, 0.6f, 0.45f, 220));
+      nvgFill (ctx);
+      if (zw > 30 && rowHeight >= 10)
+      {
+         std::string label = zone.name;
+         if (zone.type)
+            label += " " + typeName (zone.type);
+         if (!zone.id.empty())
+            label += "#" + zone.id;
+         nvgSave (ctx);
+         nvgIntersectScissor (ctx, zx, zy, zw, rowHeight);
+         nvgFillColor (ctx, nvgRGBA (255, 255, 255, 230));
+         nvgText (ctx, zx + 2, zy + rowHeight * 0.5f, label.c_str(), nullptr);
+         nvgRestore (ctx);
+      }
+   }
+
+   /* The frame budget, and the most expensive zone of the frame */
+   float bx = x + (float)budget * scale;
+   nvgBeginPath (ctx);
+   nvgMoveTo (ctx, bx, y);
+   nvgLineTo (ctx, bx, y + h);
+   nvgStrokeColor (ctx, nvgRGBA (255, 64, 64, 200));
+   nvgStrokeWidth (ctx, 1.0f);
+   nvgStroke (ctx);
+
+   char str[160];
+   snprintf (str, sizeof (str), "Frame %.2f ms", (frameEnd - frameStart) * 1000.0);
+   std::vector<Stats> stats = zoneStats();
+   for (const Stats & s : stats)
+   {
+      if (s.type.empty())
+         continue;
+      size_t len = strlen (str);
+      snprintf (str + len, sizeof (str) - len, ", slowest %s %s%s%s %.2f ms in %d",
+                s.name.c_str(), s.type.c_str(), s.id.empty() ? "" : "#", s.id.c_str(),
+                s.total * 1000.0, s.calls);
+      break;
+   }
+   nvgFontSize (ctx, 14.0f);
+   nvgFillColor (ctx, nvgRGBA (240, 240, 240, 220));
+   nvgText (ctx, x + 3, y + header * 0.5f, str, nullptr);
+   nvgRestore (ctx);
+}
+
+bool Profiler::writeChromeTrace (const std::string & path)
+{
+   std::ofstream out (path);
+   if (!out)
+      return false;
+   ThreadZones zones;
+   collect (zones, -1.0, 1e300);
+   int uiThread = uiBuffer ? uiBuffer->thread : -1;
+   int threads;
+   {
+      std::lock_guard<std::mutex> lock (buffersMutex);
+      threads = (int)buffers.size();
+   }
+
+   out << "{\"traceEvents\":[\n";
+   for (int i = 0; i < threads; i++)
+   {
+      out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << i
+          << ",\"args\":{\"name\":" << (i == uiThread ? "\"UI\"" : jsonString ("Thread " + std::to_string (i)))
+          << "}},\n";
+   }
+   char times[64];
+   for (size_t i = 0; i < zones.size(); i++)
+   {
+      const Zone & zone = zones[i].second;
+      snprintf (times, sizeof (times), "\"ts\":%.3f,\"dur\":%.3f", zone.start * 1e6, (zone.end - zone.start) * 1e6);
+      out << "{\"name\":" << jsonString (zone.name) << ",\"cat\":\"nanogui\",\"ph\":\"X\",\"pid\":0,\"tid\":"
+          << zones[i].first << "," << times;
+      if (zone.type)
+         out << ",\"args\":{\"type\":" << jsonString (typeName (zone.type)) << ",\"id\":" << jsonString (zone.id) << "}";
+      out << "}" << (i + 1 < zones.size() ? ",\n" : "\n");
+   }
+   out << "]}\n";
+   return (bool)out;
+}
+
+void ProfileZone::begin (const char * name, const Widget * widget)
+{
+   mBuffer = currentBuffer();
+   mName = name;
+   mWidget = widget;
+   mBuffer->depth++;
+   mStart = now();
+}
+
+void ProfileZone::end()
+{
+   double t = now();
+   ProfileBuffer * buffer = mBuffer;
+   buffer->depth--;
+   std::lock_guard<std::mutex> lock (buffer->mutex);
+   Profiler::Zone & zone = buffer->zones[buffer->head];
+   buffer->head = (buffer->head + 1) % Profiler::RingSize;
+   buffer->count = std::min (buffer->count + 1, (size_t)Profiler::RingSize);
+   zone.name = mName;
+   zone.type = mWidget ? &typeid (*mWidget) : nullptr;
+   if (mWidget)
+      zone.id = mWidget->id();
+   else
+      zone.id.clear();
+   zone.start = mStart;
+   zone.end = t;
+   zone.depth = buffer->depth;
+}
+
+NAMESPACE_END (nanogui)
@@ -0,0 +1,117 @@
+/*
+   nanogui/profiler.h -- Hierarchical CPU profiler with scoped zones, a flame
+   graph overlay and Chrome trace export
+
+   NanoGUI was developed by Wenzel Jakob <wenzel@inf.ethz.ch>.
+   The widget drawing code is based on the NanoVG demo application
+   by Mikko Mononen.
+
+   All rights reserved. Use of this source code is governed by a
+   BSD-style license that can be found in the LICENSE.txt file.
+*/
+
+#pragma once
+
+#include "common.h"
+#include <atomic>
+#include <string>
+#include <typeinfo>
+
+NAMESPACE_BEGIN (nanogui)
+
+/**
+   \brief Hierarchical CPU profiler
+
+   Time is measured in zones, scopes marked with a \ref ProfileZone. Every thread
+   records its completed zones into a ring buffer of its own, which keeps the
+   most recent \ref RingSize zones. Zones may name the widget they work on, and
+   are then aggregated per widget type and id (see \ref zoneStats()).
+
+   The widgets time their drawing, layout and preferred size computations, and
+   the screen its event dispatch and the NanoVG frame. Disabled (the default),
+   a zone costs a single relaxed atomic load.
+*/
+class Profiler
+{
+   public:
+      /// Number of completed zones kept per thread
+      static const int RingSize = 16384;
+
+      /// A completed zone, times in seconds since the profiler started
+      struct Zone
+      {
+         const char * name = nullptr;
+         const std::type_info * type = nullptr;
+         std::string id;
+         double start = 0, end = 0;
+         int depth = 0;
+      };
+
+      /// Time spent in the zones of a name and a widget type and id
+      struct Stats
+      {
+         std::string name, type, id;
+         int calls = 0;
+         double total = 0, max = 0;
+      };
+
+      /// Set whether zones are recorded
+      static void setEnabled (bool enabled);
+      /// Return whether zones are recorded
+      static bool enabled()
+      {
+         return sEnabled.load (std::memory_order_relaxed);
+      }
+
+      /// Mark the start of a frame (called by \ref Screen::drawWidgets()); the overlay and the statistics cover the last complete frame
+      static void frame();
+      /// Discard all recorded zones
+      static void clear();
+
+      /// Return the statistics of the zones of the last complete frame, most expensive first
+      static std::vector<Stats> zoneStats();
+      /// Draw the zones of the last complete frame as a flame graph, one band per thread
+      static void drawFlameGraph (NVGcontext * ctx, float x, float y, float w, float h);
+      /// Write all recorded zones as a Chrome trace (chrome://tracing, Perfetto), return whether that succeeded
+      static bool writeChromeTrace (const std::string & path);
+
+   private:
+      static std::atomic<bool> sEnabled;
+
+}; // end class Profiler
+
+/**
+   \brief Scoped profiler zone, timed from construction to destruction
+
+   \c name must be a string literal (or otherwise outlive the profiler). When a
+   \c widget is given, the zone is attributed to its type and \ref Widget::id().
+*/
+class ProfileZone
+{
+   public:
+      ProfileZone (const char * name, const Widget * widget = nullptr)
+      {
+         if (Profiler::enabled())
+            begin (name, widget);
+      }
+      ~ProfileZone()
+      {
+         if (mBuffer)
+            end();
+      }
+
+      ProfileZone (const ProfileZone &) = delete;
+      ProfileZone & operator= (const ProfileZone &) = delete;
+
+   private:
+      struct ProfileBuffer * mBuffer = nullptr;
+      const char * mName;
+      const Widget * mWidget;
+      double mStart;
+
+      void begin (const char * name, const Widget * widget);
+      void end();
+
+}; // end class ProfileZone
+
+NAMESPACE_END (nanogui)
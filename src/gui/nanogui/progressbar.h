@@ -28,7 +28,10 @@ class ProgressBar : public Widget
       }
       void setValue (float value)
       {
+         if (mValue == value)
+            return;
          mValue = value;
+         markDirty();
       }
 
       virtual ivec2 preferredSize (NVGcontext * ctx) const;
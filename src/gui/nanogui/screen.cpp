@@ -14,11 +14,14 @@
 #include "screen.h"
 #include "window.h"
 #include "theme.h"
+#include "profiler.h"
 #include "cinder/gl/gl.h"
 
 /* Allow enforcing the GL2 implementation of NanoVG */
 #define NANOVG_GL3_IMPLEMENTATION
+#define NVGL_PROFILE_ZONE(name) nanogui::ProfileZone nvglProfileZone (name)
 #include "../nanovg/nanovg_gl.h"
+#include "../nanovg/nanovg_gl_utils.h"
 
 NAMESPACE_BEGIN (nanogui)
 
@@ -28,9 +31,9 @@ Screen::Screen()
 {
 
 #ifdef NDEBUG
-   mNVGContext = nvgCreateGL3 (NVG_STENCIL_STROKES | NVG_ANTIALIAS);
+   mNVGContext = nvgCreateGL3 (NVG_STENCIL_STROKES | NVG_ANTIALIAS | NVG_RING_BUFFER | NVG_BATCH_CALLS);
 #else
-   mNVGContext = nvgCreateGL3 (NVG_STENCIL_STROKES | NVG_ANTIALIAS | NVG_DEBUG);
+   mNVGContext = nvgCreateGL3 (NVG_STENCIL_STROKES | NVG_ANTIALIAS | NVG_RING_BUFFER | NVG_BATCH_CALLS | NVG_DEBUG);
 #endif
    if (mNVGContext == nullptr)
       throw std::runtime_error ("Could not initialize NanoVG!");
@@ -38,20 +41,76 @@ Screen::Screen()
    start = std::chrono::system_clock::now();
 }
 
+Screen::Screen (NVGcontext * ctx)
+   : Widget (nullptr), mNVGContext (ctx), mOwnsContext (false), mPartialRedraw (false)
+{
+   if (mNVGContext == nullptr)
+      throw std::runtime_error ("Screen needs a NanoVG context!");
+
+   start = std::chrono::system_clock::now();
+}
+
 // dtor
 Screen::~Screen ()
 {
-   if (mNVGContext)
+   nvgluDeleteFramebuffer (mFramebuffer);
+   if (mNVGContext && mOwnsContext)
       nvgDeleteGL3 (mNVGContext);
 }
 
+void Screen::setTessellationThreads (int threads)
+{
+   mTessellationThreads = nvgDeferTessellation (mNVGContext, threads);
+}
+
+void Screen::setGlyphThreads (int threads)
+{
+   mGlyphThreads = nvgAsyncGlyphs (mNVGContext, threads);
+}
+
+void Screen::setDistanceFieldText (bool enabled)
+{
+   if (enabled != mDistanceFieldText && nvgTextSDF (mNVGContext, enabled ? 1 : 0))
+   {
+      mDistanceFieldText = enabled;
+      /* Text is measured from other glyphs, the cached preferred sizes are stale */
+      invalidateLayoutTree();
+      damageAll();
+   }
+}
+
 void Screen::drawWidgets()
 {
+   Profiler::frame();
+   mFrameStats = NVGframeStats();
    if (!mVisible)
       return;
-   float aspect = (float)mSize[0] / (float)mSize[1];
+   ProfileZone zone ("drawWidgets");
+   float aspect = pixelRatio();
+   if (mPartialRedraw && (!mFramebuffer || mFramebufferSize != mSize))
+   {
+      nvgluDeleteFramebuffer (mFramebuffer);
+      mFramebuffer = nvgluCreateFramebuffer (mNVGContext, mSize.x, mSize.y, 0);
+      mFramebufferSize = mSize;
+      /* Fall back to drawing directly if framebuffers are not available */
+      mPartialRedraw = mFramebuffer != nullptr;
+      damageAll();
+   }
+   if (mPartialRedraw)
+   {
+      drawDamaged (aspect);
+      composite (aspect);
+      return;
+   }
    nvgBeginFrame (mNVGContext, mSize[0], mSize[1], aspect);
    draw (mNVGContext);
+   drawOverlay (mNVGContext);
+   mDamaged = false;
+   if (!mOwnsContext)
+   {
+      endFrame();
+      return;
+   }
 
    // work around for Cinder not rendering after nanovg
    ci::gl::ScopedGlslProg scopedProg (nullptr);
@@ -59,11 +118,107 @@ void Screen::drawWidgets()
    ci::gl::ScopedTextureBind text (GL_TEXTURE_2D, 0);
    //ci::gl::ScopedDepth depth(false, false);  // FIXME causes GL errors
 
+   endFrame();
+}
+
+void Screen::drawDamaged (float pixelRatio)
+{
+   /* Popups follow their parent window; move them now so that the old and
+      the new placement are part of this frame's damage */
+   for (auto child : mChildren)
+   {
+      Window * window = dynamic_cast<Window *> (child);
+      if (window)
+         window->refreshRelativePlacement();
+   }
+   if (!mDamaged)
+      return;
+   /* Damage reported while drawing (e.g. by a PopupButton showing its popup)
+      is redrawn in the next frame */
+   ivec2 lo = cwiseMax (mDamageMin, ivec2 (0)), hi = cwiseMin (mDamageMax, mSize);
+   mDamaged = false;
+   if (lo.x >= hi.x || lo.y >= hi.y)
+      return;
+   /* glScissor() counts rows from the bottom of the framebuffer */
+   int x = lo.x, y = mSize.y - hi.y, w = hi.x - lo.x, h = hi.y - lo.y;
+
+   GLint defaultFBO, viewport[4];
+   glGetIntegerv (GL_FRAMEBUFFER_BINDING, &defaultFBO);
+   glGetIntegerv (GL_VIEWPORT, viewport);
+   nvgluBindFramebuffer (mFramebuffer);
+   glViewport (0, 0, mSize.x, mSize.y);
+   glEnable (GL_SCISSOR_TEST);
+   glScissor (x, y, w, h);
+   glClearColor (0.0f, 0.0f, 0.0f, 0.0f);
+   glClearStencil (0);
+   glClear (GL_COLOR_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+   glDisable (GL_SCISSOR_TEST);
+
+   nvglClipRect (mNVGContext, x, y, w, h);
+   nvgBeginFrame (mNVGContext, mSize[0], mSize[1], pixelRatio);
+   draw (mNVGContext);
+   endFrame();
+   nvglResetClipRect (mNVGContext);
+   /* Text drawn with placeholders for glyphs still being rasterized is drawn
+      again in the next frame */
+   if (nvgPendingGlyphs (mNVGContext) > 0)
+      damageAll();
+
+   glBindFramebuffer (GL_FRAMEBUFFER, defaultFBO);
+   glViewport (viewport[0], viewport[1], viewport[2], viewport[3]);
+}
+
+void Screen::composite (float pixelRatio)
+{
+   nvgBeginFrame (mNVGContext, mSize[0], mSize[1], pixelRatio);
+   /* The framebuffer is bottom up, a flipped image is sampled upwards from its origin */
+   NVGpaint paint = nvgImagePattern (mNVGContext, 0, mSize.y, mSize.x, mSize.y, 0,
+                                     mFramebuffer->image, 1.0f);
+   nvgBeginPath (mNVGContext);
+   nvgRect (mNVGContext, 0, 0, mSize.x, mSize.y);
+   nvgFillPaint (mNVGContext, paint);
+   nvgFill (mNVGContext);
+   drawOverlay (mNVGContext);
+
+   // work around for Cinder not rendering after nanovg
+   ci::gl::ScopedGlslProg scopedProg (nullptr);
+   ci::gl::ScopedVao scopedVao (nullptr);
+   ci::gl::ScopedTextureBind text (GL_TEXTURE_2D, 0);
+
+   endFrame();
+}
+
+void Screen::endFrame()
+{
+   ProfileZone zone ("nvgEndFrame");
    nvgEndFrame (mNVGContext);
+   NVGframeStats stats;
+   nvgGetFrameStats (mNVGContext, &stats);
+   /* Every counter is an int */
+   int * sum = (int *)&mFrameStats;
+   const int * add = (const int *)&stats;
+   for (size_t i = 0; i < sizeof (stats) / sizeof (int); i++)
+      sum[i] += add[i];
+}
+
+void Screen::damage (const ivec2 & pos, const ivec2 & size)
+{
+   /* Pad by the drop shadow, which windows draw outside of their bounds */
+   int pad = (mTheme ? mTheme->mWindowDropShadowSize : 0) + 2;
+   ivec2 lo = pos - ivec2 (pad), hi = pos + size + ivec2 (pad);
+   if (mDamaged)
+   {
+      lo = cwiseMin (lo, mDamageMin);
+      hi = cwiseMax (hi, mDamageMax);
+   }
+   mDamageMin = lo;
+   mDamageMax = hi;
+   mDamaged = true;
 }
 
 bool Screen::cursorPosCallbackEvent (double x, double y)
 {
+   ProfileZone zone ("cursorPosEvent");
    auto end = std::chrono::system_clock::now();
    ivec2 p ((int)x, (int)y);
    bool ret = false;
@@ -103,6 +258,7 @@ bool Screen::cursorPosCallbackEvent (double x, double y)
 
 bool Screen::mouseButtonCallbackEvent (int button, int action, int modifiers)
 {
+   ProfileZone zone ("mouseButtonEvent");
    auto end = std::chrono::system_clock::now();
    mModifiers = modifiers;
    mLastInteraction = end - start;
@@ -177,7 +333,7 @@ void Screen::centerWindow (Window * window)
 {
    if (window->size() == ivec2 (0))
    {
-      window->setSize (window->preferredSize (mNVGContext));
+      window->setSize (window->cachedPreferredSize (mNVGContext));
       window->performLayout (mNVGContext);
    }
    window->setPosition ((mSize - window->size()) / 2);
@@ -194,6 +350,7 @@ void Screen::disposeWindow (Window * window)
 
 bool Screen::resizeCallbackEvent (int width, int height)
 {
+   ProfileZone zone ("resizeEvent");
    auto end = std::chrono::system_clock::now();
    mLastInteraction = end - start;
    try
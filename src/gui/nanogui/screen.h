@@ -16,6 +16,9 @@
 #pragma once
 #include <chrono>
 #include "widget.h"
+#include "../nanovg/nanovg.h"
+
+struct NVGLUframebuffer;
 
 NAMESPACE_BEGIN (nanogui)
 
@@ -26,9 +29,28 @@ class Screen : public Widget
 
    public:
       Screen();
+      /**
+         \brief Create a screen drawing with an existing NanoVG context
+
+         Allows drawing without a window, e.g. with the software renderer of
+         nanovg_sw.h. The context stays owned by the caller, the OpenGL state is
+         not touched and the widgets are always drawn directly (see
+         \ref setPartialRedraw()).
+      */
+      explicit Screen (NVGcontext * ctx);
       virtual ~Screen();
 
       virtual void drawWidgets();
+      /**
+         \brief Draw on top of the widgets, e.g. statistics or debug overlays
+
+         Called by \ref drawWidgets() every frame, within the NanoVG frame that puts
+         the widgets on screen. Unlike the widgets, the overlay is not kept in the
+         framebuffer of the partial redraw, and is not clipped to the damaged region.
+      */
+      virtual void drawOverlay (NVGcontext * /* ctx */)
+      {
+      }
       bool cursorPosCallbackEvent (double x, double y);
       bool mouseButtonCallbackEvent (int button, int action, int modifiers);
       bool resizeCallbackEvent (int width, int height);
@@ -50,8 +72,113 @@ class Screen : public Widget
          return mNVGContext;
       }
 
+      /**
+         \brief Add a rectangle (in screen coordinates) to the region redrawn by the next \ref drawWidgets()
+
+         Widgets report their bounds here through \ref Widget::markDirty(), so this
+         normally only needs to be called for changes that bypass the widget setters.
+      */
+      void damage (const ivec2 & pos, const ivec2 & size);
+
+      /// Redraw the whole screen on the next call to \ref drawWidgets()
+      void damageAll()
+      {
+         damage (ivec2 (0), mSize);
+      }
+
+      /// Return whether there is a damaged region that will be redrawn by the next \ref drawWidgets()
+      bool damaged() const
+      {
+         return mDamaged;
+      }
+
+      /**
+         \brief Set whether only the damaged region is redrawn
+
+         When enabled (the default), the widgets are rendered into a persistent
+         framebuffer, of which only the damaged region is cleared and drawn again,
+         and which is then composited over the application. When disabled, all
+         widgets are drawn directly every frame. Screens created with an existing
+         context always draw directly.
+      */
+      void setPartialRedraw (bool partialRedraw)
+      {
+         mPartialRedraw = partialRedraw && mOwnsContext;
+         damageAll();
+      }
+      /// Return whether only the damaged region is redrawn (see \ref setPartialRedraw())
+      bool partialRedraw() const
+      {
+         return mPartialRedraw;
+      }
+
+      /**
+         \brief Set the number of threads tessellating the paths of a frame
+
+         When non-zero, fills and strokes are only queued while the widgets draw,
+         and are tessellated in parallel by that many threads when the frame ends.
+         0 (the default) tessellates every path as it is drawn. Must not be called
+         while drawing.
+      */
+      void setTessellationThreads (int threads);
+      /// Return the number of threads tessellating the paths of a frame (see \ref setTessellationThreads())
+      int tessellationThreads() const
+      {
+         return mTessellationThreads;
+      }
+      /**
+         \brief Set the number of threads rasterizing glyphs missing from the font atlas
+
+         When non-zero, text using glyphs that were not drawn before is laid out right
+         away, but the new glyphs are drawn with a placeholder until a thread has
+         rasterized them, and the screen is redrawn once they are available. 0 (the
+         default) rasterizes glyphs when they are first drawn. Must not be called
+         while drawing.
+      */
+      void setGlyphThreads (int threads);
+      /// Return the number of threads rasterizing glyphs (see \ref setGlyphThreads())
+      int glyphThreads() const
+      {
+         return mGlyphThreads;
+      }
+      /**
+         \brief Draw text from signed distance field glyphs
+
+         Each glyph is then rasterized once and shared by all font sizes, icon sizes,
+         blurs and pixel ratios, instead of once per size. Edges are slightly softer at
+         large sizes. Must not be called while drawing.
+      */
+      void setDistanceFieldText (bool enabled);
+      /// Return whether text is drawn from distance field glyphs (see \ref setDistanceFieldText())
+      bool distanceFieldText() const
+      {
+         return mDistanceFieldText;
+      }
+      /**
+         \brief Return the pixel ratio the widgets are drawn with
+
+         This is the width / height ratio of the screen, not the ratio of framebuffer to
+         window pixels: the screen has always begun its NanoVG frames with it. It
+         changes when the screen is resized to another aspect.
+      */
+      float pixelRatio() const
+      {
+         return (float)mSize[0] / (float)mSize[1];
+      }
+      /**
+         \brief Return the NanoVG counters of the last \ref drawWidgets()
+
+         Summed over all frames it began and ended, i.e. the redraw of the damaged
+         region and the composite when partial redraw is enabled.
+      */
+      const NVGframeStats & frameStats() const
+      {
+         return mFrameStats;
+      }
+
    protected:
       NVGcontext * mNVGContext = nullptr;
+      bool mOwnsContext = true;
       bool mDragActive = false;
       Widget * mDragWidget = nullptr;
       int mMouseState = 0;
@@ -63,6 +190,23 @@ class Screen : public Widget
 
       ivec2 mMousePos;
 
+      bool mPartialRedraw = true;
+      int mTessellationThreads = 0;
+      int mGlyphThreads = 0;
+      bool mDistanceFieldText = false;
+      bool mDamaged = false;
+      ivec2 mDamageMin, mDamageMax;
+      NVGLUframebuffer * mFramebuffer = nullptr;
+      ivec2 mFramebufferSize;
+      NVGframeStats mFrameStats = {};
+
+      /// Draw all widgets into the framebuffer, restricted to the damaged region
+      void drawDamaged (float pixelRatio);
+      /// Draw the framebuffer over the current render target
+      void composite (float pixelRatio);
+      /// End the NanoVG frame and add its counters to \ref frameStats()
+      void endFrame();
+
 }; // end class Screen
 
 NAMESPACE_END (nanogui)
\ No newline at end of file
@@ -0,0 +1,118 @@
+/*
+   src/spatialindex.cpp -- Uniform grid over the children of a widget,
+   used to speed up hit-testing in containers with many children
+
+   NanoGUI was developed by Wenzel Jakob <wenzel@inf.ethz.ch>.
+   The widget drawing code is based on the NanoVG demo application
+   by Mikko Mononen.
+
+   All rights reserved. Use of this source code is governed by a
+   BSD-style license that can be found in the LICENSE.txt file.
+*/
+
+#include "spatialindex.h"
+#include "widget.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+NAMESPACE_BEGIN (nanogui)
+
+// ctor
+SpatialIndex::SpatialIndex()
+   : mOrigin (ivec2 (0)),
+     mCellSize (ivec2 (1)),
+     mCells (ivec2 (0))
+{
+}
+
+void SpatialIndex::build (const std::vector<Widget *> & children)
+{
+   mCellStart.clear();
+   mEntries.clear();
+   mCells = ivec2 (0);
+
+   /* Bounding box and average size of all children that can be hit */
+   ivec2 lo (std::numeric_limits<int>::max()), hi (std::numeric_limits<int>::min());
+   vec2 avg (0.0f);
+   int count = 0;
+   for (auto child : children)
+   {
+      if (child->width() <= 0 || child->height() <= 0)
+         continue;
+      lo = cwiseMin (lo, child->position());
+      hi = cwiseMax (hi, child->position() + child->size());
+      avg += vec2 (child->size());
+      count++;
+   }
+   if (count == 0)
+      return;
+
+   /* Cells of about the size of an average child, but not many more cells than children */
+   avg /= (float)count;
+   ivec2 extent = hi - lo;
+   float scale = std::max (1.0f, std::sqrt ((extent.x / avg.x) * (extent.y / avg.y) / (4.0f * count)));
+   mOrigin = lo;
+   mCellSize = cwiseMax (ivec2 (avg * scale), ivec2 (1));
+   mCells = (extent + mCellSize - ivec2 (1)) / mCellSize;
+
+   /* Count the entries of every cell, then fill them in child order */
+   mCellStart.assign (mCells.x * mCells.y + 1, 0);
+   for (int pass = 0; pass < 2; ++pass)
+   {
+      if (pass == 1)
+      {
+         for (size_t i = 1; i < mCellStart.size(); ++i)
+            mCellStart[i] += mCellStart[i - 1];
+         mEntries.resize (mCellStart.back());
+      }
+      for (int index = 0; index < (int)children.size(); ++index)
+      {
+         const Widget * child = children[index];
+         if (child->width() <= 0 || child->height() <= 0)
+            continue;
+         ivec2 c0 = (child->position() - mOrigin) / mCellSize;
+         ivec2 c1 = (child->position() + child->size() - ivec2 (1) - mOrigin) / mCellSize;
+         for (int y = c0.y; y <= c1.y; ++y)
+            for (int x = c0.x; x <= c1.x; ++x)
+            {
+               int c = y * mCells.x + x;
+               if (pass == 0)
+                  mCellStart[c + 1]++;
+               else
+                  mEntries[mCellStart[c]++] = index;
+            }
+      }
+   }
+   /* Filling advanced every start to the start of the next cell */
+   for (size_t i = mCellStart.size() - 1; i > 0; --i)
+      mCellStart[i] = mCellStart[i - 1];
+   mCellStart[0] = 0;
+}
+
+std::pair<const int *, const int *> SpatialIndex::cell (const ivec2 & p) const
+{
+   ivec2 d = p - mOrigin;
+   if (d.x < 0 || d.y < 0)
+      return std::make_pair (nullptr, nullptr);
+   ivec2 c = d / mCellSize;
+   if (c.x >= mCells.x || c.y >= mCells.y)
+      return std::make_pair (nullptr, nullptr);
+   const int * entries = mEntries.data();
+   int index = c.y * mCells.x + c.x;
+   return std::make_pair (entries + mCellStart[index], entries + mCellStart[index + 1]);
+}
+
+Widget * SpatialIndex::find (const std::vector<Widget *> & children, const ivec2 & p) const
+{
+   auto range = cell (p);
+   for (const int * it = range.second; it != range.first;)
+   {
+      Widget * child = children[*--it];
+      if (child->visible() && child->contains (p))
+         return child;
+   }
+   return nullptr;
+}
+
+NAMESPACE_END (nanogui)
@@ -0,0 +1,50 @@
+/*
+   nanogui/spatialindex.h -- Uniform grid over the children of a widget,
+   used to speed up hit-testing in containers with many children
+
+   NanoGUI was developed by Wenzel Jakob <wenzel@inf.ethz.ch>.
+   The widget drawing code is based on the NanoVG demo application
+   by Mikko Mononen.
+
+   All rights reserved. Use of this source code is governed by a
+   BSD-style license that can be found in the LICENSE.txt file.
+*/
+
+#pragma once
+
+#include "common.h"
+#include <utility>
+
+NAMESPACE_BEGIN (nanogui)
+
+/**
+   \brief Uniform grid over the bounds of the children of a widget
+
+   Every cell lists the indices (in ascending order, i.e. bottom-most first)
+   of the children whose bounds overlap it, so a hit-test only needs to look
+   at the children of a single cell. The grid is a snapshot; it has to be
+   built again whenever children are added, removed, moved or resized.
+   See \ref Widget::setSpatialIndex().
+*/
+class SpatialIndex
+{
+   public:
+      SpatialIndex();
+
+      /// Build the grid over the bounds of the given widgets (in the coordinates of their parent)
+      void build (const std::vector<Widget *> & children);
+
+      /// Return the range of child indices overlapping the cell that contains \c p (empty outside of the grid)
+      std::pair<const int *, const int *> cell (const ivec2 & p) const;
+
+      /// Return the topmost visible child containing \c p (in parent coordinates), or \c nullptr
+      Widget * find (const std::vector<Widget *> & children, const ivec2 & p) const;
+
+   protected:
+      ivec2 mOrigin, mCellSize, mCells;
+      std::vector<int> mCellStart;
+      std::vector<int> mEntries;
+
+}; // end class SpatialIndex
+
+NAMESPACE_END (nanogui)
@@ -63,5 +63,34 @@ Theme::Theme (NVGcontext * ctx)
       throw std::runtime_error ("Could not load fonts!");
 }
 
+bool Theme::loadFontCache (NVGcontext * ctx, const std::string & path, float pixelRatio)
+{
+   if (nvgLoadFontAtlas (ctx, path.c_str(), pixelRatio))
+      return true;
+   // Draw the printable ASCII range invisibly at the sizes the widgets use by default,
+   // including the blurred window title shadow, to get the glyphs into the atlas.
+   std::string ascii;
+   for (char c = 32; c < 127; c++)
+      ascii += c;
+   const float sizes[] = { (float)mStandardFontSize, (float)mButtonFontSize, (float)mTextBoxFontSize, 18.0f };
+   nvgBeginFrame (ctx, 1, 1, pixelRatio);
+   nvgGlobalAlpha (ctx, 0.0f);
+   for (int font : { mFontNormal, mFontBold })
+   {
+      nvgFontFaceId (ctx, font);
+      for (float size : sizes)
+      {
+         nvgFontSize (ctx, size);
+         nvgText (ctx, 0, 0, ascii.c_str(), nullptr);
+      }
+   }
+   nvgFontSize (ctx, 18.0f);
+   nvgFontBlur (ctx, 2);
+   nvgText (ctx, 0, 0, ascii.c_str(), nullptr);
+   nvgEndFrame (ctx);
+   nvgSaveFontAtlas (ctx, path.c_str(), pixelRatio);
+   return false;
+}
+
 
 NAMESPACE_END (nanogui)
@@ -25,6 +25,18 @@ class Theme : public Object
    public:
       Theme (NVGcontext * ctx);
 
+      /**
+         \brief Load the glyphs of the standard font sizes from a cache file
+
+         When the file is missing, or was written for other fonts or another pixel ratio,
+         the glyphs of the text fonts are rasterized at the standard sizes and saved to
+         \c path instead, so that the next start uploads them in one go. Glyphs are
+         rasterized for the pixel ratio they are drawn with, pass Screen::pixelRatio()
+         once the screen has its size. Call it before drawing, after Screen::setDistanceFieldText() and before
+         Screen::setGlyphThreads(). Returns true if the cache was loaded.
+      */
+      bool loadFontCache (NVGcontext * ctx, const std::string & path, float pixelRatio = 1.0f);
+
       /* Fonts */
       int mFontNormal;
       int mFontBold;
@@ -5,27 +5,131 @@
 #include "vscrollpanel.h"
 #include "../nanovg/nanovg.h"
 #include "theme.h"
+#include "screen.h"
 
 NAMESPACE_BEGIN (nanogui)
 
 VScrollPanel::VScrollPanel (Widget * parent)
-   : Widget (parent), mChildPreferredHeight (0), mScroll (0.0f) {}
+   : Widget (parent), mChildPreferredHeight (0), mScroll (0.0f),
+     mVirtual (false), mItemCount (0), mRowHeight (1) {}
+
+void VScrollPanel::setVirtualItems (int itemCount, int rowHeight,
+                                    const std::function<Widget *(Widget *)> & createRow,
+                                    const std::function<void (Widget *, int)> & bindRow)
+{
+   while (!mChildren.empty())
+      removeChild (childCount() - 1);
+   mRowItems.clear();
+   mVirtual = true;
+   mRowHeight = std::max (1, rowHeight);
+   mCreateRow = createRow;
+   mBindRow = bindRow;
+   setItemCount (itemCount);
+}
+
+void VScrollPanel::setItemCount (int itemCount)
+{
+   mItemCount = std::max (0, itemCount);
+   mChildPreferredHeight = mItemCount * mRowHeight;
+   std::fill (mRowItems.begin(), mRowItems.end(), -1);
+   invalidateLayout();
+   bindVisibleRows();
+   markDirty();
+}
+
+void VScrollPanel::setScroll (float scroll)
+{
+   mScroll = std::max (0.0f, std::min (1.0f, scroll));
+   bindVisibleRows();
+   markDirty();
+}
+
+int VScrollPanel::scrollOffset() const
+{
+   return (int) (mScroll * std::max (0, mChildPreferredHeight - mSize.y));
+}
+
+void VScrollPanel::updateRows (NVGcontext * ctx)
+{
+   int offset = scrollOffset();
+   int first = offset / mRowHeight;
+   int last = std::min (mItemCount, (offset + mSize.y) / mRowHeight + 1);
+   int count = std::max (0, last - first);
+   while ((int)mRowItems.size() < count)
+   {
+      Widget * row = mCreateRow (this);
+      if (!row || row->parent() != this)
+         throw std::runtime_error ("VScrollPanel: row widgets must be children of the panel!");
+      mRowItems.push_back (-1);
+   }
+   /* Keep the rows that still show a visible item, free the others */
+   mItemRows.assign (count, -1);
+   for (size_t r = 0; r < mRowItems.size(); ++r)
+   {
+      int item = mRowItems[r];
+      if (item >= first && item < last && mItemRows[item - first] < 0)
+         mItemRows[item - first] = (int)r;
+      else
+         mRowItems[r] = -1;
+   }
+   /* Bind free rows to the items that are not shown yet */
+   size_t r = 0;
+   for (int i = 0; i < count; ++i)
+   {
+      if (mItemRows[i] >= 0)
+         continue;
+      while (mRowItems[r] != -1)
+         ++r;
+      Widget * row = mChildren[r];
+      mRowItems[r] = first + i;
+      row->setPosition (ivec2 (0, (first + i) * mRowHeight));
+      row->setSize (ivec2 (mSize.x - 12, mRowHeight));
+      if (mBindRow)
+         mBindRow (row, first + i);
+      row->performLayout (ctx);
+   }
+   for (size_t i = 0; i < mRowItems.size(); ++i)
+      mChildren[i]->setVisible (mRowItems[i] != -1);
+}
+
+void VScrollPanel::bindVisibleRows()
+{
+   /* Rows are bound when the visible items change, drawing only draws them */
+   if (!mVirtual)
+      return;
+   Widget * widget = this;
+   while (widget->parent())
+      widget = widget->parent();
+   Screen * screen = dynamic_cast<Screen *> (widget);
+   if (screen)
+      updateRows (screen->getContext());
+}
 
 void VScrollPanel::performLayout (NVGcontext * ctx)
 {
+   if (mVirtual)
+   {
+      mChildPreferredHeight = mItemCount * mRowHeight;
+      std::fill (mRowItems.begin(), mRowItems.end(), -1);
+      updateRows (ctx);
+      return;
+   }
    if (mChildren.empty())
       return;
    Widget * child = mChildren[0];
-   mChildPreferredHeight = child->preferredSize (ctx).y;
+   mChildPreferredHeight = child->cachedPreferredSize (ctx).y;
    child->setPosition (ivec2 (0, 0));
    child->setSize (ivec2 (mSize.x - 12, mChildPreferredHeight));
 }
 
 ivec2 VScrollPanel::preferredSize (NVGcontext * ctx) const
 {
+   if (mVirtual)
+      return ivec2 (mChildren.empty() ? 12 : mChildren[0]->cachedPreferredSize (ctx).x + 12,
+                    mItemCount * mRowHeight);
    if (mChildren.empty())
       return ivec2 (0);
-   return mChildren[0]->preferredSize (ctx) + ivec2 (12, 0);
+   return mChildren[0]->cachedPreferredSize (ctx) + ivec2 (12, 0);
 }
 
 bool VScrollPanel::mouseDragEvent (const ivec2 &, const ivec2 & rel,
@@ -35,8 +139,7 @@ bool VScrollPanel::mouseDragEvent (const ivec2 &, const ivec2 & rel,
       return false;
    float scrollh = height() *
                    std::min (1.0f, height() / (float)mChildPreferredHeight);
-   mScroll = std::max ((float) 0.0f, std::min ((float) 1.0f,
-                       mScroll + rel.y / (float) (mSize.y - 8 - scrollh)));
+   setScroll (mScroll + rel.y / (float) (mSize.y - 8 - scrollh));
    return true;
 }
 
@@ -45,13 +148,14 @@ bool VScrollPanel::scrollEvent (const ivec2 & /* p */, const vec2 & rel)
    float scrollAmount = rel.y * (mSize.y / 20.0f);
    float scrollh = height() *
                    std::min (1.0f, height() / (float)mChildPreferredHeight);
-   mScroll = std::max ((float) 0.0f, std::min ((float) 1.0f,
-                       mScroll - scrollAmount / (float) (mSize.y - 8 - scrollh)));
+   setScroll (mScroll - scrollAmount / (float) (mSize.y - 8 - scrollh));
    return true;
 }
 
 bool VScrollPanel::mouseButtonEvent (const ivec2 & p, int button, bool down, int modifiers)
 {
+   if (mVirtual)
+      return Widget::mouseButtonEvent (p + ivec2 (0, scrollOffset()), button, down, modifiers);
    if (mChildren.empty())
       return false;
    int shift = (int) (mScroll * (mChildPreferredHeight - mSize.y));
@@ -60,6 +164,8 @@ bool VScrollPanel::mouseButtonEvent (const ivec2 & p, int button, bool down, int
 
 bool VScrollPanel::mouseMotionEvent (const ivec2 & p, const ivec2 & rel, int button, int modifiers)
 {
+   if (mVirtual)
+      return Widget::mouseMotionEvent (p + ivec2 (0, scrollOffset()), rel, button, modifiers);
    if (mChildren.empty())
       return false;
    int shift = (int) (mScroll * (mChildPreferredHeight - mSize.y));
@@ -68,25 +174,48 @@ bool VScrollPanel::mouseMotionEvent (const ivec2 & p, const ivec2 & rel, int but
 
 void VScrollPanel::draw (NVGcontext * ctx)
 {
+   if (mVirtual)
+   {
+      /* Only the rows in view exist, so there is nothing to lay out or tessellate for the others.
+         They were bound by performLayout() or when scrolling. */
+      nvgSave (ctx);
+      nvgTranslate (ctx, mPos.x, mPos.y);
+      nvgScissor (ctx, 0, 0, mSize.x, mSize.y);
+      nvgTranslate (ctx, 0, -scrollOffset());
+      for (auto row : mChildren)
+         if (row->visible())
+            row->drawRetained (ctx);
+      nvgRestore (ctx);
+      drawScrollBar (ctx);
+      return;
+   }
    if (mChildren.empty())
       return;
    Widget * child = mChildren[0];
-   mChildPreferredHeight = child->preferredSize (ctx).y;
-   float scrollh = height() *
-                   std::min (1.0f, height() / (float)mChildPreferredHeight);
+   mChildPreferredHeight = child->cachedPreferredSize (ctx).y;
    nvgSave (ctx);
    nvgTranslate (ctx, mPos.x, mPos.y);
    nvgScissor (ctx, 0, 0, mSize.x, mSize.y);
    nvgTranslate (ctx, 0, -mScroll * (mChildPreferredHeight - mSize.y));
    if (child->visible())
-      child->draw (ctx);
+      child->drawRetained (ctx);
    nvgRestore (ctx);
+   drawScrollBar (ctx);
+}
+
+void VScrollPanel::drawScrollBar (NVGcontext * ctx)
+{
+   float scrollh = height() *
+                   std::min (1.0f, height() / (float)mChildPreferredHeight);
    NVGpaint paint = nvgBoxGradient (
                        ctx, mPos.x + mSize.x - 12 + 1, mPos.y + 4 + 1, 8,
                        mSize.y - 8, 3, 4, Colour (0, 32), Colour (0, 92));
+   const float track[] = { (float) mPos.x + mSize.x - 12, (float) mPos.y + 4, 8,
+                           (float) mSize.y - 8, 3
+                         };
    nvgBeginPath (ctx);
-   nvgRoundedRect (ctx, mPos.x + mSize.x - 12, mPos.y + 4, 8,
-                   mSize.y - 8, 3);
+   if (!nvgCachedPath (ctx, RoundedRectShape, track, 5))
+      nvgRoundedRect (ctx, track[0], track[1], track[2], track[3], track[4]);
    nvgFillPaint (ctx, paint);
    nvgFill (ctx);
    paint = nvgBoxGradient (
@@ -16,6 +16,7 @@
 #pragma once
 
 #include "widget.h"
+#include <functional>
 
 NAMESPACE_BEGIN (nanogui)
 
@@ -31,9 +32,71 @@ class  VScrollPanel : public Widget
       virtual bool mouseButtonEvent (const ivec2 & p, int button, bool down, int modifiers);
       virtual bool mouseMotionEvent (const ivec2 & p, const ivec2 & rel, int button, int modifiers);
       virtual void draw (NVGcontext * ctx);
+
+      /**
+         \brief Switch the panel to virtualized mode
+
+         Instead of scrolling a single child, the panel shows \c itemCount rows of
+         \c rowHeight pixels each. Row widgets are only created for the rows that
+         fit into the panel: \c createRow constructs a new row widget parented to the
+         panel, and \c bindRow is called whenever a row widget is (re-)used to show
+         the item with the given index. Rows that scroll out of view are recycled,
+         so off-screen items are neither laid out nor drawn. Existing children of
+         the panel are removed.
+      */
+      void setVirtualItems (int itemCount, int rowHeight,
+                            const std::function<Widget *(Widget *)> & createRow,
+                            const std::function<void (Widget *, int)> & bindRow);
+
+      /// Return whether the panel is in virtualized mode (see \ref setVirtualItems())
+      bool virtualized() const
+      {
+         return mVirtual;
+      }
+
+      /// Return the number of items in virtualized mode
+      int itemCount() const
+      {
+         return mItemCount;
+      }
+      /// Set the number of items in virtualized mode; all visible rows are bound again
+      void setItemCount (int itemCount);
+
+      /// Return the height of a row in virtualized mode
+      int rowHeight() const
+      {
+         return mRowHeight;
+      }
+
+      /// Return the scroll position, from 0 (top) to 1 (bottom)
+      float scroll() const
+      {
+         return mScroll;
+      }
+      /// Set the scroll position, from 0 (top) to 1 (bottom)
+      void setScroll (float scroll);
+
    protected:
       int mChildPreferredHeight;
       float mScroll;
+
+      bool mVirtual;
+      int mItemCount, mRowHeight;
+      std::function<Widget *(Widget *)> mCreateRow;
+      std::function<void (Widget *, int)> mBindRow;
+      /// Item shown by each child row widget, or -1 if the row is unused
+      std::vector<int> mRowItems;
+      /// Scratch buffer of \ref updateRows(): row widget showing each visible item
+      std::vector<int> mItemRows;
+
+      /// Return the current scroll offset in pixels
+      int scrollOffset() const;
+      /// Bind and place row widgets for the visible items in virtualized mode
+      void updateRows (NVGcontext * ctx);
+      /// Call \ref updateRows() with the context of the screen, if the panel is on one
+      void bindVisibleRows();
+      /// Draw the scroll bar
+      void drawScrollBar (NVGcontext * ctx);
 };
 
 
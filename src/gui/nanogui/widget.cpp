@@ -15,6 +15,9 @@
 #include "window.h"
 #include "../nanovg/nanovg.h"
 #include "screen.h"
+#include "vscrollpanel.h"
+#include "spatialindex.h"
+#include "profiler.h"
 using namespace ci;
 
 NAMESPACE_BEGIN (nanogui)
@@ -32,7 +35,15 @@ Widget::Widget (Widget * parent)
      mFocused (false),
      mMouseFocus (false),
      mTooltip (""),
-     mFontSize (-1.0f)
+     mFontSize (-1.0f),
+     mRetained (true),
+     mDirty (true),
+     mRecording (nullptr),
+     mSpatialIndex (nullptr),
+     mSpatialIndexStale (true),
+     mPreferredSize (ivec2 (0)),
+     mPreferredSizeValid (false),
+     mLayoutDirty (true)
 {
    if (parent)
    {
@@ -44,6 +55,8 @@ Widget::Widget (Widget * parent)
 // dtor
 Widget::~Widget()
 {
+   nvgDeleteRecording (mRecording);
+   delete mSpatialIndex;
 }
 
 void Widget::addChild (Widget * widget)
@@ -51,12 +64,18 @@ void Widget::addChild (Widget * widget)
    mChildren.push_back (widget);
    widget->incRef();
    widget->setParent (this);
+   childrenChanged();
+   invalidateLayout();
+   markDirty();
 }
 
 void Widget::removeChild (const Widget * widget)
 {
    mChildren.erase (std::remove (mChildren.begin(), mChildren.end(), widget), mChildren.end());
    widget->decRef();
+   childrenChanged();
+   invalidateLayout();
+   markDirty();
 }
 
 void Widget::removeChild (int index)
@@ -64,6 +83,9 @@ void Widget::removeChild (int index)
    Widget * widget = mChildren[index];
    mChildren.erase (mChildren.begin() + index);
    widget->decRef();
+   childrenChanged();
+   invalidateLayout();
+   markDirty();
 }
 
 ivec2 Widget::preferredSize (NVGcontext * ctx) const
@@ -74,23 +96,88 @@ ivec2 Widget::preferredSize (NVGcontext * ctx) const
       return mSize;
 }
 
+ivec2 Widget::cachedPreferredSize (NVGcontext * ctx) const
+{
+   if (!mPreferredSizeValid)
+   {
+      ProfileZone zone ("preferredSize", this);
+      mPreferredSize = preferredSize (ctx);
+      mPreferredSizeValid = true;
+   }
+   return mPreferredSize;
+}
+
+void Widget::invalidateLayout()
+{
+   for (Widget * widget = this; widget; widget = widget->parent())
+   {
+      widget->mPreferredSizeValid = false;
+      widget->mLayoutDirty = true;
+   }
+}
+
+void Widget::invalidateLayoutTree()
+{
+   invalidateLayout();
+   for (auto c : mChildren)
+      c->invalidateLayoutTree();
+}
+
+void Widget::updateLayout (NVGcontext * ctx)
+{
+   if (!mLayoutDirty)
+      return;
+   mLayoutDirty = false;
+   performLayout (ctx);
+}
+
 void Widget::performLayout (NVGcontext * ctx)
 {
+   ProfileZone zone ("performLayout", this);
    if (mLayout)
       mLayout->performLayout (ctx, this);
    else
    {
       for (auto c : mChildren)
       {
-         ivec2 pref = c->preferredSize (ctx), fix = c->fixedSize();
+         ivec2 pref = c->cachedPreferredSize (ctx), fix = c->fixedSize();
          c->setSize (ivec2
                      (
                         fix[0] ? fix[0] : pref[0],
                         fix[1] ? fix[1] : pref[1]
                      ));
-         c->performLayout (ctx);
+         c->updateLayout (ctx);
       }
    }
+   if (mSpatialIndex)
+   {
+      mSpatialIndex->build (mChildren);
+      mSpatialIndexStale = false;
+   }
+}
+
+void Widget::setSpatialIndex (bool spatialIndex)
+{
+   if (spatialIndex == (mSpatialIndex != nullptr))
+      return;
+   if (spatialIndex)
+      mSpatialIndex = new SpatialIndex();
+   else
+   {
+      delete mSpatialIndex;
+      mSpatialIndex = nullptr;
+   }
+   mSpatialIndexStale = true;
+}
+
+const SpatialIndex * Widget::spatialIndex()
+{
+   if (mSpatialIndex && mSpatialIndexStale)
+   {
+      mSpatialIndex->build (mChildren);
+      mSpatialIndexStale = false;
+   }
+   return mSpatialIndex;
 }
 
 int Widget::fontSize() const
@@ -112,12 +199,64 @@ void Widget::draw (NVGcontext * ctx)
    nvgTranslate (ctx, mPos.x, mPos.y);
    for (auto child : mChildren)
       if (child->visible())
-         child->draw (ctx);
+         child->drawRetained (ctx);
    nvgTranslate (ctx, -mPos.x, -mPos.y);
 }
 
+void Widget::drawRetained (NVGcontext * ctx)
+{
+   ProfileZone zone ("draw", this);
+   if (!mRetained)
+   {
+      draw (ctx);
+      return;
+   }
+   if (!mDirty && nvgReplayRecording (ctx, mRecording))
+      return;
+   if (!mRecording)
+      mRecording = nvgCreateRecording();
+   if (!mRecording)
+   {
+      draw (ctx);
+      return;
+   }
+   nvgBeginRecording (ctx, mRecording);
+   draw (ctx);
+   nvgEndRecording (ctx);
+   mDirty = false;
+}
+
+void Widget::markDirty()
+{
+   /* Parents replay the commands of their children as part of their own
+      recording, so they have to be recorded again as well */
+   const Widget * damaged = this;
+   Widget * widget = this;
+   for (;; widget = widget->parent())
+   {
+      widget->mDirty = true;
+      /* absolutePosition() does not know about the scroll offset, so
+         damage the whole (clipped) scroll panel instead */
+      if (dynamic_cast<const VScrollPanel *> (widget))
+         damaged = widget;
+      if (!widget->parent())
+         break;
+   }
+   Screen * screen = dynamic_cast<Screen *> (widget);
+   if (screen)
+      screen->damage (damaged->absolutePosition(), damaged->size());
+}
+
 Widget * Widget::findWidget (const ivec2 & p)
 {
+   const SpatialIndex * index = spatialIndex();
+   if (index)
+   {
+      Widget * child = index->find (mChildren, p - mPos);
+      if (child)
+         return child->findWidget (p - mPos);
+      return contains (p) ? this : nullptr;
+   }
    for (auto it = mChildren.rbegin(); it != mChildren.rend(); ++it)
    {
       Widget * child = *it;
@@ -130,6 +269,7 @@ Widget * Widget::findWidget (const ivec2 & p)
 bool Widget::mouseEnterEvent (const ivec2 & p, bool enter)
 {
    mMouseFocus = enter;
+   markDirty();
    return false;
 }
 
@@ -140,12 +280,27 @@ bool Widget::mouseDragEvent (const ivec2 & p, const ivec2 & rel, int button, int
 
 bool Widget::mouseButtonEvent (const ivec2 & p, int button, bool down, int modifiers)
 {
-   for (auto it = mChildren.rbegin(); it != mChildren.rend(); ++it)
+   const SpatialIndex * index = spatialIndex();
+   if (index)
    {
-      Widget * child = *it;
-      if (child->visible() && child->contains (p - mPos) &&
-            child->mouseButtonEvent (p - mPos, button, down, modifiers))
-         return true;
+      auto range = index->cell (p - mPos);
+      for (const int * it = range.second; it != range.first;)
+      {
+         Widget * child = mChildren[*--it];
+         if (child->visible() && child->contains (p - mPos) &&
+               child->mouseButtonEvent (p - mPos, button, down, modifiers))
+            return true;
+      }
+   }
+   else
+   {
+      for (auto it = mChildren.rbegin(); it != mChildren.rend(); ++it)
+      {
+         Widget * child = *it;
+         if (child->visible() && child->contains (p - mPos) &&
+               child->mouseButtonEvent (p - mPos, button, down, modifiers))
+            return true;
+      }
    }
    if (button == MOUSE_BUTTON_1 && down && !mFocused)
       requestFocus();
@@ -155,23 +310,50 @@ bool Widget::mouseButtonEvent (const ivec2 & p, int button, bool down, int modif
 bool Widget::focusEvent (bool focused)
 {
    mFocused = focused;
+   markDirty();
    return false;
 }
 
+/* Send enter/leave and motion events to a child that contains the new or the previous position */
+static bool dispatchMouseMotion (Widget * child, const ivec2 & p, const ivec2 & offset,
+                                 const ivec2 & rel, int button, int modifiers)
+{
+   if (!child->visible())
+      return false;
+   bool contained = child->contains (p - offset), prevContained = child->contains (p - offset - rel);
+   if (contained != prevContained)
+      child->mouseEnterEvent (p, contained);
+   return (contained || prevContained) &&
+          child->mouseMotionEvent (p - offset, rel, button, modifiers);
+}
+
 bool Widget::mouseMotionEvent (const ivec2 & p, const ivec2 & rel, int button, int modifiers)
 {
-   for (auto it = mChildren.rbegin(); it != mChildren.rend(); ++it)
+   const SpatialIndex * index = spatialIndex();
+   if (index)
    {
-      Widget * child = *it;
-      if (!child->visible())
-         continue;
-      bool contained = child->contains (p - mPos), prevContained = child->contains (p - mPos - rel);
-      if (contained != prevContained)
-         child->mouseEnterEvent (p, contained);
-      if ((contained || prevContained) &&
-            child->mouseMotionEvent (p - mPos, rel, button, modifiers))
-         return true;
+      /* Merge the children near the new and the previous position, topmost first */
+      auto cur = index->cell (p - mPos), prev = index->cell (p - mPos - rel);
+      const int * a = cur.second, *b = prev.second;
+      while (a != cur.first || b != prev.first)
+      {
+         int i;
+         if (b == prev.first || (a != cur.first && a[-1] >= b[-1]))
+         {
+            i = *--a;
+            if (b != prev.first && b[-1] == i)
+               --b;
+         }
+         else
+            i = *--b;
+         if (dispatchMouseMotion (mChildren[i], p, mPos, rel, button, modifiers))
+            return true;
+      }
+      return false;
    }
+   for (auto it = mChildren.rbegin(); it != mChildren.rend(); ++it)
+      if (dispatchMouseMotion (*it, p, mPos, rel, button, modifiers))
+         return true;
    return false;
 }
 
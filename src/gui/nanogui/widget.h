@@ -92,6 +92,7 @@ class Widget : public Object
       void setEnabled (bool enabled)
       {
          mEnabled = enabled;
+         markDirty();
       }
 
       /// Return the \ref Theme used to draw this widget
@@ -110,6 +111,8 @@ class Widget : public Object
       void setTheme (Theme * theme)
       {
          mTheme = theme;
+         invalidateLayout();
+         markDirty();
       }
 
       /// Return the used \ref Layout generator
@@ -128,6 +131,7 @@ class Widget : public Object
       void setLayout (Layout * layout)
       {
          mLayout = layout;
+         invalidateLayout();
       }
 
       /// Return whether or not the widget is currently visible (assuming all parents are visible)
@@ -139,7 +143,10 @@ class Widget : public Object
       /// Set whether or not the widget is currently visible (assuming all parents are visible)
       void setVisible (bool visible)
       {
+         if (mVisible == visible)
+            return;
          mVisible = visible;
+         markDirty();
       }
 
       /// Check if this widget is currently visible, taking parent widgets into account
@@ -158,6 +165,31 @@ class Widget : public Object
       /// Compute the preferred size of the widget
       virtual ivec2 preferredSize (NVGcontext * ctx) const;
 
+      /**
+         \brief Return the preferred size of the widget, cached until the layout is invalidated
+
+         Layout generators query the preferred size of every descendant once per
+         ancestor; the cache computes it with \ref preferredSize() only once until
+         \ref invalidateLayout() is called or the widget is resized (the preferred
+         size of a widget without a layout generator is its current size).
+      */
+      ivec2 cachedPreferredSize (NVGcontext * ctx) const;
+
+      /**
+         \brief Notify the widget that its preferred size may have changed
+
+         Discards the cached preferred size of this widget and all of its parents,
+         and marks them to be laid out again by \ref updateLayout(). Setters that
+         change the contents of a widget (captions, icons, fonts, children, ...)
+         call this automatically.
+      */
+      void invalidateLayout();
+      /// Like \ref invalidateLayout(), for this widget and all of its descendants, e.g. when the text metrics change
+      void invalidateLayoutTree();
+
+      /// Invoke \ref performLayout() if the widget was resized or its layout was invalidated since it was last laid out
+      void updateLayout (NVGcontext * ctx);
+
       /// Return the fixed size (see \ref setFixedSize())
       const ivec2 & fixedSize() const
       {
@@ -173,7 +205,13 @@ class Widget : public Object
       /// Set the width of the widget
       void setWidth (int width)
       {
+         markDirty();
          mSize.x = width;
+         mPreferredSizeValid = false;
+         mLayoutDirty = true;
+         markDirty();
+         if (mParent)
+            mParent->childrenChanged();
       }
 
       /// Return the height of the widget
@@ -185,7 +223,13 @@ class Widget : public Object
       /// Set the height of the widget
       void setHeight (int height)
       {
+         markDirty();
          mSize.y = height;
+         mPreferredSizeValid = false;
+         mLayoutDirty = true;
+         markDirty();
+         if (mParent)
+            mParent->childrenChanged();
       }
 
       /**
@@ -200,6 +244,7 @@ class Widget : public Object
       void setFixedSize (const ivec2 & fixedSize)
       {
          mFixedSize = fixedSize;
+         invalidateLayout();
       }
 
       // Return the fixed width (see \ref setFixedSize())
@@ -218,12 +263,14 @@ class Widget : public Object
       void setFixedWidth (int width)
       {
          mFixedSize.x = width;
+         invalidateLayout();
       }
 
       /// Set the fixed height (see \ref setFixedSize())
       void setFixedHeight (int height)
       {
          mFixedSize.y = height;
+         invalidateLayout();
       }
 
       /// Return the position relative to the parent widget
@@ -235,7 +282,14 @@ class Widget : public Object
       /// Set the position relative to the parent widget
       void setPosition (const ivec2 & pos)
       {
+         if (mPos == pos)
+            return;
+         /* Damage both the old and the new bounds */
+         markDirty();
          mPos = pos;
+         markDirty();
+         if (mParent)
+            mParent->childrenChanged();
       }
 
       /// Return the absolute position on screen
@@ -254,7 +308,15 @@ class Widget : public Object
       /// set the size of the widget
       void setSize (const ivec2 & size)
       {
+         if (mSize == size)
+            return;
+         markDirty();
          mSize = size;
+         mPreferredSizeValid = false;
+         mLayoutDirty = true;
+         markDirty();
+         if (mParent)
+            mParent->childrenChanged();
       }
 
       /// Return current font size. If not set the default of the current theme will be returned
@@ -264,6 +326,8 @@ class Widget : public Object
       void setFontSize (int fontSize)
       {
          mFontSize = fontSize;
+         invalidateLayout();
+         markDirty();
       }
 
       /// Return whether the font size is explicitly specified for this widget
@@ -278,6 +342,55 @@ class Widget : public Object
       /// Draw the widget (and all child widgets)
       virtual void draw (NVGcontext * ctx);
 
+      /**
+         \brief Draw the widget, replaying its recorded draw commands when possible
+
+         The render commands emitted by \ref draw() are recorded. As long as
+         the widget is not marked dirty (see \ref markDirty()) and the transform
+         and scissor are unchanged, the recording is replayed instead of
+         drawing the subtree again.
+      */
+      void drawRetained (NVGcontext * ctx);
+
+      /// Mark the widget and its parents as changed, so that they are drawn again
+      void markDirty();
+
+      /// Return whether the widget changed since its draw commands were recorded
+      bool dirty() const
+      {
+         return mDirty;
+      }
+
+      /// Return whether the draw commands of this widget are recorded and replayed
+      bool retained() const
+      {
+         return mRetained;
+      }
+
+      /// Set whether the draw commands of this widget are recorded and replayed
+      void setRetained (bool retained)
+      {
+         mRetained = retained;
+         markDirty();
+      }
+
+      /**
+         \brief Set whether hit-testing of the children uses a spatial index
+
+         Containers with many children (e.g. a large \ref ImagePanel or a generated
+         grid of parameters) can keep a uniform grid over their children, so that
+         \ref findWidget() and the mouse event dispatch only test the children
+         near the cursor. The index is built by \ref performLayout() and again on
+         first use after children were added, removed, moved or resized.
+      */
+      void setSpatialIndex (bool spatialIndex);
+
+      /// Return whether hit-testing of the children uses a spatial index
+      bool hasSpatialIndex() const
+      {
+         return mSpatialIndex != nullptr;
+      }
+
       /// Determine the widget located at the given position value (recursive)
       Widget * findWidget (const ivec2 & p);
 
@@ -312,6 +425,7 @@ class Widget : public Object
       void setFocused (bool focused)
       {
          mFocused = focused;
+         markDirty();
       }
       /// Request the focus to be moved to this widget
       void requestFocus();
@@ -331,6 +445,22 @@ class Widget : public Object
       bool mFocused, mMouseFocus;
       std::string mTooltip;
       int mFontSize;
+      bool mRetained, mDirty;
+      NVGrecording * mRecording;
+      SpatialIndex * mSpatialIndex;
+      bool mSpatialIndexStale;
+      mutable ivec2 mPreferredSize;
+      mutable bool mPreferredSizeValid;
+      bool mLayoutDirty;
+
+      /// Called when children were added, removed, moved or resized
+      void childrenChanged()
+      {
+         mSpatialIndexStale = true;
+      }
+
+      /// Return the spatial index over the children, built if needed; \c nullptr if not enabled
+      const SpatialIndex * spatialIndex();
 
 }; // end class Widget
 
@@ -21,13 +21,17 @@ Window::Window (Widget * parent, const std::string & title)
    : Widget (parent),
      mTitle (title),
      mModal (false),
-     mDrag (false)
+     mDrag (false),
+     mTitleShadowRun (nvgCreateTextRun()),
+     mTitleRun (nvgCreateTextRun())
 {
 }
 
 // dtor
 Window::~Window ()
 {
+   nvgDeleteTextRun (mTitleShadowRun);
+   nvgDeleteTextRun (mTitleRun);
 }
 
 ivec2 Window::preferredSize (NVGcontext * ctx) const
@@ -46,21 +50,14 @@ void Window::draw (NVGcontext * ctx)
    int hh = mTheme->mWindowHeaderHeight;
    /* Draw window */
    nvgSave (ctx);
-   nvgBeginPath (ctx);
-   nvgRoundedRect (ctx, mPos.x, mPos.y, mSize.x, mSize.y, cr);
-   nvgFillColor (ctx, mMouseFocus ? mTheme->mWindowFillFocused
-                 : mTheme->mWindowFillUnfocused);
-   nvgFill (ctx);
+   nvgFillRoundedRectFast (ctx, mPos.x, mPos.y, mSize.x, mSize.y, cr,
+                           mMouseFocus ? mTheme->mWindowFillFocused
+                           : mTheme->mWindowFillUnfocused);
    /* Draw a drop shadow */
    NVGpaint shadowPaint = nvgBoxGradient (
                              ctx, mPos.x, mPos.y, mSize.x, mSize.y, cr * 2, ds * 2,
                              mTheme->mDropShadow, mTheme->mTransparent);
-   nvgBeginPath (ctx);
-   nvgRect (ctx, mPos.x - ds, mPos.y - ds, mSize.x + 2 * ds, mSize.y + 2 * ds);
-   nvgRoundedRect (ctx, mPos.x, mPos.y, mSize.x, mSize.y, cr);
-   nvgPathWinding (ctx, NVG_HOLE);
-   nvgFillPaint (ctx, shadowPaint);
-   nvgFill (ctx);
+   nvgDropShadowFast (ctx, mPos.x, mPos.y, mSize.x, mSize.y, cr, ds, shadowPaint);
    if (!mTitle.empty())
    {
       /* Draw header */
@@ -69,12 +66,16 @@ void Window::draw (NVGcontext * ctx)
                                 mPos.y + hh,
                                 mTheme->mWindowHeaderGradientTop,
                                 mTheme->mWindowHeaderGradientBot);
+      const float header[] = { (float) mPos.x, (float) mPos.y, (float) mSize.x,
+                               (float) hh, (float) cr
+                             };
       nvgBeginPath (ctx);
-      nvgRoundedRect (ctx, mPos.x, mPos.y, mSize.x, hh, cr);
+      if (!nvgCachedPath (ctx, RoundedRectShape, header, 5))
+         nvgRoundedRect (ctx, header[0], header[1], header[2], header[3],
+                         header[4]);
       nvgFillPaint (ctx, headerPaint);
       nvgFill (ctx);
-      nvgBeginPath (ctx);
-      nvgRoundedRect (ctx, mPos.x, mPos.y, mSize.x, hh, cr);
+      /* Stroke the same path, only its top edge shows through the scissor */
       nvgStrokeColor (ctx, mTheme->mWindowHeaderSepTop);
       nvgScissor (ctx, mPos.x, mPos.y, mSize.x, 0.5f);
       nvgStroke (ctx);
@@ -89,13 +90,13 @@ void Window::draw (NVGcontext * ctx)
       nvgTextAlign (ctx, NVG_ALIGN_CENTER | NVG_ALIGN_MIDDLE);
       nvgFontBlur (ctx, 2);
       nvgFillColor (ctx, mTheme->mDropShadow);
-      nvgText (ctx, mPos.x + mSize.x / 2,
-               mPos.y + hh / 2, mTitle.c_str(), nullptr);
+      nvgTextRun (ctx, mTitleShadowRun, mPos.x + mSize.x / 2,
+                  mPos.y + hh / 2, mTitle.c_str(), nullptr);
       nvgFontBlur (ctx, 0);
       nvgFillColor (ctx, mFocused ? mTheme->mWindowTitleFocused
                     : mTheme->mWindowTitleUnfocused);
-      nvgText (ctx, mPos.x + mSize.x / 2, mPos.y + hh / 2 - 1,
-               mTitle.c_str(), nullptr);
+      nvgTextRun (ctx, mTitleRun, mPos.x + mSize.x / 2, mPos.y + hh / 2 - 1,
+                  mTitle.c_str(), nullptr);
    }
    nvgRestore (ctx);
    Widget::draw (ctx);
@@ -105,11 +106,12 @@ bool Window::mouseDragEvent (const ivec2 & p, const ivec2 & rel, int button, int
 {
    if (mDrag && (button & (1 << MOUSE_BUTTON_LEFT)) != 0)
    {
-      mPos += rel;
-      mPos = cwiseMax (mPos, ivec2 (0));
-      mPos = cwiseMin (mPos, parent()->size() - mSize);
+      ivec2 pos = mPos + rel;
+      pos = cwiseMax (pos, ivec2 (0));
+      pos = cwiseMin (pos, parent()->size() - mSize);
       //mPos = mPos.cwiseMax(Vector2i::Zero());
       //mPos = mPos.cwiseMin(parent()->size() - mSize);
+      setPosition (pos);
       return true;
    }
    return false;
@@ -20,6 +20,7 @@ NAMESPACE_BEGIN (nanogui)
 class Window : public Widget
 {
       friend class Popup;
+      friend class Screen;
 
    public:
       Window (Widget * parent, const std::string & title = "Untitled");
@@ -35,6 +36,8 @@ class Window : public Widget
       void setTitle (const std::string & title)
       {
          mTitle = title;
+         invalidateLayout();
+         markDirty();
       }
 
       /// Is this a model dialog?
@@ -47,6 +50,7 @@ class Window : public Widget
       void setModal (bool modal)
       {
          mModal = modal;
+         markDirty();
       }
 
       virtual ivec2 preferredSize (NVGcontext * ctx) const;
@@ -74,6 +78,8 @@ class Window : public Widget
       std::string mTitle;
       bool mModal;
       bool mDrag;
+      /* The blurred shadow and the title itself use different text styles */
+      NVGtextRun * mTitleShadowRun, * mTitleRun;
 
 }; // end class Window
 
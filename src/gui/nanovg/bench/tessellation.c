@@ -0,0 +1,176 @@
+//
+// Tessellation microbenchmark, compares the scalar and SIMD kernels of nanovg.c.
+//
+// Build from src/gui/nanovg, e.g.
+//   cc -O2 -I. bench/tessellation.c nanovg.c -lm -o tessbench
+//
+// The paths are tessellated through a back-end which only checksums the vertices,
+// so the timings contain flattening, joins and expansion but no rasterization.
+//
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "nanovg.h"
+
+#define BENCH_FRAMES 200
+#define BENCH_SHAPES 500
+
+static unsigned int checksum = 2166136261u;
+
+static void hashVerts(const NVGvertex* verts, int nverts)
+{
+	const unsigned char* p = (const unsigned char*)verts;
+	size_t i, n = sizeof(NVGvertex) * (size_t)nverts;
+	for (i = 0; i < n; i++)
+		checksum = (checksum ^ p[i]) * 16777619u;
+}
+
+static void hashPaths(const NVGpath* paths, int npaths)
+{
+	int i;
+	for (i = 0; i < npaths; i++) {
+		hashVerts(paths[i].fill, paths[i].nfill);
+		hashVerts(paths[i].stroke, paths[i].nstroke);
+	}
+}
+
+static int benchCreate(void* uptr) { (void)uptr; return 1; }
+static int benchCreateTexture(void* uptr, int type, int w, int h, int imageFlags, const unsigned char* data)
+{
+	(void)uptr; (void)type; (void)w; (void)h; (void)imageFlags; (void)data;
+	return 1;
+}
+static int benchDeleteTexture(void* uptr, int image) { (void)uptr; (void)image; return 1; }
+static int benchUpdateTexture(void* uptr, int image, int x, int y, int w, int h, const unsigned char* data)
+{
+	(void)uptr; (void)image; (void)x; (void)y; (void)w; (void)h; (void)data;
+	return 1;
+}
+static int benchGetTextureSize(void* uptr, int image, int* w, int* h)
+{
+	(void)uptr; (void)image;
+	*w = *h = 512;
+	return 1;
+}
+static void benchViewport(void* uptr, int width, int height) { (void)uptr; (void)width; (void)height; }
+static void benchCancel(void* uptr) { (void)uptr; }
+static void benchFlush(void* uptr) { (void)uptr; }
+static void benchFill(void* uptr, NVGpaint* paint, NVGscissor* scissor, float fringe, const float* bounds, const NVGpath* paths, int npaths)
+{
+	(void)uptr; (void)paint; (void)scissor; (void)fringe; (void)bounds;
+	hashPaths(paths, npaths);
+}
+static void benchStroke(void* uptr, NVGpaint* paint, NVGscissor* scissor, float fringe, float strokeWidth, const NVGpath* paths, int npaths)
+{
+	(void)uptr; (void)paint; (void)scissor; (void)fringe; (void)strokeWidth;
+	hashPaths(paths, npaths);
+}
+static void benchTriangles(void* uptr, NVGpaint* paint, NVGscissor* scissor, const NVGvertex* verts, int nverts)
+{
+	(void)uptr; (void)paint; (void)scissor;
+	hashVerts(verts, nverts);
+}
+static void benchDelete(void* uptr) { (void)uptr; }
+
+static NVGcontext* createContext(void)
+{
+	NVGparams params;
+	memset(&params, 0, sizeof(params));
+	params.renderCreate = benchCreate;
+	params.renderCreateTexture = benchCreateTexture;
+	params.renderDeleteTexture = benchDeleteTexture;
+	params.renderUpdateTexture = benchUpdateTexture;
+	params.renderGetTextureSize = benchGetTextureSize;
+	params.renderViewport = benchViewport;
+	params.renderCancel = benchCancel;
+	params.renderFlush = benchFlush;
+	params.renderFill = benchFill;
+	params.renderStroke = benchStroke;
+	params.renderTriangles = benchTriangles;
+	params.renderDelete = benchDelete;
+	params.edgeAntiAlias = 1;
+	return nvgCreateInternal(&params);
+}
+
+// Widget-like content: rounded rects with borders and drop shadows, plus some curves.
+static void drawFrame(NVGcontext* vg, int frame)
+{
+	int i;
+	nvgBeginFrame(vg, 1280, 720, 1.0f);
+	for (i = 0; i < BENCH_SHAPES; i++) {
+		float x = (float)((i * 37 + frame) % 1200), y = (float)((i * 53) % 680);
+		float w = 40.0f + (float)(i % 7) * 9.5f, h = 20.0f + (float)(i % 5) * 6.25f;
+		NVGpaint shadow = nvgBoxGradient(vg, x, y + 2, w, h, 6, 10, nvgRGBA(0,0,0,128), nvgRGBA(0,0,0,0));
+		nvgBeginPath(vg);
+		nvgRect(vg, x - 10, y - 10, w + 20, h + 30);
+		nvgRoundedRect(vg, x, y, w, h, 6);
+		nvgPathWinding(vg, NVG_HOLE);
+		nvgFillPaint(vg, shadow);
+		nvgFill(vg);
+
+		nvgBeginPath(vg);
+		nvgRoundedRect(vg, x, y, w, h, 3.0f + (float)(i % 4));
+		nvgFillColor(vg, nvgRGBA(60, 60, 60, 255));
+		nvgFill(vg);
+		nvgStrokeWidth(vg, 1.0f + (float)(i % 3) * 0.5f);
+		nvgLineJoin(vg, i % 3 == 0 ? NVG_MITER : (i % 3 == 1 ? NVG_ROUND : NVG_BEVEL));
+		nvgStrokeColor(vg, nvgRGBA(255, 255, 255, 64));
+		nvgStroke(vg);
+
+		if (i % 10 == 0) {
+			nvgBeginPath(vg);
+			nvgMoveTo(vg, x, y);
+			nvgBezierTo(vg, x + w, y - h, x - w, y + 2 * h, x + w, y + h);
+			nvgLineTo(vg, x + 2, y + h * 0.5f);
+			nvgLineCap(vg, i % 20 == 0 ? NVG_ROUND : NVG_SQUARE);
+			nvgStroke(vg);
+			nvgFill(vg);
+		}
+	}
+	nvgEndFrame(vg);
+}
+
+static double run(NVGcontext* vg, unsigned int* sum)
+{
+	clock_t start;
+	int i;
+	checksum = 2166136261u;
+	start = clock();
+	for (i = 0; i < BENCH_FRAMES; i++)
+		drawFrame(vg, i);
+	*sum = checksum;
+	return (double)(clock() - start) * 1000.0 / CLOCKS_PER_SEC / BENCH_FRAMES;
+}
+
+int main(void)
+{
+	NVGcontext* vg = createContext();
+	unsigned int scalarSum, simdSum;
+	double scalarMs, simdMs;
+	if (vg == NULL) {
+		printf("Could not create context.\n");
+		return 1;
+	}
+	if (!nvgUseSimd(vg, 1)) {
+		printf("SIMD kernels are not available in this build.\n");
+		nvgDeleteInternal(vg);
+		return 1;
+	}
+	// Warm up the allocations of the path cache.
+	drawFrame(vg, 0);
+
+	nvgUseSimd(vg, 0);
+	scalarMs = run(vg, &scalarSum);
+	nvgUseSimd(vg, 1);
+	simdMs = run(vg, &simdSum);
+
+	printf("%d frames of %d shapes\n", BENCH_FRAMES, BENCH_SHAPES);
+	printf("scalar: %8.3f ms/frame\n", scalarMs);
+	printf("simd:   %8.3f ms/frame (%.2fx)\n", simdMs, scalarMs / simdMs);
+	// Differences are expected only if the scalar code was compiled with fused multiply-adds.
+	printf("geometry %s\n", scalarSum == simdSum ? "identical" : "differs");
+
+	nvgDeleteInternal(vg);
+	return 0;
+}
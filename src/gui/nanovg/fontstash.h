@@ -79,6 +79,7 @@ struct FONStextIter
    short isize, iblur;
    struct FONSfont * font;
    int prevGlyphIndex;
+   int page;
    const char * str;
    const char * next;
    const char * end;
@@ -99,6 +100,60 @@ void fonsGetAtlasSize (FONScontext * s, int * width, int * height);
 int fonsExpandAtlas (FONScontext * s, int width, int height);
 // Resets the whole stash.
 int fonsResetAtlas (FONScontext * stash, int width, int height);
+// Starts a new frame, pages used in the current frame are never evicted.
+void fonsBeginFrame (FONScontext * s);
+// Marks the pages in the mask as used in the current frame, bit (page & 31) stands for a page.
+void fonsTouchPages (FONScontext * s, unsigned int mask);
+// Evicts the least recently used pages to make room for the last glyph that did not fit.
+// Returns 1 if the glyph fits now, 0 if all candidate pages were used in the current frame.
+int fonsEvictAtlas (FONScontext * s);
+// Returns glyph rasterizations and evicted pages of the previous frame, and the number of cached glyphs.
+void fonsAtlasStats (FONScontext * s, int * rasterized, int * evicted, int * glyphs);
+// Returns glyph rasterizations of the current frame so far.
+int fonsFrameRasterized (FONScontext * s);
+
+// Asynchronous rasterization. When enabled, a glyph missing from the atlas gets its metrics and
+// its place in the atlas right away, but its bitmap is rendered by a job. Until the job is
+// committed, the glyph is drawn from the closest size of the same glyph in the atlas, if any.
+struct FONSjob;
+typedef struct FONSjob FONSjob;
+// Returns 1 if glyphs are rasterized asynchronously, which needs stb_truetype. Disabling it
+// rasterizes the jobs which were not taken yet right away.
+int fonsSetAsync (FONScontext * s, int enabled);
+// Returns the next queued job, or NULL. The job belongs to the caller until committed.
+FONSjob * fonsTakeJob (FONScontext * s);
+// Returns the number of glyphs in the atlas waiting for their job.
+int fonsPendingGlyphs (FONScontext * s);
+// Renders the bitmap of the job, can be called on any thread.
+void fonsRunJob (FONSjob * job);
+// Copies the bitmap of a job into the atlas and frees the job. A job that did not run (e.g. out
+// of memory) has its glyph rasterized right away instead. Returns 0 if its glyph was evicted in
+// the meantime.
+int fonsCommitJob (FONScontext * s, FONSjob * job);
+
+// Signed distance field glyphs. When enabled, a glyph is rasterized once at FONS_SDF_SIZE pixels
+// as a distance field, and the quads of every size and blur are scaled from it. The field is
+// 128 on the outline and reaches 0 and 255 at FONS_SDF_PAD pixels outside and inside of it.
+// Glyphs of both kinds are cached side by side, the renderer has to draw them differently.
+#ifndef FONS_SDF_SIZE
+   #define FONS_SDF_SIZE 32
+#endif
+#ifndef FONS_SDF_PAD
+   #define FONS_SDF_PAD 8
+#endif
+void fonsSetSDF (FONScontext * s, int enabled);
+
+// Atlas cache. Saves the glyphs and the bitmap of the atlas, so that a stash with the same fonts
+// added in the same order can load them instead of rasterizing them again. The file is only
+// valid on the machine and with the fonts it was written for, which is checked on load. The
+// scale is the one the glyphs were rasterized for, e.g. the device pixel ratio.
+// Returns 0 while glyphs are rasterized asynchronously.
+int fonsSaveAtlas (FONScontext * s, const char * path, float scale);
+// Replaces the glyphs and the atlas with the ones saved in the file, the whole atlas is marked
+// dirty. Returns 0 if the file is missing, does not match or was saved for another scale (except
+// for distance field glyphs, which serve all scales), the atlas is then not changed (or emptied
+// if memory ran out while loading).
+int fonsLoadAtlas (FONScontext * s, const char * path, float scale);
 
 // Add fonts
 int fonsAddFont (FONScontext * s, const char * name, const char * path);
@@ -144,10 +199,23 @@ void fonsDrawDebug (FONScontext * s, float x, float y);
 
 #define FONS_NOTUSED(v)  (void)sizeof(v)
 
+// Bump allocator used for the temporary memory of the glyph rasterizer.
+struct FONSscratch
+{
+   unsigned char * data;
+   int size;
+   int n;
+   FONScontext * stash;   // Receives FONS_SCRATCH_FULL, NULL for jobs.
+};
+typedef struct FONSscratch FONSscratch;
+
 #ifdef FONS_USE_FREETYPE
 
 #include <ft2build.h>
 #include FT_FREETYPE_H
+
+// Rendering a glyph relies on the glyph slot of the face, so jobs can not run on other threads.
+#define FONS_TT_THREADSAFE 0
 #include FT_ADVANCES_H
 #include <math.h>
 
@@ -176,6 +244,12 @@ int fons__tt_loadFont (FONScontext * context, FONSttFontImpl * font, unsigned ch
    return ftError == 0;
 }
 
+void fons__tt_setScratch (FONSttFontImpl * font, FONSscratch * scratch)
+{
+   FONS_NOTUSED (font);
+   FONS_NOTUSED (scratch);
+}
+
 void fons__tt_getFontVMetrics (FONSttFontImpl * font, int * ascent, int * descent, int * lineGap)
 {
    *ascent = font->font->ascender;
@@ -241,6 +315,8 @@ int fons__tt_getGlyphKernAdvance (FONSttFontImpl * font, int glyph1, int glyph2)
 
 #else
 
+#define FONS_TT_THREADSAFE 1
+
 #define STB_TRUETYPE_IMPLEMENTATION
 static void * fons__tmpalloc (size_t size, void * up);
 static void fons__tmpfree (void * ptr, void * up);
@@ -264,11 +340,16 @@ int fons__tt_loadFont (FONScontext * context, FONSttFontImpl * font, unsigned ch
 {
    int stbError;
    FONS_NOTUSED (dataSize);
-   font->font.userdata = context;
+   FONS_NOTUSED (context);
    stbError = stbtt_InitFont (&font->font, data, 0);
    return stbError;
 }
 
+void fons__tt_setScratch (FONSttFontImpl * font, FONSscratch * scratch)
+{
+   font->font.userdata = scratch;
+}
+
 void fons__tt_getFontVMetrics (FONSttFontImpl * font, int * ascent, int * descent, int * lineGap)
 {
    stbtt_GetFontVMetrics (&font->font, ascent, descent, lineGap);
@@ -321,6 +402,9 @@ int fons__tt_getGlyphKernAdvance (FONSttFontImpl * font, int glyph1, int glyph2)
 #ifndef FONS_INIT_ATLAS_NODES
    #define FONS_INIT_ATLAS_NODES 256
 #endif
+#ifndef FONS_ATLAS_PAGE_HEIGHT
+   #define FONS_ATLAS_PAGE_HEIGHT 128
+#endif
 #ifndef FONS_VERTEX_COUNT
    #define FONS_VERTEX_COUNT 1024
 #endif
@@ -354,9 +438,12 @@ struct FONSglyph
    unsigned int codepoint;
    int index;
    int next;
-   short size, blur;
+   short size, blur;   // Blur is -1 for distance field glyphs.
    short x0, y0, x1, y1;
    short xadv, xoff, yoff;
+   short page;
+   int lastUsed;
+   int job;   // Serial of the job rendering the glyph, 0 once rasterized.
 };
 typedef struct FONSglyph FONSglyph;
 
@@ -377,6 +464,21 @@ struct FONSfont
 };
 typedef struct FONSfont FONSfont;
 
+struct FONSjob
+{
+   FONSttFontImpl font;   // Copy of the font, which allocates from the scratch of the job.
+   FONSfont * owner;
+   unsigned int codepoint;
+   short isize, iblur;
+   int index;
+   float scale;
+   int width, height, pad;
+   int serial;
+   int done;
+   unsigned char * bitmap;
+   struct FONSjob * next;
+};
+
 struct FONSstate
 {
    int font;
@@ -403,6 +505,19 @@ struct FONSatlas
 };
 typedef struct FONSatlas FONSatlas;
 
+// The atlas is split into horizontal bands of FONS_ATLAS_PAGE_HEIGHT pixels, each packed
+// separately so that it can be evicted on its own. A glyph taller than a band spans
+// several bands, which are then merged into the page of the first one.
+struct FONSpage
+{
+   FONSatlas * atlas;
+   int y, height;
+   int span;       // Number of bands in the page, 0 if the band is part of a previous page.
+   int lastUsed;   // Frame the page was last used in.
+   int evict;
+};
+typedef struct FONSpage FONSpage;
+
 struct FONScontext
 {
    FONSparams params;
@@ -410,15 +525,25 @@ struct FONScontext
    unsigned char * texData;
    int dirtyRect[4];
    FONSfont ** fonts;
-   FONSatlas * atlas;
+   FONSpage * pages;
+   int npages;
+   int cpages;
+   int frame;
+   int missWidth, missHeight;   // Size of the last glyph that did not fit.
+   int nrasterized, nevicted;
+   int lastRasterized, lastEvicted;
    int cfonts;
    int nfonts;
    float verts[FONS_VERTEX_COUNT * 2];
    float tcoords[FONS_VERTEX_COUNT * 2];
    unsigned int colors[FONS_VERTEX_COUNT];
    int nverts;
-   unsigned char * scratch;
-   int nscratch;
+   FONSscratch scratch;
+   int async;
+   FONSjob * jobs;   // Jobs not taken yet, newest first.
+   int jobSerial;
+   int npending;
+   int sdf;
    FONSstate states[FONS_MAX_STATES];
    int nstates;
    void (*handleError) (void * uptr, int error, int val);
@@ -428,17 +553,18 @@ struct FONScontext
 static void * fons__tmpalloc (size_t size, void * up)
 {
    unsigned char * ptr;
-   FONScontext * stash = (FONScontext *)up;
+   FONSscratch * scratch = (FONSscratch *)up;
+   FONScontext * stash = scratch->stash;
    // 16-byte align the returned pointer
    size = (size + 0xf) & ~0xf;
-   if (stash->nscratch + (int)size > FONS_SCRATCH_BUF_SIZE)
+   if (scratch->n + (int)size > scratch->size)
    {
-      if (stash->handleError)
-         stash->handleError (stash->errorUptr, FONS_SCRATCH_FULL, stash->nscratch + (int)size);
+      if (stash != NULL && stash->handleError)
+         stash->handleError (stash->errorUptr, FONS_SCRATCH_FULL, scratch->n + (int)size);
       return NULL;
    }
-   ptr = stash->scratch + stash->nscratch;
-   stash->nscratch += (int)size;
+   ptr = scratch->data + scratch->n;
+   scratch->n += (int)size;
    return ptr;
 }
 
@@ -661,11 +787,86 @@ static int fons__atlasAddRect (FONSatlas * atlas, int rw, int rh, int * rx, int
    return 1;
 }
 
+static int fons__bandHeight (int band, int height)
+{
+   return fons__mini (FONS_ATLAS_PAGE_HEIGHT, height - band * FONS_ATLAS_PAGE_HEIGHT);
+}
+
+static int fons__initPages (FONScontext * stash, int first, int width, int height)
+{
+   // Creates empty single band pages from band 'first' to the bottom of the atlas.
+   int i, n = (height + FONS_ATLAS_PAGE_HEIGHT - 1) / FONS_ATLAS_PAGE_HEIGHT;
+   if (n > stash->cpages)
+   {
+      FONSpage * pages = (FONSpage *)realloc (stash->pages, sizeof (FONSpage) * n);
+      if (pages == NULL)
+         return 0;
+      memset (&pages[stash->cpages], 0, sizeof (FONSpage) * (n - stash->cpages));
+      stash->pages = pages;
+      stash->cpages = n;
+   }
+   for (i = first; i < n; i++)
+   {
+      FONSpage * page = &stash->pages[i];
+      page->y = i * FONS_ATLAS_PAGE_HEIGHT;
+      page->height = fons__bandHeight (i, height);
+      page->span = 1;
+      page->lastUsed = -1;
+      page->evict = 0;
+      if (page->atlas == NULL)
+         page->atlas = fons__allocAtlas (width, page->height, FONS_INIT_ATLAS_NODES);
+      else
+         fons__atlasReset (page->atlas, width, page->height);
+      if (page->atlas == NULL)
+         return 0;
+   }
+   stash->npages = n;
+   return 1;
+}
+
+static int fons__expandPages (FONScontext * stash, int width, int height)
+{
+   int i, j, n = stash->npages;
+   // Grow the existing pages, only the last band can get taller.
+   for (i = 0; i < n; i += stash->pages[i].span)
+   {
+      FONSpage * page = &stash->pages[i];
+      page->height = 0;
+      for (j = i; j < i + page->span; j++)
+         page->height += fons__bandHeight (j, height);
+      fons__atlasExpand (page->atlas, width, page->height);
+   }
+   // Merged bands get their packer back when they are split again.
+   for (i = 0; i < n; i++)
+   {
+      if (stash->pages[i].span == 0)
+         fons__atlasReset (stash->pages[i].atlas, width, fons__bandHeight (i, height));
+   }
+   return fons__initPages (stash, n, width, height);
+}
+
+static int fons__allocRect (FONScontext * stash, int w, int h, int * x, int * y)
+{
+   int i;
+   for (i = 0; i < stash->npages; i += stash->pages[i].span)
+   {
+      FONSpage * page = &stash->pages[i];
+      if (h > page->height)
+         continue;
+      if (fons__atlasAddRect (page->atlas, w, h, x, y))
+      {
+         *y += page->y;
+         return i;
+      }
+   }
+   return -1;
+}
+
 static void fons__addWhiteRect (FONScontext * stash, int w, int h)
 {
    int x, y, gx, gy;
    unsigned char * dst;
-   if (fons__atlasAddRect (stash->atlas, w, h, &gx, &gy) == 0)
+   if (fons__allocRect (stash, w, h, &gx, &gy) == -1)
       return;
    // Rasterize
    dst = &stash->texData[gx + gy * stash->params.width];
@@ -690,8 +891,10 @@ FONScontext * fonsCreateInternal (FONSparams * params)
    memset (stash, 0, sizeof (FONScontext));
    stash->params = *params;
    // Allocate scratch buffer.
-   stash->scratch = (unsigned char *)malloc (FONS_SCRATCH_BUF_SIZE);
-   if (stash->scratch == NULL) goto error;
+   stash->scratch.data = (unsigned char *)malloc (FONS_SCRATCH_BUF_SIZE);
+   if (stash->scratch.data == NULL) goto error;
+   stash->scratch.size = FONS_SCRATCH_BUF_SIZE;
+   stash->scratch.stash = stash;
    // Initialize implementation library
    if (!fons__tt_init (stash)) goto error;
    if (stash->params.renderCreate != NULL)
@@ -699,8 +902,7 @@ FONScontext * fonsCreateInternal (FONSparams * params)
       if (stash->params.renderCreate (stash->params.userPtr, stash->params.width, stash->params.height) == 0)
          goto error;
    }
-   stash->atlas = fons__allocAtlas (stash->params.width, stash->params.height, FONS_INIT_ATLAS_NODES);
-   if (stash->atlas == NULL) goto error;
+   if (!fons__initPages (stash, 0, stash->params.width, stash->params.height)) goto error;
    // Allocate space for fonts.
    stash->fonts = (FONSfont **)malloc (sizeof (FONSfont *) * FONS_INIT_FONTS);
    if (stash->fonts == NULL) goto error;
@@ -870,8 +1072,9 @@ int fonsAddFontMem (FONScontext * stash, const char * name, unsigned char * data
    font->data = data;
    font->freeData = (unsigned char)freeData;
    // Init font
-   stash->nscratch = 0;
+   stash->scratch.n = 0;
    if (!fons__tt_loadFont (stash, &font->font, data, dataSize)) goto error;
+   fons__tt_setScratch (&font->font, &stash->scratch);
    // Store normalized line height. The real line height is got
    // by multiplying the lineh by font size.
    fons__tt_getFontVMetrics ( &font->font, &ascent, &descent, &lineGap);
@@ -981,29 +1184,198 @@ static void fons__blur (FONScontext * stash, unsigned char * dst, int w, int h,
    //	fons__blurcols(dst, w, h, dstStride, alpha);
 }
 
+#define FONS_SDF_INF 1e20f
+
+// Squared distance transform of one row or column of the grid (Felzenszwalb & Huttenlocher).
+static void fons__edt1d (float * grid, int offset, int stride, int n, float * f, int * v, float * z)
+{
+   int q, k = 0;
+   f[0] = grid[offset];
+   v[0] = 0;
+   z[0] = -FONS_SDF_INF;
+   z[1] = FONS_SDF_INF;
+   for (q = 1; q < n; q++)
+   {
+      float s;
+      f[q] = grid[offset + q * stride];
+      do
+      {
+         int r = v[k];
+         s = (f[q] - f[r] + (float) (q * q - r * r)) / (float) (2 * (q - r));
+      }
+      while (s <= z[k] && --k > -1);
+      k++;
+      v[k] = q;
+      z[k] = s;
+      z[k + 1] = FONS_SDF_INF;
+   }
+   for (q = 0, k = 0; q < n; q++)
+   {
+      while (z[k + 1] < (float)q) k++;
+      grid[offset + q * stride] = f[v[k]] + (float) ((q - v[k]) * (q - v[k]));
+   }
+}
+
+static void fons__edt (float * grid, int w, int h, float * f, int * v, float * z)
+{
+   int x, y;
+   for (x = 0; x < w; x++)
+      fons__edt1d (grid, x, w, h, f, v, z);
+   for (y = 0; y < h; y++)
+      fons__edt1d (grid, y * w, 1, w, f, v, z);
+}
+
+// Turns the coverage of a glyph into a signed distance field, see fonsSetSDF(). Partially
+// covered pixels place the outline inside the pixel, so the field stays sub-pixel accurate.
+static void fons__distanceField (unsigned char * dst, int w, int h, int stride, int pad)
+{
+   int n = fons__maxi (w, h);
+   float * outer, * inner, * f, * z;
+   int * v;
+   int x, y;
+   outer = (float *)malloc (sizeof (float) * (w * h * 2 + n * 2 + 1) + sizeof (int) * n);
+   if (outer == NULL) return;
+   inner = outer + w * h;
+   f = inner + w * h;
+   z = f + n;
+   v = (int *) (z + n + 1);
+   for (y = 0; y < h; y++)
+   {
+      for (x = 0; x < w; x++)
+      {
+         float a = dst[x + y * stride] / 255.0f, d = 0.5f - a;
+         int i = x + y * w;
+         if (a >= 1.0f)
+         {
+            outer[i] = 0.0f;
+            inner[i] = FONS_SDF_INF;
+         }
+         else
+            if (a <= 0.0f)
+            {
+               outer[i] = FONS_SDF_INF;
+               inner[i] = 0.0f;
+            }
+            else
+            {
+               outer[i] = d > 0.0f ? d * d : 0.0f;
+               inner[i] = d < 0.0f ? d * d : 0.0f;
+            }
+      }
+   }
+   fons__edt (outer, w, h, f, v, z);
+   fons__edt (inner, w, h, f, v, z);
+   for (y = 0; y < h; y++)
+   {
+      for (x = 0; x < w; x++)
+      {
+         float d = sqrtf (outer[x + y * w]) - sqrtf (inner[x + y * w]);
+         int c = (int) (127.5f - d * 127.5f / pad + 0.5f);
+         dst[x + y * stride] = (unsigned char)fons__maxi (0, fons__mini (c, 255));
+      }
+   }
+   free (outer);
+}
+
+// Renders a glyph with 'pad' pixels around it into a gw x gh rectangle at dst.
+static void fons__renderGlyph (FONSttFontImpl * font, unsigned char * dst, int gw, int gh, int stride,
+                               int pad, float scale, int g, int iblur)
+{
+   int x, y;
+   fons__tt_renderGlyphBitmap (font, &dst[pad + pad * stride], gw - pad * 2, gh - pad * 2, stride, scale, scale, g);
+   // Make sure there is one pixel empty border.
+   for (y = 0; y < gh; y++)
+   {
+      dst[y * stride] = 0;
+      dst[gw - 1 + y * stride] = 0;
+   }
+   for (x = 0; x < gw; x++)
+   {
+      dst[x] = 0;
+      dst[x + (gh - 1)*stride] = 0;
+   }
+   // Debug code to color the glyph background
+   /*	unsigned char* fdst = dst;
+   	for (y = 0; y < gh; y++) {
+   		for (x = 0; x < gw; x++) {
+   			int a = (int)fdst[x+y*stride] + 20;
+   			if (a > 255) a = 255;
+   			fdst[x+y*stride] = a;
+   		}
+   	}*/
+   // Blur
+   if (iblur > 0)
+      fons__blur (NULL, dst, gw, gh, stride, iblur);
+   else
+      if (iblur < 0)
+         fons__distanceField (dst, gw, gh, stride, pad);
+}
+
+static int fons__queueJob (FONScontext * stash, FONSfont * font, FONSglyph * glyph, float scale, int pad)
+{
+   int gw = glyph->x1 - glyph->x0, gh = glyph->y1 - glyph->y0;
+   FONSjob * job = (FONSjob *)malloc (sizeof (FONSjob) + gw * gh);
+   if (job == NULL) return 0;
+   memset (job, 0, sizeof (FONSjob));
+   job->font = font->font;
+   job->owner = font;
+   job->codepoint = glyph->codepoint;
+   job->isize = glyph->size;
+   job->iblur = glyph->blur;
+   job->index = glyph->index;
+   job->scale = scale;
+   job->width = gw;
+   job->height = gh;
+   job->pad = pad;
+   job->bitmap = (unsigned char *) (job + 1);
+   job->serial = ++stash->jobSerial;
+   if (job->serial <= 0)
+      job->serial = stash->jobSerial = 1;
+   glyph->job = job->serial;
+   stash->npending++;
+   job->next = stash->jobs;
+   stash->jobs = job;
+   return 1;
+}
+
 static FONSglyph * fons__getGlyph (FONScontext * stash, FONSfont * font, unsigned int codepoint,
                                    short isize, short iblur)
 {
-   int i, g, advance, lsb, x0, y0, x1, y1, gw, gh, gx, gy, x, y;
+   int i, g, advance, lsb, x0, y0, x1, y1, gw, gh, gx, gy;
    float scale;
    FONSglyph * glyph = NULL;
    unsigned int h;
    float size = isize / 10.0f;
-   int pad, added;
-   unsigned char * bdst;
+   int pad, page;
    unsigned char * dst;
    if (isize < 2) return NULL;
-   if (iblur > 20) iblur = 20;
-   pad = iblur + 2;
+   if (stash->sdf)
+   {
+      // One distance field serves all sizes and blurs.
+      isize = FONS_SDF_SIZE * 10;
+      iblur = -1;
+      pad = FONS_SDF_PAD;
+      size = FONS_SDF_SIZE;
+   }
+   else
+   {
+      if (iblur > 20) iblur = 20;
+      pad = iblur + 2;
+   }
    // Reset allocator.
-   stash->nscratch = 0;
+   stash->scratch.n = 0;
    // Find code point and size.
    h = fons__hashint (codepoint) & (FONS_HASH_LUT_SIZE - 1);
    i = font->lut[h];
    while (i != -1)
    {
       if (font->glyphs[i].codepoint == codepoint && font->glyphs[i].size == isize && font->glyphs[i].blur == iblur)
-         return &font->glyphs[i];
+      {
+         glyph = &font->glyphs[i];
+         glyph->lastUsed = stash->frame;
+         stash->pages[glyph->page].lastUsed = stash->frame;
+         return glyph;
+      }
       i = font->glyphs[i].next;
    }
    // Could not find glyph, create it.
@@ -1013,14 +1385,22 @@ static FONSglyph * fons__getGlyph (FONScontext * stash, FONSfont * font, unsigne
    gw = x1 - x0 + pad * 2;
    gh = y1 - y0 + pad * 2;
    // Find free spot for the rect in the atlas
-   added = fons__atlasAddRect (stash->atlas, gw, gh, &gx, &gy);
-   if (added == 0 && stash->handleError != NULL)
+   page = fons__allocRect (stash, gw, gh, &gx, &gy);
+   if (page == -1 && stash->handleError != NULL)
    {
       // Atlas is full, let the user to resize the atlas (or not), and try again.
+      stash->missWidth = gw;
+      stash->missHeight = gh;
       stash->handleError (stash->errorUptr, FONS_ATLAS_FULL, 0);
-      added = fons__atlasAddRect (stash->atlas, gw, gh, &gx, &gy);
+      page = fons__allocRect (stash, gw, gh, &gx, &gy);
+   }
+   if (page == -1)
+   {
+      // Remember the size, so that fonsEvictAtlas() can make room for it.
+      stash->missWidth = gw;
+      stash->missHeight = gh;
+      return NULL;
    }
-   if (added == 0) return NULL;
    // Init glyph.
    glyph = fons__allocGlyph (font);
    glyph->codepoint = codepoint;
@@ -1035,40 +1415,20 @@ static FONSglyph * fons__getGlyph (FONScontext * stash, FONSfont * font, unsigne
    glyph->xoff = (short) (x0 - pad);
    glyph->yoff = (short) (y0 - pad);
    glyph->next = 0;
+   glyph->page = (short)page;
+   glyph->lastUsed = stash->frame;
+   glyph->job = 0;
+   stash->pages[page].lastUsed = stash->frame;
    // Insert char to hash lookup.
    glyph->next = font->lut[h];
    font->lut[h] = font->nglyphs - 1;
    // Rasterize
-   dst = &stash->texData[ (glyph->x0 + pad) + (glyph->y0 + pad) * stash->params.width];
-   fons__tt_renderGlyphBitmap (&font->font, dst, gw - pad * 2, gh - pad * 2, stash->params.width, scale, scale, g);
-   // Make sure there is one pixel empty border.
+   if (stash->async && fons__queueJob (stash, font, glyph, scale, pad))
+      return glyph;
+   stash->scratch.n = 0;
    dst = &stash->texData[glyph->x0 + glyph->y0 * stash->params.width];
-   for (y = 0; y < gh; y++)
-   {
-      dst[y * stash->params.width] = 0;
-      dst[gw - 1 + y * stash->params.width] = 0;
-   }
-   for (x = 0; x < gw; x++)
-   {
-      dst[x] = 0;
-      dst[x + (gh - 1)*stash->params.width] = 0;
-   }
-   // Debug code to color the glyph background
-   /*	unsigned char* fdst = &stash->texData[glyph->x0 + glyph->y0 * stash->params.width];
-   	for (y = 0; y < gh; y++) {
-   		for (x = 0; x < gw; x++) {
-   			int a = (int)fdst[x+y*stash->params.width] + 20;
-   			if (a > 255) a = 255;
-   			fdst[x+y*stash->params.width] = a;
-   		}
-   	}*/
-   // Blur
-   if (iblur > 0)
-   {
-      stash->nscratch = 0;
-      bdst = &stash->texData[glyph->x0 + glyph->y0 * stash->params.width];
-      fons__blur (stash, bdst, gw, gh, stash->params.width, iblur);
-   }
+   fons__renderGlyph (&font->font, dst, gw, gh, stash->params.width, pad, scale, g, iblur);
+   stash->nrasterized++;
    stash->dirtyRect[0] = fons__mini (stash->dirtyRect[0], glyph->x0);
    stash->dirtyRect[1] = fons__mini (stash->dirtyRect[1], glyph->y0);
    stash->dirtyRect[2] = fons__maxi (stash->dirtyRect[2], glyph->x1);
@@ -1076,11 +1436,43 @@ static FONSglyph * fons__getGlyph (FONScontext * stash, FONSfont * font, unsigne
    return glyph;
 }
 
-static void fons__getQuad (FONScontext * stash, FONSfont * font,
-                           int prevGlyphIndex, FONSglyph * glyph,
-                           float scale, float spacing, float * x, float * y, FONSquad * q)
+// Returns the rasterized size of the glyph closest to a glyph waiting for its job, or the glyph.
+static FONSglyph * fons__placeholder (FONScontext * stash, FONSfont * font, FONSglyph * glyph)
+{
+   FONSglyph * best = glyph;
+   int bestd = 0x7fff;
+   int i = font->lut[fons__hashint (glyph->codepoint) & (FONS_HASH_LUT_SIZE - 1)];
+   FONS_NOTUSED (stash);
+   while (i != -1)
+   {
+      FONSglyph * g = &font->glyphs[i];
+      if (g->codepoint == glyph->codepoint && g->blur == glyph->blur && g->job == 0)
+      {
+         int d = fons__maxi (g->size - glyph->size, glyph->size - g->size);
+         if (d < bestd)
+         {
+            best = g;
+            bestd = d;
+         }
+      }
+      i = g->next;
+   }
+   return best;
+}
+
+// Returns the page the quad samples.
+static int fons__getQuad (FONScontext * stash, FONSfont * font,
+                          int prevGlyphIndex, FONSglyph * glyph, short isize, short iblur,
+                          float scale, float spacing, float * x, float * y, FONSquad * q)
 {
-   float rx, ry, xoff, yoff, x0, y0, x1, y1;
+   float rx, ry, xoff, yoff, x0, y0, x1, y1, w, h;
+   float gs = 1.0f, inset = 1.0f;
+   FONSglyph * tex = glyph;
+   if (glyph->job != 0)
+   {
+      tex = fons__placeholder (stash, font, glyph);
+      stash->pages[tex->page].lastUsed = stash->frame;
+   }
    if (prevGlyphIndex != -1)
    {
       float adv = fons__tt_getGlyphKernAdvance (&font->font, prevGlyphIndex, glyph->index) * scale;
@@ -1089,20 +1481,29 @@ static void fons__getQuad (FONScontext * stash, FONSfont * font,
    // Each glyph has 2px border to allow good interpolation,
    // one pixel to prevent leaking, and one to allow good interpolation for rendering.
    // Inset the texture region by one pixel for correct interpolation.
-   xoff = (short) (glyph->xoff + 1);
-   yoff = (short) (glyph->yoff + 1);
-   x0 = (float) (glyph->x0 + 1);
-   y0 = (float) (glyph->y0 + 1);
-   x1 = (float) (glyph->x1 - 1);
-   y1 = (float) (glyph->y1 - 1);
+   // Distance field glyphs are scaled to the size, and inset to cover one pixel and the blur.
+   if (glyph->blur < 0)
+   {
+      gs = isize / (FONS_SDF_SIZE * 10.0f);
+      inset = FONS_SDF_PAD - (iblur + 1) / gs;
+      if (inset < 1.0f) inset = 1.0f;
+   }
+   xoff = (glyph->xoff + inset) * gs;
+   yoff = (glyph->yoff + inset) * gs;
+   w = (glyph->x1 - glyph->x0 - inset * 2) * gs;
+   h = (glyph->y1 - glyph->y0 - inset * 2) * gs;
+   x0 = tex->x0 + inset;
+   y0 = tex->y0 + inset;
+   x1 = tex->x1 - inset;
+   y1 = tex->y1 - inset;
    if (stash->params.flags & FONS_ZERO_TOPLEFT)
    {
-      rx = (float) (int) (*x + xoff);
-      ry = (float) (int) (*y + yoff);
+      rx = glyph->blur < 0 ? *x + xoff : (float) (int) (*x + xoff);
+      ry = glyph->blur < 0 ? *y + yoff : (float) (int) (*y + yoff);
       q->x0 = rx;
       q->y0 = ry;
-      q->x1 = rx + x1 - x0;
-      q->y1 = ry + y1 - y0;
+      q->x1 = rx + w;
+      q->y1 = ry + h;
       q->s0 = x0 * stash->itw;
       q->t0 = y0 * stash->ith;
       q->s1 = x1 * stash->itw;
@@ -1110,18 +1511,19 @@ static void fons__getQuad (FONScontext * stash, FONSfont * font,
    }
    else
    {
-      rx = (float) (int) (*x + xoff);
-      ry = (float) (int) (*y - yoff);
+      rx = glyph->blur < 0 ? *x + xoff : (float) (int) (*x + xoff);
+      ry = glyph->blur < 0 ? *y - yoff : (float) (int) (*y - yoff);
       q->x0 = rx;
       q->y0 = ry;
-      q->x1 = rx + x1 - x0;
-      q->y1 = ry - y1 + y0;
+      q->x1 = rx + w;
+      q->y1 = ry - h;
       q->s0 = x0 * stash->itw;
       q->t0 = y0 * stash->ith;
       q->s1 = x1 * stash->itw;
       q->t1 = y1 * stash->ith;
    }
-   *x += (int) (glyph->xadv / 10.0f + 0.5f);
+   *x += (int) (glyph->xadv * gs / 10.0f + 0.5f);
+   return tex->page;
 }
 
 static void fons__flush (FONScontext * stash)
@@ -1237,7 +1639,7 @@ float fonsDrawText (FONScontext * stash,
       glyph = fons__getGlyph (stash, font, codepoint, isize, iblur);
       if (glyph != NULL)
       {
-         fons__getQuad (stash, font, prevGlyphIndex, glyph, scale, state->spacing, &x, &y, &q);
+         fons__getQuad (stash, font, prevGlyphIndex, glyph, isize, iblur, scale, state->spacing, &x, &y, &q);
          if (stash->nverts + 6 > FONS_VERTEX_COUNT)
             fons__flush (stash);
          fons__vertex (stash, q.x0, q.y0, q.s0, q.t0, state->color);
@@ -1314,8 +1716,10 @@ int fonsTextIterNext (FONScontext * stash, FONStextIter * iter, FONSquad * quad)
       iter->x = iter->nextx;
       iter->y = iter->nexty;
       glyph = fons__getGlyph (stash, iter->font, iter->codepoint, iter->isize, iter->iblur);
+      iter->page = -1;
       if (glyph != NULL)
-         fons__getQuad (stash, iter->font, iter->prevGlyphIndex, glyph, iter->scale, iter->spacing, &iter->nextx, &iter->nexty, quad);
+         iter->page = fons__getQuad (stash, iter->font, iter->prevGlyphIndex, glyph, iter->isize, iter->iblur,
+                                       iter->scale, iter->spacing, &iter->nextx, &iter->nexty, quad);
       iter->prevGlyphIndex = glyph != NULL ? glyph->index : -1;
       break;
    }
@@ -1325,7 +1729,7 @@ int fonsTextIterNext (FONScontext * stash, FONStextIter * iter, FONSquad * quad)
 
 void fonsDrawDebug (FONScontext * stash, float x, float y)
 {
-   int i;
+   int i, p;
    int w = stash->params.width;
    int h = stash->params.height;
    float u = w == 0 ? 0 : (1.0f / w);
@@ -1347,17 +1751,22 @@ void fonsDrawDebug (FONScontext * stash, float x, float y)
    fons__vertex (stash, x + 0, y + h, 0, 1, 0xffffffff);
    fons__vertex (stash, x + w, y + h, 1, 1, 0xffffffff);
    // Drawbug draw atlas
-   for (i = 0; i < stash->atlas->nnodes; i++)
-   {
-      FONSatlasNode * n = &stash->atlas->nodes[i];
-      if (stash->nverts + 6 > FONS_VERTEX_COUNT)
-         fons__flush (stash);
-      fons__vertex (stash, x + n->x + 0, y + n->y + 0, u, v, 0xc00000ff);
-      fons__vertex (stash, x + n->x + n->width, y + n->y + 1, u, v, 0xc00000ff);
-      fons__vertex (stash, x + n->x + n->width, y + n->y + 0, u, v, 0xc00000ff);
-      fons__vertex (stash, x + n->x + 0, y + n->y + 0, u, v, 0xc00000ff);
-      fons__vertex (stash, x + n->x + 0, y + n->y + 1, u, v, 0xc00000ff);
-      fons__vertex (stash, x + n->x + n->width, y + n->y + 1, u, v, 0xc00000ff);
+   for (p = 0; p < stash->npages; p += stash->pages[p].span)
+   {
+      FONSpage * page = &stash->pages[p];
+      for (i = 0; i < page->atlas->nnodes; i++)
+      {
+         FONSatlasNode * n = &page->atlas->nodes[i];
+         float ny = y + page->y + n->y;
+         if (stash->nverts + 6 > FONS_VERTEX_COUNT)
+            fons__flush (stash);
+         fons__vertex (stash, x + n->x + 0, ny + 0, u, v, 0xc00000ff);
+         fons__vertex (stash, x + n->x + n->width, ny + 1, u, v, 0xc00000ff);
+         fons__vertex (stash, x + n->x + n->width, ny + 0, u, v, 0xc00000ff);
+         fons__vertex (stash, x + n->x + 0, ny + 0, u, v, 0xc00000ff);
+         fons__vertex (stash, x + n->x + 0, ny + 1, u, v, 0xc00000ff);
+         fons__vertex (stash, x + n->x + n->width, ny + 1, u, v, 0xc00000ff);
+      }
    }
    fons__flush (stash);
 }
@@ -1398,7 +1807,7 @@ float fonsTextBounds (FONScontext * stash,
       glyph = fons__getGlyph (stash, font, codepoint, isize, iblur);
       if (glyph != NULL)
       {
-         fons__getQuad (stash, font, prevGlyphIndex, glyph, scale, state->spacing, &x, &y, &q);
+         fons__getQuad (stash, font, prevGlyphIndex, glyph, isize, iblur, scale, state->spacing, &x, &y, &q);
          if (q.x0 < minx) minx = q.x0;
          if (q.x1 > maxx) maxx = q.x1;
          if (stash->params.flags & FONS_ZERO_TOPLEFT)
@@ -1519,10 +1928,18 @@ void fonsDeleteInternal (FONScontext * stash)
       stash->params.renderDelete (stash->params.userPtr);
    for (i = 0; i < stash->nfonts; ++i)
       fons__freeFont (stash->fonts[i]);
-   if (stash->atlas) fons__deleteAtlas (stash->atlas);
+   for (i = 0; i < stash->cpages; ++i)
+      fons__deleteAtlas (stash->pages[i].atlas);
+   if (stash->pages) free (stash->pages);
    if (stash->fonts) free (stash->fonts);
    if (stash->texData) free (stash->texData);
-   if (stash->scratch) free (stash->scratch);
+   while (stash->jobs != NULL)
+   {
+      FONSjob * job = stash->jobs;
+      stash->jobs = job->next;
+      free (job);
+   }
+   if (stash->scratch.data) free (stash->scratch.data);
    free (stash);
 }
 
@@ -1542,7 +1959,7 @@ void fonsGetAtlasSize (FONScontext * stash, int * width, int * height)
 
 int fonsExpandAtlas (FONScontext * stash, int width, int height)
 {
-   int i, maxy = 0;
+   int i;
    unsigned char * data = NULL;
    if (stash == NULL) return 0;
    width = fons__maxi (width, stash->params.width);
@@ -1574,14 +1991,13 @@ int fonsExpandAtlas (FONScontext * stash, int width, int height)
    free (stash->texData);
    stash->texData = data;
    // Increase atlas size
-   fons__atlasExpand (stash->atlas, width, height);
+   if (!fons__expandPages (stash, width, height))
+      return 0;
    // Add existing data as dirty.
-   for (i = 0; i < stash->atlas->nnodes; i++)
-      maxy = fons__maxi (maxy, stash->atlas->nodes[i].y);
    stash->dirtyRect[0] = 0;
    stash->dirtyRect[1] = 0;
    stash->dirtyRect[2] = stash->params.width;
-   stash->dirtyRect[3] = maxy;
+   stash->dirtyRect[3] = stash->params.height;
    stash->params.width = width;
    stash->params.height = height;
    stash->itw = 1.0f / stash->params.width;
@@ -1602,7 +2018,8 @@ int fonsResetAtlas (FONScontext * stash, int width, int height)
          return 0;
    }
    // Reset atlas
-   fons__atlasReset (stash->atlas, width, height);
+   if (!fons__initPages (stash, 0, width, height))
+      return 0;
    // Clear texture data.
    stash->texData = (unsigned char *)realloc (stash->texData, width * height);
    if (stash->texData == NULL) return 0;
@@ -1613,6 +2030,7 @@ int fonsResetAtlas (FONScontext * stash, int width, int height)
    stash->dirtyRect[2] = 0;
    stash->dirtyRect[3] = 0;
    // Reset cached glyphs
+   stash->npending = 0;
    for (i = 0; i < stash->nfonts; i++)
    {
       FONSfont * font = stash->fonts[i];
@@ -1629,5 +2047,480 @@ int fonsResetAtlas (FONScontext * stash, int width, int height)
    return 1;
 }
 
+void fonsBeginFrame (FONScontext * stash)
+{
+   if (stash == NULL) return;
+   stash->lastRasterized = stash->nrasterized;
+   stash->lastEvicted = stash->nevicted;
+   stash->nrasterized = 0;
+   stash->nevicted = 0;
+   stash->frame++;
+}
+
+void fonsTouchPages (FONScontext * stash, unsigned int mask)
+{
+   int i;
+   if (stash == NULL || mask == 0) return;
+   for (i = 0; i < stash->npages; i += stash->pages[i].span)
+   {
+      if (mask & (1u << (i & 31)))
+         stash->pages[i].lastUsed = stash->frame;
+   }
+}
+
+static void fons__evictPages (FONScontext * stash, int first, int n)
+{
+   int i, j, k, y0, y1;
+   for (i = first; i < first + n; i += stash->pages[i].span)
+   {
+      stash->pages[i].evict = 1;
+      stash->nevicted++;
+   }
+   // Drop the glyphs of the evicted pages and rebuild the hash lookups.
+   for (i = 0; i < stash->nfonts; i++)
+   {
+      FONSfont * font = stash->fonts[i];
+      for (j = k = 0; j < font->nglyphs; j++)
+      {
+         if (!stash->pages[font->glyphs[j].page].evict)
+            font->glyphs[k++] = font->glyphs[j];
+         else if (font->glyphs[j].job != 0)
+            stash->npending--;
+      }
+      font->nglyphs = k;
+      for (j = 0; j < FONS_HASH_LUT_SIZE; j++)
+         font->lut[j] = -1;
+      for (j = 0; j < font->nglyphs; j++)
+      {
+         unsigned int h = fons__hashint (font->glyphs[j].codepoint) & (FONS_HASH_LUT_SIZE - 1);
+         font->glyphs[j].next = font->lut[h];
+         font->lut[h] = j;
+      }
+   }
+   // Clear the texture, the padding around glyphs is not written when they are rasterized.
+   y0 = stash->pages[first].y;
+   y1 = stash->pages[first + n - 1].y + fons__bandHeight (first + n - 1, stash->params.height);
+   memset (&stash->texData[y0 * stash->params.width], 0, (y1 - y0) * stash->params.width);
+   stash->dirtyRect[0] = 0;
+   stash->dirtyRect[1] = fons__mini (stash->dirtyRect[1], y0);
+   stash->dirtyRect[2] = stash->params.width;
+   stash->dirtyRect[3] = fons__maxi (stash->dirtyRect[3], y1);
+   // Split the pages back into single bands.
+   for (i = first; i < first + n; i++)
+   {
+      FONSpage * page = &stash->pages[i];
+      page->height = fons__bandHeight (i, stash->params.height);
+      page->span = 1;
+      page->lastUsed = -1;
+      page->evict = 0;
+      fons__atlasReset (page->atlas, stash->params.width, page->height);
+   }
+}
+
+int fonsEvictAtlas (FONScontext * stash)
+{
+   int i, j, height, used, best = -1, bestn = 0, bestUsed = 0;
+   if (stash == NULL) return 0;
+   if (stash->missHeight <= 0 || stash->missWidth > stash->params.width)
+      return 0;
+   // Find the run of whole pages tall enough for the glyph, which was used least recently.
+   for (i = 0; i < stash->npages; i += stash->pages[i].span)
+   {
+      height = 0;
+      used = -1;
+      for (j = i; j < stash->npages && height < stash->missHeight; j += stash->pages[j].span)
+      {
+         if (stash->pages[j].lastUsed == stash->frame)
+            break;
+         used = fons__maxi (used, stash->pages[j].lastUsed);
+         height += stash->pages[j].height;
+      }
+      if (height < stash->missHeight)
+         continue;
+      if (best == -1 || used < bestUsed)
+      {
+         best = i;
+         bestn = j - i;
+         bestUsed = used;
+      }
+   }
+   if (best == -1)
+      return 0;
+   fons__evictPages (stash, best, bestn);
+   // Merge as many bands as the glyph needs.
+   height = 0;
+   for (j = best; height < stash->missHeight; j++)
+      height += stash->pages[j].height;
+   if (j - best > 1)
+   {
+      for (i = best + 1; i < j; i++)
+         stash->pages[i].span = 0;
+      stash->pages[best].span = j - best;
+      stash->pages[best].height = height;
+      fons__atlasReset (stash->pages[best].atlas, stash->params.width, height);
+   }
+   if (best == 0)
+      fons__addWhiteRect (stash, 2, 2);
+   stash->missWidth = 0;
+   stash->missHeight = 0;
+   return 1;
+}
+
+int fonsSetAsync (FONScontext * stash, int enabled)
+{
+   FONSjob * job;
+   if (stash == NULL) return 0;
+   stash->async = enabled && FONS_TT_THREADSAFE;
+   if (!stash->async)
+   {
+      while ((job = fonsTakeJob (stash)) != NULL)
+      {
+         fonsRunJob (job);
+         fonsCommitJob (stash, job);
+      }
+   }
+   return stash->async;
+}
+
+FONSjob * fonsTakeJob (FONScontext * stash)
+{
+   FONSjob * job;
+   if (stash == NULL || stash->jobs == NULL) return NULL;
+   job = stash->jobs;
+   stash->jobs = job->next;
+   job->next = NULL;
+   return job;
+}
+
+int fonsPendingGlyphs (FONScontext * stash)
+{
+   return stash != NULL ? stash->npending : 0;
+}
+
+void fonsSetSDF (FONScontext * stash, int enabled)
+{
+   if (stash == NULL) return;
+   stash->sdf = enabled;
+}
+
+void fonsRunJob (FONSjob * job)
+{
+   FONSscratch scratch;
+   memset (&scratch, 0, sizeof (scratch));
+   scratch.data = (unsigned char *)malloc (FONS_SCRATCH_BUF_SIZE);
+   if (scratch.data == NULL) return;
+   scratch.size = FONS_SCRATCH_BUF_SIZE;
+   fons__tt_setScratch (&job->font, &scratch);
+   memset (job->bitmap, 0, job->width * job->height);
+   fons__renderGlyph (&job->font, job->bitmap, job->width, job->height, job->width,
+                      job->pad, job->scale, job->index, job->iblur);
+   free (scratch.data);
+   job->done = 1;
+}
+
+int fonsCommitJob (FONScontext * stash, FONSjob * job)
+{
+   FONSfont * font = job->owner;
+   FONSglyph * glyph = NULL;
+   int i, y;
+   i = font->lut[fons__hashint (job->codepoint) & (FONS_HASH_LUT_SIZE - 1)];
+   while (i != -1)
+   {
+      if (font->glyphs[i].job == job->serial)
+      {
+         glyph = &font->glyphs[i];
+         break;
+      }
+      i = font->glyphs[i].next;
+   }
+   if (glyph != NULL)
+   {
+      if (job->done)
+      {
+         for (y = 0; y < job->height; y++)
+            memcpy (&stash->texData[glyph->x0 + (glyph->y0 + y) * stash->params.width], &job->bitmap[y * job->width], job->width);
+      }
+      else
+      {
+         // The job failed, else the glyph would stay pending for good.
+         stash->scratch.n = 0;
+         fons__renderGlyph (&font->font, &stash->texData[glyph->x0 + glyph->y0 * stash->params.width],
+                            job->width, job->height, stash->params.width, job->pad, job->scale, job->index, job->iblur);
+      }
+      glyph->job = 0;
+      stash->npending--;
+      stash->nrasterized++;
+      stash->dirtyRect[0] = fons__mini (stash->dirtyRect[0], glyph->x0);
+      stash->dirtyRect[1] = fons__mini (stash->dirtyRect[1], glyph->y0);
+      stash->dirtyRect[2] = fons__maxi (stash->dirtyRect[2], glyph->x1);
+      stash->dirtyRect[3] = fons__maxi (stash->dirtyRect[3], glyph->y1);
+   }
+   free (job);
+   return glyph != NULL;
+}
+
+void fonsAtlasStats (FONScontext * stash, int * rasterized, int * evicted, int * glyphs)
+{
+   int i, n = 0;
+   if (stash == NULL) return;
+   for (i = 0; i < stash->nfonts; i++)
+      n += stash->fonts[i]->nglyphs;
+   if (rasterized != NULL) *rasterized = stash->lastRasterized;
+   if (evicted != NULL) *evicted = stash->lastEvicted;
+   if (glyphs != NULL) *glyphs = n;
+}
+
+int fonsFrameRasterized (FONScontext * stash)
+{
+   if (stash == NULL) return 0;
+   return stash->nrasterized;
+}
+
+#define FONS_CACHE_VERSION 1
+#define FONS_CACHE_FNV 2166136261u
+
+// The header is followed by the pages with their skyline nodes, the glyphs and hash lookup
+// of each font, and the bitmap of the atlas.
+struct FONScacheHeader
+{
+   char magic[4];
+   int version;
+   unsigned int hash;    // Of the fonts and of the settings the glyphs depend on.
+   unsigned int check;   // Of the data following the header.
+   float scale;          // The glyphs were rasterized for, see fonsSaveAtlas().
+   int width, height;
+   int npages;
+   int nfonts;
+};
+typedef struct FONScacheHeader FONScacheHeader;
+
+// FNV-1a, a word at a time.
+static unsigned int fons__hashBytes (unsigned int h, const void * data, int n)
+{
+   const unsigned char * p = (const unsigned char *)data;
+   unsigned int w;
+   int i;
+   for (i = 0; i + 4 <= n; i += 4)
+   {
+      memcpy (&w, p + i, 4);
+      h = (h ^ w) * 16777619u;
+   }
+   for (; i < n; i++)
+      h = (h ^ p[i]) * 16777619u;
+   return h;
+}
+
+static unsigned int fons__cacheHash (FONScontext * stash)
+{
+   // FONS_TT_THREADSAFE tells the two rasterizers apart.
+   int layout[8] = { FONS_CACHE_VERSION, (int)sizeof (FONSglyph), FONS_ATLAS_PAGE_HEIGHT, FONS_HASH_LUT_SIZE,
+                     FONS_SDF_SIZE, FONS_SDF_PAD, FONS_TT_THREADSAFE, 0
+                   };
+   unsigned int h;
+   int i;
+   layout[7] = stash->sdf;
+   h = fons__hashBytes (FONS_CACHE_FNV, layout, sizeof (layout));
+   for (i = 0; i < stash->nfonts; i++)
+   {
+      FONSfont * font = stash->fonts[i];
+      h = fons__hashBytes (h, font->name, (int)strlen (font->name));
+      h = fons__hashBytes (h, &font->dataSize, sizeof (int));
+      h = fons__hashBytes (h, font->data, font->dataSize);
+   }
+   return h;
+}
+
+static unsigned char * fons__cachePut (unsigned char * p, const void * data, int n)
+{
+   memcpy (p, data, n);
+   return p + n;
+}
+
+static int fons__cacheRead (const unsigned char ** p, const unsigned char * end, void * dst, int n)
+{
+   if (n < 0 || end - *p < n)
+      return 0;
+   memcpy (dst, *p, n);
+   *p += n;
+   return 1;
+}
+
+int fonsSaveAtlas (FONScontext * stash, const char * path, float scale)
+{
+   FONScacheHeader hdr;
+   FILE * fp;
+   unsigned char * data, * p;
+   int i, size, desc[3], ok;
+   if (stash == NULL || stash->npending > 0) return 0;
+   memset (&hdr, 0, sizeof (hdr));
+   memcpy (hdr.magic, "FONC", 4);
+   hdr.version = FONS_CACHE_VERSION;
+   hdr.hash = fons__cacheHash (stash);
+   hdr.scale = scale;
+   hdr.width = stash->params.width;
+   hdr.height = stash->params.height;
+   hdr.npages = stash->npages;
+   hdr.nfonts = stash->nfonts;
+   // Gather the data, the header carries its check.
+   size = hdr.width * hdr.height;
+   for (i = 0; i < stash->npages; i++)
+      size += sizeof (desc) + sizeof (FONSatlasNode) * stash->pages[i].atlas->nnodes;
+   for (i = 0; i < stash->nfonts; i++)
+      size += sizeof (int) + sizeof (FONSglyph) * stash->fonts[i]->nglyphs + sizeof (stash->fonts[i]->lut);
+   data = (unsigned char *)malloc (size);
+   if (data == NULL) return 0;
+   p = data;
+   for (i = 0; i < stash->npages; i++)
+   {
+      FONSpage * page = &stash->pages[i];
+      desc[0] = page->height;
+      desc[1] = page->span;
+      desc[2] = page->atlas->nnodes;
+      p = fons__cachePut (p, desc, sizeof (desc));
+      p = fons__cachePut (p, page->atlas->nodes, sizeof (FONSatlasNode) * desc[2]);
+   }
+   for (i = 0; i < stash->nfonts; i++)
+   {
+      FONSfont * font = stash->fonts[i];
+      p = fons__cachePut (p, &font->nglyphs, sizeof (int));
+      p = fons__cachePut (p, font->glyphs, sizeof (FONSglyph) * font->nglyphs);
+      p = fons__cachePut (p, font->lut, sizeof (font->lut));
+   }
+   fons__cachePut (p, stash->texData, hdr.width * hdr.height);
+   hdr.check = fons__hashBytes (FONS_CACHE_FNV, data, size);
+   ok = 0;
+   fp = fopen (path, "wb");
+   if (fp != NULL)
+   {
+      ok = fwrite (&hdr, sizeof (hdr), 1, fp) == 1 && fwrite (data, 1, size, fp) == (size_t)size;
+      ok &= fclose (fp) == 0;
+      if (!ok)
+         remove (path);
+   }
+   free (data);
+   return ok;
+}
+
+// Replaces the atlas with the cached one, the data has been checked against the header.
+static int fons__loadCache (FONScontext * stash, const FONScacheHeader * hdr, const unsigned char * p, const unsigned char * end)
+{
+   unsigned char * texData;
+   int i, j, desc[3], nglyphs;
+   if (hdr->nfonts != stash->nfonts || hdr->width <= 0 || hdr->height <= 0 ||
+         hdr->npages != (hdr->height + FONS_ATLAS_PAGE_HEIGHT - 1) / FONS_ATLAS_PAGE_HEIGHT)
+      return 0;
+   fons__flush (stash);
+   if (stash->params.renderResize != NULL)
+   {
+      if (stash->params.renderResize (stash->params.userPtr, hdr->width, hdr->height) == 0)
+         return 0;
+   }
+   if (!fons__initPages (stash, 0, hdr->width, hdr->height))
+      return 0;
+   for (i = 0; i < hdr->npages; i++)
+   {
+      FONSpage * page = &stash->pages[i];
+      FONSatlas * atlas = page->atlas;
+      if (!fons__cacheRead (&p, end, desc, sizeof (desc)))
+         return 0;
+      if (desc[2] < 1 || desc[2] > (int) ((end - p) / sizeof (FONSatlasNode)))
+         return 0;
+      if (desc[2] > atlas->cnodes)
+      {
+         FONSatlasNode * nodes = (FONSatlasNode *)realloc (atlas->nodes, sizeof (FONSatlasNode) * desc[2]);
+         if (nodes == NULL)
+            return 0;
+         atlas->nodes = nodes;
+         atlas->cnodes = desc[2];
+      }
+      page->height = desc[0];
+      page->span = desc[1];
+      atlas->height = desc[0];
+      atlas->nnodes = desc[2];
+      fons__cacheRead (&p, end, atlas->nodes, sizeof (FONSatlasNode) * desc[2]);
+   }
+   for (i = 0; i < hdr->nfonts; i++)
+   {
+      FONSfont * font = stash->fonts[i];
+      font->nglyphs = 0;
+      if (!fons__cacheRead (&p, end, &nglyphs, sizeof (int)))
+         return 0;
+      if (nglyphs < 0 || nglyphs > (int) ((end - p) / sizeof (FONSglyph)))
+         return 0;
+      if (nglyphs > font->cglyphs)
+      {
+         FONSglyph * glyphs = (FONSglyph *)realloc (font->glyphs, sizeof (FONSglyph) * nglyphs);
+         if (glyphs == NULL)
+            return 0;
+         font->glyphs = glyphs;
+         font->cglyphs = nglyphs;
+      }
+      fons__cacheRead (&p, end, font->glyphs, sizeof (FONSglyph) * nglyphs);
+      if (!fons__cacheRead (&p, end, font->lut, sizeof (font->lut)))
+         return 0;
+      font->nglyphs = nglyphs;
+      for (j = 0; j < nglyphs; j++)
+         font->glyphs[j].lastUsed = -1;
+   }
+   if (end - p != hdr->width * hdr->height)
+      return 0;
+   texData = (unsigned char *)realloc (stash->texData, hdr->width * hdr->height);
+   if (texData == NULL)
+      return 0;
+   stash->texData = texData;
+   memcpy (stash->texData, p, hdr->width * hdr->height);
+   stash->params.width = hdr->width;
+   stash->params.height = hdr->height;
+   stash->itw = 1.0f / stash->params.width;
+   stash->ith = 1.0f / stash->params.height;
+   stash->npending = 0;
+   // Upload everything at once.
+   stash->dirtyRect[0] = 0;
+   stash->dirtyRect[1] = 0;
+   stash->dirtyRect[2] = stash->params.width;
+   stash->dirtyRect[3] = stash->params.height;
+   return 1;
+}
+
+int fonsLoadAtlas (FONScontext * stash, const char * path, float scale)
+{
+   FONScacheHeader hdr;
+   FILE * fp = 0;
+   unsigned char * data = NULL;
+   int size, width, height, ok = 0;
+   if (stash == NULL) return 0;
+   // Read in the whole file.
+   fp = fopen (path, "rb");
+   if (fp == NULL) goto error;
+   fseek (fp, 0, SEEK_END);
+   size = (int)ftell (fp);
+   fseek (fp, 0, SEEK_SET);
+   if (size < (int)sizeof (hdr)) goto error;
+   data = (unsigned char *)malloc (size);
+   if (data == NULL) goto error;
+   if (fread (data, 1, size, fp) != (size_t)size) goto error;
+   fclose (fp);
+   fp = 0;
+   memcpy (&hdr, data, sizeof (hdr));
+   if (memcmp (hdr.magic, "FONC", 4) != 0 || hdr.version != FONS_CACHE_VERSION)
+      goto error;
+   if (hdr.hash != fons__cacheHash (stash))
+      goto error;
+   // Glyphs of other sizes would never be used, distance fields are scaled when drawn.
+   if (!stash->sdf && hdr.scale != scale)
+      goto error;
+   if (hdr.check != fons__hashBytes (FONS_CACHE_FNV, data + sizeof (hdr), size - (int)sizeof (hdr)))
+      goto error;
+   width = stash->params.width;
+   height = stash->params.height;
+   ok = fons__loadCache (stash, &hdr, data + sizeof (hdr), data + size);
+   if (!ok)
+      fonsResetAtlas (stash, width, height);
+error:
+   if (data) free (data);
+   if (fp) fclose (fp);
+   return ok;
+}
+
 
 #endif
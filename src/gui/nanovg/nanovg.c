@@ -24,6 +24,28 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 
+#if !defined(NVG_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define NVG_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#ifndef NVG_NO_THREADS
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+typedef HANDLE NVGthread;
+typedef CRITICAL_SECTION NVGmutex;
+typedef CONDITION_VARIABLE NVGcond;
+#else
+#include <pthread.h>
+typedef pthread_t NVGthread;
+typedef pthread_mutex_t NVGmutex;
+typedef pthread_cond_t NVGcond;
+#endif
+#endif
+
 #ifdef _MSC_VER
 #pragma warning(disable: 4100)  // unreferenced formal parameter
 #pragma warning(disable: 4127)  // conditional expression is constant
@@ -41,6 +63,19 @@
 #define NVG_INIT_VERTS_SIZE 256
 #define NVG_MAX_STATES 32
 
+#define NVG_TEXT_CACHE_SIZE 512			// Number of remembered text measurements.
+#define NVG_TEXT_CACHE_BUCKETS 1024		// Must be power of two.
+#define NVG_TEXT_CACHE_MAX_STRING 1024	// Longer strings are measured every time.
+
+#define NVG_PATH_CACHE_SIZE 256			// Max number of paths kept by nvgCachedPath().
+#define NVG_PATH_CACHE_BUCKETS 512		// Must be power of two.
+#define NVG_PATH_CACHE_BYTES (4*1024*1024)	// Default memory limit of the cached paths.
+#define NVG_PATH_CACHE_MAX_VALS 16		// Paths defined by more values are not cached.
+
+#define NVG_MAX_THREADS 16				// Max number of threads tessellating deferred paths.
+#define NVG_TESS_JOB_BATCH 16			// Number of paths a thread claims at once.
+#define NVG_TESS_MIN_PARALLEL 64		// Fewer deferred paths are tessellated on the calling thread only.
+
 #define NVG_KAPPA90 0.5522847493f	// Length proportional to radius of a cubic bezier handle for 90deg arcs.
 
 #define NVG_COUNTOF(arr) (sizeof(arr) / sizeof(0[arr]))
@@ -101,9 +136,174 @@ struct NVGpathCache {
 	int nverts;
 	int cverts;
 	float bounds[4];
+	int vertReallocs;		// Reallocations since the counters were last collected.
+	int growth;
 };
 typedef struct NVGpathCache NVGpathCache;
 
+enum NVGrecordCallType {
+	NVG_RECORD_FILL = 0,
+	NVG_RECORD_STROKE = 1,
+	NVG_RECORD_TRIANGLES = 2,
+};
+
+struct NVGrecordCall {
+	int type;
+	NVGpaint paint;
+	NVGscissor scissor;
+	float fringe;
+	float strokeWidth;
+	float bounds[4];
+	int pathOffset;
+	int pathCount;
+	int vertOffset;
+	int vertCount;
+	int job;				// Deferred tessellation job which holds the geometry, -1 if the call holds it.
+};
+typedef struct NVGrecordCall NVGrecordCall;
+
+struct NVGrecording {
+	NVGrecordCall* calls;
+	int ncalls;
+	int ccalls;
+	NVGpath* paths;
+	int npaths;
+	int cpaths;
+	NVGvertex* verts;
+	int nverts;
+	int cverts;
+	float xform[6];
+	NVGscissor scissor;
+	float alpha;
+	float devicePxRatio;
+	int atlasGeneration;
+	unsigned int atlasPages;	// Font atlas pages the recorded text is drawn from.
+	int valid;
+	struct NVGrecording* parent;
+};
+
+enum NVGtextMeasureType {
+	NVG_MEASURE_BOUNDS = 0,
+	NVG_MEASURE_BOX_BOUNDS = 1,
+	NVG_MEASURE_RUN = 2,
+};
+
+// Everything the result of a text measurement depends on, except the string.
+// Only 4 byte members, so that keys can be compared with memcmp().
+struct NVGtextKey {
+	int type;
+	int fontId;
+	int textAlign;
+	float fontSize;
+	float letterSpacing;
+	float fontBlur;
+	float lineHeight;
+	float scale;
+	float x, y;
+	float breakRowWidth;
+};
+typedef struct NVGtextKey NVGtextKey;
+
+struct NVGtextMeasure {
+	NVGtextKey key;
+	unsigned int hash;
+	char* str;
+	int len;
+	int cstr;
+	float width;
+	float bounds[4];
+	int next;				// Next measure in the hash bucket.
+	int lruPrev, lruNext;	// Neighbours in the use order, most recent first.
+};
+typedef struct NVGtextMeasure NVGtextMeasure;
+
+struct NVGtextCache {
+	NVGtextMeasure measures[NVG_TEXT_CACHE_SIZE];
+	int nmeasures;
+	int buckets[NVG_TEXT_CACHE_BUCKETS];
+	int lruHead, lruTail;
+	int hits, misses;
+};
+typedef struct NVGtextCache NVGtextCache;
+
+// A path expanded for fill or stroke. The fill and stroke pointers of the paths are offsets into verts.
+struct NVGcachedShape {
+	int valid;
+	float width;			// Parameters the shape was expanded with.
+	int lineCap;
+	int lineJoin;
+	float miterLimit;
+	NVGpath* paths;
+	int cpaths;
+	NVGvertex* verts;
+	int nverts;
+	int cverts;
+};
+typedef struct NVGcachedShape NVGcachedShape;
+
+struct NVGcachedPath {
+	unsigned int key;		// Hash of shape and vals.
+	unsigned int shape;
+	float vals[NVG_PATH_CACHE_MAX_VALS];
+	int nvals;
+	int valid;				// The flattened points are stored.
+	float xform[6];			// Transform the path was flattened with, points are relative to its translation.
+	float devicePxRatio;
+	NVGpoint* points;
+	int npoints;
+	int cpoints;
+	NVGpath* paths;
+	int npaths;
+	int cpaths;
+	float bounds[4];
+	NVGcachedShape fill;
+	NVGcachedShape stroke;
+	int bytes;
+	int next;				// Next path in the hash bucket, or in the free list.
+	int lruPrev, lruNext;	// Neighbours in the use order, most recent first.
+};
+typedef struct NVGcachedPath NVGcachedPath;
+
+struct NVGcachedPaths {
+	NVGcachedPath entries[NVG_PATH_CACHE_SIZE];
+	int nentries;
+	int count;
+	int freeList;
+	int buckets[NVG_PATH_CACHE_BUCKETS];
+	int lruHead, lruTail;
+	int maxPaths, maxBytes;
+	int bytes;
+	int hits, misses, evictions;
+};
+typedef struct NVGcachedPaths NVGcachedPaths;
+
+struct NVGtextRun {
+	NVGcontext* ctx;
+	NVGtextKey key;			// Position is stored as the sub-pixel offset.
+	char* str;
+	int len;
+	int cstr;
+	int atlasGeneration;
+	unsigned int atlasPages;
+	float* quads;			// x0,y0,x1,y1,s0,t0,s1,t1 per glyph, relative to the whole pixel origin.
+	int nquads;
+	int cquads;
+	float advance;
+	int valid;
+};
+
+struct NVGkernels {
+	// Calculates direction and length of the segments of a closed polyline, and grows bounds.
+	void (*segments)(NVGpoint* pts, int npts, float* bounds);
+	// Calculates extrusions and join flags, returns the number of beveled joins.
+	int (*joins)(NVGpoint* pts, int npts, float iw, float miterLimit, int bevel, int* nleft);
+	// Writes the vertices p+dm*lw and p-dm*rw for each point.
+	NVGvertex* (*extrude)(NVGvertex* dst, const NVGpoint* pts, int npts, float lw, float rw, float lu, float ru);
+	// Writes the vertex p+dm*w for each point.
+	NVGvertex* (*inset)(NVGvertex* dst, const NVGpoint* pts, int npts, float w, float u);
+};
+typedef struct NVGkernels NVGkernels;
+
 struct NVGcontext {
 	NVGparams params;
 	float* commands;
@@ -120,11 +320,100 @@ struct NVGcontext {
 	struct FONScontext* fs;
 	int fontImages[NVG_MAX_FONTIMAGES];
 	int fontImageIdx;
-	int drawCallCount;
-	int fillTriCount;
-	int strokeTriCount;
-	int textTriCount;
+	int fontImageFlags;		// NVG_IMAGE_SDF when glyphs are distance fields.
+	NVGrecording* recording;
+	int atlasGeneration;
+	NVGtextCache* textCache;
+	const NVGkernels* kernels;
+	NVGcachedPaths* cachedPaths;
+	int cachedPath;			// Entry the current path is stored to or restored from, -1 if none.
+	float cachedOffset[2];	// Translation of the current path relative to the cached one.
+	struct NVGtessPool* tessPool;	// Non-NULL when tessellation is deferred to nvgEndFrame().
+	struct NVGglyphPool* glyphPool;	// Non-NULL when glyphs are rasterized asynchronously.
+	NVGframeSizes frameSizes;		// High-water marks of the current frame.
+	NVGframeSizes lastFrameSizes;
+	NVGframeSizes peakFrameSizes;
+	NVGframeStats frameStats;		// Counters of the current frame.
+	NVGframeStats lastFrameStats;
+};
+
+// A fill or stroke whose tessellation is deferred to the end of the frame.
+struct NVGtessJob {
+	int stroke;
+	int commandOffset;
+	int commandCount;
+	float w;
+	int lineCap;
+	int lineJoin;
+	float miterLimit;
+	int worker;				// Worker which tessellated the path, its output holds the geometry.
+	int pathOffset;
+	int pathCount;			// -1 if tessellation failed.
+	float bounds[4];
+};
+typedef struct NVGtessJob NVGtessJob;
+
+struct NVGworker {
+	struct NVGtessPool* pool;
+	NVGcontext tess;		// Copy of the context at the end of the frame, tessellating into its own path cache.
+	NVGpathCache* cache;
+	NVGrecording out;		// Tessellated paths of the frame.
+	int index;
+	int generation;
+#ifndef NVG_NO_THREADS
+	NVGthread thread;
+#endif
+};
+typedef struct NVGworker NVGworker;
+
+struct NVGtessPool {
+	NVGworker workers[NVG_MAX_THREADS];	// The first one runs on the thread calling nvgEndFrame().
+	int nworkers;
+	NVGrecording queue;		// Render calls of the frame in order.
+	NVGtessJob* jobs;
+	int njobs;
+	int cjobs;
+	float* commands;		// Path commands of the jobs.
+	int ncommands;
+	int ccommands;
+	int pathCommands;		// Offset of the current path in commands, -1 if it was not copied yet.
+	int nextJob;
+#ifndef NVG_NO_THREADS
+	NVGmutex mutex;
+	NVGcond wake;
+	NVGcond done;
+	int generation;
+	int pending;			// Number of threads still working on the current generation.
+	int quit;
+#endif
+};
+typedef struct NVGtessPool NVGtessPool;
+
+// Threads rasterizing the glyphs fontstash queues as jobs while nvgAsyncGlyphs() is on.
+struct NVGglyphPool {
+#ifndef NVG_NO_THREADS
+	NVGthread threads[NVG_MAX_THREADS];
+	int nthreads;
+	NVGmutex mutex;
+	NVGcond wake;
+	FONSjob** queue;		// Jobs waiting for a thread, from nextJob on.
+	int nqueue;
+	int cqueue;
+	int nextJob;
+	int pending;			// Jobs queued or being rasterized.
+	FONSjob** done;			// Rasterized jobs, committed at the start of the next frame.
+	int ndone;
+	int cdone;
+	int quit;
+#endif
 };
+typedef struct NVGglyphPool NVGglyphPool;
+
+static void nvg__resetDeferred(NVGcontext* ctx);
+static void nvg__runDeferred(NVGcontext* ctx);
+static void nvg__dispatchGlyphs(NVGcontext* ctx);
+static void nvg__commitGlyphs(NVGcontext* ctx);
+static void nvg__collectFrameStats(NVGcontext* ctx);
 
 static float nvg__sqrtf(float a) { return sqrtf(a); }
 static float nvg__modf(float a, float b) { return fmodf(a, b); }
@@ -155,6 +444,16 @@ static float nvg__normalize(float *x, float* y)
 	return d;
 }
 
+static void nvg__maxSizes(NVGframeSizes* dst, const NVGframeSizes* src)
+{
+	dst->commands = nvg__maxi(dst->commands, src->commands);
+	dst->points = nvg__maxi(dst->points, src->points);
+	dst->paths = nvg__maxi(dst->paths, src->paths);
+	dst->verts = nvg__maxi(dst->verts, src->verts);
+	dst->calls = nvg__maxi(dst->calls, src->calls);
+	dst->callPaths = nvg__maxi(dst->callPaths, src->callPaths);
+	dst->callVerts = nvg__maxi(dst->callVerts, src->callVerts);
+}
 
 static void nvg__deletePathCache(NVGpathCache* c)
 {
@@ -220,6 +519,21 @@ NVGcontext* nvgCreateInternal(NVGparams* params)
 	ctx->cache = nvg__allocPathCache();
 	if (ctx->cache == NULL) goto error;
 
+	ctx->textCache = (NVGtextCache*)malloc(sizeof(NVGtextCache));
+	if (ctx->textCache == NULL) goto error;
+	memset(ctx->textCache, 0, sizeof(NVGtextCache));
+	nvgClearTextCache(ctx);
+
+	ctx->cachedPaths = (NVGcachedPaths*)malloc(sizeof(NVGcachedPaths));
+	if (ctx->cachedPaths == NULL) goto error;
+	memset(ctx->cachedPaths, 0, sizeof(NVGcachedPaths));
+	ctx->cachedPaths->maxPaths = NVG_PATH_CACHE_SIZE;
+	ctx->cachedPaths->maxBytes = NVG_PATH_CACHE_BYTES;
+	nvgClearCachedPaths(ctx);
+	ctx->tessPool = NULL;
+
+	nvgUseSimd(ctx, 1);
+
 	nvgSave(ctx);
 	nvgReset(ctx);
 
@@ -263,6 +577,17 @@ void nvgDeleteInternal(NVGcontext* ctx)
 	if (ctx == NULL) return;
 	if (ctx->commands != NULL) free(ctx->commands);
 	if (ctx->cache != NULL) nvg__deletePathCache(ctx->cache);
+	if (ctx->textCache != NULL) {
+		for (i = 0; i < NVG_TEXT_CACHE_SIZE; i++)
+			free(ctx->textCache->measures[i].str);
+		free(ctx->textCache);
+	}
+	if (ctx->cachedPaths != NULL) {
+		nvgClearCachedPaths(ctx);
+		free(ctx->cachedPaths);
+	}
+	nvgDeferTessellation(ctx, 0);
+	nvgAsyncGlyphs(ctx, 0);
 
 	if (ctx->fs)
 		fonsDeleteInternal(ctx->fs);
@@ -282,32 +607,37 @@ void nvgDeleteInternal(NVGcontext* ctx)
 
 void nvgBeginFrame(NVGcontext* ctx, int windowWidth, int windowHeight, float devicePixelRatio)
 {
-/*	printf("Tris: draws:%d  fill:%d  stroke:%d  text:%d  TOT:%d\n",
-		ctx->drawCallCount, ctx->fillTriCount, ctx->strokeTriCount, ctx->textTriCount,
-		ctx->fillTriCount+ctx->strokeTriCount+ctx->textTriCount);*/
-
 	ctx->nstates = 0;
 	nvgSave(ctx);
 	nvgReset(ctx);
+	ctx->recording = NULL;
+	nvg__resetDeferred(ctx);
+	memset(&ctx->frameSizes, 0, sizeof(ctx->frameSizes));
+	memset(&ctx->frameStats, 0, sizeof(ctx->frameStats));
+	ctx->cache->vertReallocs = 0;
+	ctx->cache->growth = 0;
+	fonsBeginFrame(ctx->fs);
+	nvg__commitGlyphs(ctx);
 
 	nvg__setDevicePixelRatio(ctx, devicePixelRatio);
 	
 	ctx->params.renderViewport(ctx->params.userPtr, windowWidth, windowHeight);
-
-	ctx->drawCallCount = 0;
-	ctx->fillTriCount = 0;
-	ctx->strokeTriCount = 0;
-	ctx->textTriCount = 0;
 }
 
 void nvgCancelFrame(NVGcontext* ctx)
 {
+	nvg__resetDeferred(ctx);
 	ctx->params.renderCancel(ctx->params.userPtr);
 }
 
 void nvgEndFrame(NVGcontext* ctx)
 {
+	nvg__dispatchGlyphs(ctx);
+	nvg__runDeferred(ctx);
+	ctx->lastFrameSizes = ctx->frameSizes;
+	nvg__maxSizes(&ctx->peakFrameSizes, &ctx->frameSizes);
 	ctx->params.renderFlush(ctx->params.userPtr);
+	nvg__collectFrameStats(ctx);
 	if (ctx->fontImageIdx != 0) {
 		int fontImage = ctx->fontImages[ctx->fontImageIdx];
 		int i, j, iw, ih;
@@ -965,6 +1295,9 @@ static void nvg__appendCommands(NVGcontext* ctx, float* vals, int nvals)
 	NVGstate* state = nvg__getState(ctx);
 	int i;
 
+	if (ctx->tessPool != NULL)
+		ctx->tessPool->pathCommands = -1;
+
 	if (ctx->ncommands+nvals > ctx->ccommands) {
 		float* commands;
 		int ccommands = ctx->ncommands+nvals + ctx->ccommands/2;
@@ -972,6 +1305,7 @@ static void nvg__appendCommands(NVGcontext* ctx, float* vals, int nvals)
 		if (commands == NULL) return;
 		ctx->commands = commands;
 		ctx->ccommands = ccommands;
+		ctx->cache->growth++;
 	}
 
 	if ((int)vals[0] != NVG_CLOSE && (int)vals[0] != NVG_WINDING) {
@@ -1012,6 +1346,7 @@ static void nvg__appendCommands(NVGcontext* ctx, float* vals, int nvals)
 	memcpy(&ctx->commands[ctx->ncommands], vals, nvals*sizeof(float));
 
 	ctx->ncommands += nvals;
+	ctx->frameSizes.commands = nvg__maxi(ctx->frameSizes.commands, ctx->ncommands);
 }
 
 
@@ -1038,6 +1373,7 @@ static void nvg__addPath(NVGcontext* ctx)
 		if (paths == NULL) return;
 		ctx->cache->paths = paths;
 		ctx->cache->cpaths = cpaths;
+		ctx->cache->growth++;
 	}
 	path = &ctx->cache->paths[ctx->cache->npaths];
 	memset(path, 0, sizeof(*path));
@@ -1075,6 +1411,7 @@ static void nvg__addPoint(NVGcontext* ctx, float x, float y, int flags)
 		if (points == NULL) return;
 		ctx->cache->points = points;
 		ctx->cache->cpoints = cpoints;
+		ctx->cache->growth++;
 	}
 
 	pt = &ctx->cache->points[ctx->cache->npoints];
@@ -1110,6 +1447,7 @@ static float nvg__getAverageScale(float *t)
 
 static NVGvertex* nvg__allocTempVerts(NVGcontext* ctx, int nverts)
 {
+	ctx->frameSizes.verts = nvg__maxi(ctx->frameSizes.verts, nverts);
 	if (nverts > ctx->cache->cverts) {
 		NVGvertex* verts;
 		int cverts = (nverts + 0xff) & ~0xff; // Round up to prevent allocations when things change just slightly.
@@ -1117,6 +1455,7 @@ static NVGvertex* nvg__allocTempVerts(NVGcontext* ctx, int nverts)
 		if (verts == NULL) return NULL;
 		ctx->cache->verts = verts;
 		ctx->cache->cverts = cverts;
+		ctx->cache->vertReallocs++;
 	}
 
 	return ctx->cache->verts;
@@ -1209,6 +1548,334 @@ static void nvg__tesselateBezier(NVGcontext* ctx,
 	nvg__tesselateBezier(ctx, x1234,y1234, x234,y234, x34,y34, x4,y4, level+1, type); 
 }
 
+//
+// Tessellation kernels
+//
+// The per point loops of path flattening, join calculation and fringe expansion.
+// The SIMD versions use the same operations in the same order as the scalar ones, so
+// they give the same results unless the compiler fuses the scalar multiply-adds.
+
+static int nvg__joinPoint(const NVGpoint* p0, NVGpoint* p1, float iw, float miterLimit, int bevel)
+{
+	float dlx0, dly0, dlx1, dly1, dmr2, cross, limit;
+	dlx0 = p0->dy;
+	dly0 = -p0->dx;
+	dlx1 = p1->dy;
+	dly1 = -p1->dx;
+	// Calculate extrusions
+	p1->dmx = (dlx0 + dlx1) * 0.5f;
+	p1->dmy = (dly0 + dly1) * 0.5f;
+	dmr2 = p1->dmx*p1->dmx + p1->dmy*p1->dmy;
+	if (dmr2 > 0.000001f) {
+		float scale = 1.0f / dmr2;
+		if (scale > 600.0f) {
+			scale = 600.0f;
+		}
+		p1->dmx *= scale;
+		p1->dmy *= scale;
+	}
+
+	// Clear flags, but keep the corner.
+	p1->flags = (p1->flags & NVG_PT_CORNER) ? NVG_PT_CORNER : 0;
+
+	// Keep track of left turns.
+	cross = p1->dx * p0->dy - p0->dx * p1->dy;
+	if (cross > 0.0f)
+		p1->flags |= NVG_PT_LEFT;
+
+	// Calculate if we should use bevel or miter for inner join.
+	limit = nvg__maxf(1.01f, nvg__minf(p0->len, p1->len) * iw);
+	if ((dmr2 * limit*limit) < 1.0f)
+		p1->flags |= NVG_PR_INNERBEVEL;
+
+	// Check to see if the corner needs to be beveled.
+	if (p1->flags & NVG_PT_CORNER) {
+		if ((dmr2 * miterLimit*miterLimit) < 1.0f || bevel) {
+			p1->flags |= NVG_PT_BEVEL;
+		}
+	}
+
+	return p1->flags;
+}
+
+static void nvg__segmentsC(NVGpoint* pts, int npts, float* bounds)
+{
+	NVGpoint* p0 = &pts[npts-1];
+	NVGpoint* p1 = &pts[0];
+	int i;
+	for (i = 0; i < npts; i++) {
+		// Calculate segment direction and length
+		p0->dx = p1->x - p0->x;
+		p0->dy = p1->y - p0->y;
+		p0->len = nvg__normalize(&p0->dx, &p0->dy);
+		// Update bounds
+		bounds[0] = nvg__minf(bounds[0], p0->x);
+		bounds[1] = nvg__minf(bounds[1], p0->y);
+		bounds[2] = nvg__maxf(bounds[2], p0->x);
+		bounds[3] = nvg__maxf(bounds[3], p0->y);
+		// Advance
+		p0 = p1++;
+	}
+}
+
+static int nvg__joinsC(NVGpoint* pts, int npts, float iw, float miterLimit, int bevel, int* nleft)
+{
+	NVGpoint* p0 = &pts[npts-1];
+	NVGpoint* p1 = &pts[0];
+	int j, flags, nbevel = 0;
+	for (j = 0; j < npts; j++) {
+		flags = nvg__joinPoint(p0, p1, iw, miterLimit, bevel);
+		if (flags & NVG_PT_LEFT)
+			(*nleft)++;
+		if ((flags & (NVG_PT_BEVEL | NVG_PR_INNERBEVEL)) != 0)
+			nbevel++;
+		p0 = p1++;
+	}
+	return nbevel;
+}
+
+static NVGvertex* nvg__extrudeC(NVGvertex* dst, const NVGpoint* pts, int npts, float lw, float rw, float lu, float ru)
+{
+	int i;
+	for (i = 0; i < npts; i++) {
+		const NVGpoint* p = &pts[i];
+		nvg__vset(dst, p->x + (p->dmx * lw), p->y + (p->dmy * lw), lu,1); dst++;
+		nvg__vset(dst, p->x - (p->dmx * rw), p->y - (p->dmy * rw), ru,1); dst++;
+	}
+	return dst;
+}
+
+static NVGvertex* nvg__insetC(NVGvertex* dst, const NVGpoint* pts, int npts, float w, float u)
+{
+	int i;
+	for (i = 0; i < npts; i++) {
+		const NVGpoint* p = &pts[i];
+		nvg__vset(dst, p->x + (p->dmx * w), p->y + (p->dmy * w), u,1); dst++;
+	}
+	return dst;
+}
+
+#ifdef NVG_SSE2
+// Returns (s, v0, v1, v2), where s is the first lane of s.
+static __m128 nvg__shiftIn(__m128 v, __m128 s)
+{
+	return _mm_move_ss(_mm_shuffle_ps(v, v, _MM_SHUFFLE(2,1,0,3)), s);
+}
+
+// Returns (v1, v2, v3, s), where s is the first lane of s.
+static __m128 nvg__shiftOut(__m128 v, __m128 s)
+{
+	__m128 t = _mm_move_ss(v, s);
+	return _mm_shuffle_ps(t, t, _MM_SHUFFLE(0,3,2,1));
+}
+
+static __m128 nvg__select(__m128 mask, __m128 a, __m128 b)
+{
+	return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+static void nvg__segmentsSSE2(NVGpoint* pts, int npts, float* bounds)
+{
+	const __m128 eps = _mm_set1_ps(1e-6f), one = _mm_set1_ps(1.0f);
+	__m128 xmin = _mm_set1_ps(bounds[0]), ymin = _mm_set1_ps(bounds[1]);
+	__m128 xmax = _mm_set1_ps(bounds[2]), ymax = _mm_set1_ps(bounds[3]);
+	float dx[4], dy[4], len[4], b[4];
+	int i, k;
+
+	// Four segments at a time, as long as their end points are not wrapped around.
+	for (i = 0; i + 4 < npts; i += 4) {
+		__m128 x = _mm_loadu_ps(&pts[i].x), y = _mm_loadu_ps(&pts[i+1].x);
+		__m128 c = _mm_loadu_ps(&pts[i+2].x), d = _mm_loadu_ps(&pts[i+3].x);
+		__m128 n = _mm_loadl_pi(_mm_setzero_ps(), (const __m64*)&pts[i+4].x);
+		__m128 vdx, vdy, vlen, id, m;
+		_MM_TRANSPOSE4_PS(x, y, c, d);
+		vdx = _mm_sub_ps(nvg__shiftOut(x, n), x);
+		vdy = _mm_sub_ps(nvg__shiftOut(y, _mm_shuffle_ps(n, n, _MM_SHUFFLE(1,1,1,1))), y);
+		vlen = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(vdx, vdx), _mm_mul_ps(vdy, vdy)));
+		m = _mm_cmpgt_ps(vlen, eps);
+		id = _mm_div_ps(one, vlen);
+		_mm_storeu_ps(dx, nvg__select(m, _mm_mul_ps(vdx, id), vdx));
+		_mm_storeu_ps(dy, nvg__select(m, _mm_mul_ps(vdy, id), vdy));
+		_mm_storeu_ps(len, vlen);
+		for (k = 0; k < 4; k++) {
+			pts[i+k].dx = dx[k];
+			pts[i+k].dy = dy[k];
+			pts[i+k].len = len[k];
+		}
+		xmin = _mm_min_ps(xmin, x);
+		ymin = _mm_min_ps(ymin, y);
+		xmax = _mm_max_ps(xmax, x);
+		ymax = _mm_max_ps(ymax, y);
+	}
+
+	_mm_storeu_ps(b, xmin);
+	bounds[0] = nvg__minf(nvg__minf(b[0], b[1]), nvg__minf(b[2], b[3]));
+	_mm_storeu_ps(b, ymin);
+	bounds[1] = nvg__minf(nvg__minf(b[0], b[1]), nvg__minf(b[2], b[3]));
+	_mm_storeu_ps(b, xmax);
+	bounds[2] = nvg__maxf(nvg__maxf(b[0], b[1]), nvg__maxf(b[2], b[3]));
+	_mm_storeu_ps(b, ymax);
+	bounds[3] = nvg__maxf(nvg__maxf(b[0], b[1]), nvg__maxf(b[2], b[3]));
+
+	// The rest, including the segment which closes the loop.
+	for (; i < npts; i++) {
+		NVGpoint* p0 = &pts[i];
+		NVGpoint* p1 = &pts[i+1 < npts ? i+1 : 0];
+		p0->dx = p1->x - p0->x;
+		p0->dy = p1->y - p0->y;
+		p0->len = nvg__normalize(&p0->dx, &p0->dy);
+		bounds[0] = nvg__minf(bounds[0], p0->x);
+		bounds[1] = nvg__minf(bounds[1], p0->y);
+		bounds[2] = nvg__maxf(bounds[2], p0->x);
+		bounds[3] = nvg__maxf(bounds[3], p0->y);
+	}
+}
+
+static int nvg__joinsSSE2(NVGpoint* pts, int npts, float iw, float miterLimit, int bevel, int* nleft)
+{
+	const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f), half = _mm_set1_ps(0.5f);
+	const __m128 sign = _mm_set1_ps(-0.0f), eps = _mm_set1_ps(0.000001f);
+	const __m128 maxScale = _mm_set1_ps(600.0f), minLimit = _mm_set1_ps(1.01f);
+	const __m128 viw = _mm_set1_ps(iw), vml = _mm_set1_ps(miterLimit);
+	float dmx[4], dmy[4];
+	int j, k, flags, nbevel = 0;
+
+	if (npts <= 0) return 0;
+
+	// The first point joins the last segment.
+	flags = nvg__joinPoint(&pts[npts-1], &pts[0], iw, miterLimit, bevel);
+	if (flags & NVG_PT_LEFT)
+		(*nleft)++;
+	if ((flags & (NVG_PT_BEVEL | NVG_PR_INNERBEVEL)) != 0)
+		nbevel++;
+
+	for (j = 1; j + 4 <= npts; j += 4) {
+		// Transpose dx,dy,len of four points, and shift in the previous point.
+		__m128 cdx = _mm_loadu_ps(&pts[j].dx), cdy = _mm_loadu_ps(&pts[j+1].dx);
+		__m128 clen = _mm_loadu_ps(&pts[j+2].dx), c3 = _mm_loadu_ps(&pts[j+3].dx);
+		__m128 p = _mm_loadu_ps(&pts[j-1].dx);
+		__m128 pdx, pdy, plen, vdmx, vdmy, dmr2, scale, cross, limit;
+		int left, inner, miter;
+		_MM_TRANSPOSE4_PS(cdx, cdy, clen, c3);
+		pdx = nvg__shiftIn(cdx, p);
+		pdy = nvg__shiftIn(cdy, _mm_shuffle_ps(p, p, _MM_SHUFFLE(1,1,1,1)));
+		plen = nvg__shiftIn(clen, _mm_shuffle_ps(p, p, _MM_SHUFFLE(2,2,2,2)));
+
+		// Calculate extrusions
+		vdmx = _mm_mul_ps(_mm_add_ps(pdy, cdy), half);
+		vdmy = _mm_mul_ps(_mm_add_ps(_mm_xor_ps(pdx, sign), _mm_xor_ps(cdx, sign)), half);
+		dmr2 = _mm_add_ps(_mm_mul_ps(vdmx, vdmx), _mm_mul_ps(vdmy, vdmy));
+		scale = _mm_min_ps(_mm_div_ps(one, dmr2), maxScale);
+		scale = nvg__select(_mm_cmpgt_ps(dmr2, eps), scale, one);
+		_mm_storeu_ps(dmx, _mm_mul_ps(vdmx, scale));
+		_mm_storeu_ps(dmy, _mm_mul_ps(vdmy, scale));
+
+		// Left turns, inner bevels and miter limit, one bit per point.
+		cross = _mm_sub_ps(_mm_mul_ps(cdx, pdy), _mm_mul_ps(pdx, cdy));
+		left = _mm_movemask_ps(_mm_cmpgt_ps(cross, zero));
+		limit = _mm_max_ps(minLimit, _mm_mul_ps(_mm_min_ps(plen, clen), viw));
+		inner = _mm_movemask_ps(_mm_cmplt_ps(_mm_mul_ps(_mm_mul_ps(dmr2, limit), limit), one));
+		miter = _mm_movemask_ps(_mm_cmplt_ps(_mm_mul_ps(_mm_mul_ps(dmr2, vml), vml), one));
+
+		for (k = 0; k < 4; k++) {
+			NVGpoint* p1 = &pts[j+k];
+			p1->dmx = dmx[k];
+			p1->dmy = dmy[k];
+			flags = (p1->flags & NVG_PT_CORNER) ? NVG_PT_CORNER : 0;
+			if (left & (1 << k)) {
+				flags |= NVG_PT_LEFT;
+				(*nleft)++;
+			}
+			if (inner & (1 << k))
+				flags |= NVG_PR_INNERBEVEL;
+			if ((flags & NVG_PT_CORNER) && ((miter & (1 << k)) || bevel))
+				flags |= NVG_PT_BEVEL;
+			if ((flags & (NVG_PT_BEVEL | NVG_PR_INNERBEVEL)) != 0)
+				nbevel++;
+			p1->flags = (unsigned char)flags;
+		}
+	}
+
+	for (; j < npts; j++) {
+		flags = nvg__joinPoint(&pts[j-1], &pts[j], iw, miterLimit, bevel);
+		if (flags & NVG_PT_LEFT)
+			(*nleft)++;
+		if ((flags & (NVG_PT_BEVEL | NVG_PR_INNERBEVEL)) != 0)
+			nbevel++;
+	}
+	return nbevel;
+}
+
+static NVGvertex* nvg__extrudeSSE2(NVGvertex* dst, const NVGpoint* pts, int npts, float lw, float rw, float lu, float ru)
+{
+	// Both vertices of a point at once, subtracting dm*rw is adding dm*-rw.
+	const __m128 w = _mm_setr_ps(lw, lw, -rw, -rw);
+	const __m128 uv = _mm_setr_ps(lu, 1.0f, ru, 1.0f);
+	int i;
+	for (i = 0; i < npts; i++) {
+		__m128 p = _mm_loadl_pi(_mm_setzero_ps(), (const __m64*)&pts[i].x);
+		__m128 dm = _mm_loadl_pi(_mm_setzero_ps(), (const __m64*)&pts[i].dmx);
+		__m128 r = _mm_add_ps(_mm_movelh_ps(p, p), _mm_mul_ps(_mm_movelh_ps(dm, dm), w));
+		_mm_storeu_ps(&dst[0].x, _mm_shuffle_ps(r, uv, _MM_SHUFFLE(1,0,1,0)));
+		_mm_storeu_ps(&dst[1].x, _mm_shuffle_ps(r, uv, _MM_SHUFFLE(3,2,3,2)));
+		dst += 2;
+	}
+	return dst;
+}
+
+static NVGvertex* nvg__insetSSE2(NVGvertex* dst, const NVGpoint* pts, int npts, float w, float u)
+{
+	const __m128 vw = _mm_set1_ps(w);
+	const __m128 uv = _mm_setr_ps(u, 1.0f, u, 1.0f);
+	int i;
+	for (i = 0; i + 2 <= npts; i += 2) {
+		__m128 p = _mm_loadl_pi(_mm_setzero_ps(), (const __m64*)&pts[i].x);
+		__m128 dm = _mm_loadl_pi(_mm_setzero_ps(), (const __m64*)&pts[i].dmx);
+		__m128 r;
+		p = _mm_loadh_pi(p, (const __m64*)&pts[i+1].x);
+		dm = _mm_loadh_pi(dm, (const __m64*)&pts[i+1].dmx);
+		r = _mm_add_ps(p, _mm_mul_ps(dm, vw));
+		_mm_storeu_ps(&dst[0].x, _mm_shuffle_ps(r, uv, _MM_SHUFFLE(1,0,1,0)));
+		_mm_storeu_ps(&dst[1].x, _mm_shuffle_ps(r, uv, _MM_SHUFFLE(3,2,3,2)));
+		dst += 2;
+	}
+	if (i < npts)
+		dst = nvg__insetC(dst, &pts[i], 1, w, u);
+	return dst;
+}
+#endif
+
+static const NVGkernels nvg__scalarKernels = {
+	nvg__segmentsC, nvg__joinsC, nvg__extrudeC, nvg__insetC
+};
+
+#ifdef NVG_SSE2
+static const NVGkernels nvg__sse2Kernels = {
+	nvg__segmentsSSE2, nvg__joinsSSE2, nvg__extrudeSSE2, nvg__insetSSE2
+};
+#endif
+
+int nvgUseSimd(NVGcontext* ctx, int enable)
+{
+	ctx->kernels = &nvg__scalarKernels;
+#ifdef NVG_SSE2
+	if (enable)
+		ctx->kernels = &nvg__sse2Kernels;
+#else
+	NVG_NOTUSED(enable);
+#endif
+	return ctx->kernels != &nvg__scalarKernels;
+}
+
+// Returns the number of points from the start which have none of the flags set.
+static int nvg__countRun(const NVGpoint* pts, int npts, int flags)
+{
+	int n = 0;
+	while (n < npts && (pts[n].flags & flags) == 0)
+		n++;
+	return n;
+}
+
 static void nvg__flattenPaths(NVGcontext* ctx)
 {
 	NVGpathCache* cache = ctx->cache;
@@ -1292,20 +1959,12 @@ static void nvg__flattenPaths(NVGcontext* ctx)
 				nvg__polyReverse(pts, path->count);
 		}
 
-		for(i = 0; i < path->count; i++) {
-			// Calculate segment direction and length
-			p0->dx = p1->x - p0->x;
-			p0->dy = p1->y - p0->y;
-			p0->len = nvg__normalize(&p0->dx, &p0->dy);
-			// Update bounds
-			cache->bounds[0] = nvg__minf(cache->bounds[0], p0->x);
-			cache->bounds[1] = nvg__minf(cache->bounds[1], p0->y);
-			cache->bounds[2] = nvg__maxf(cache->bounds[2], p0->x);
-			cache->bounds[3] = nvg__maxf(cache->bounds[3], p0->y);
-			// Advance
-			p0 = p1++;
-		}
+		// Calculate segment direction and length, and update bounds.
+		ctx->kernels->segments(pts, path->count, cache->bounds);
 	}
+
+	ctx->frameSizes.points = nvg__maxi(ctx->frameSizes.points, cache->npoints);
+	ctx->frameSizes.paths = nvg__maxi(ctx->frameSizes.paths, cache->npaths);
 }
 
 static int nvg__curveDivs(float r, float arc, float tol)
@@ -1536,7 +2195,7 @@ static NVGvertex* nvg__roundCapEnd(NVGvertex* dst, NVGpoint* p,
 static void nvg__calculateJoins(NVGcontext* ctx, float w, int lineJoin, float miterLimit)
 {
 	NVGpathCache* cache = ctx->cache;
-	int i, j;
+	int i;
 	float iw = 0.0f;
 
 	if (w > 0.0f) iw = 1.0f / w;
@@ -1545,58 +2204,9 @@ static void nvg__calculateJoins(NVGcontext* ctx, float w, int lineJoin, float mi
 	for (i = 0; i < cache->npaths; i++) {
 		NVGpath* path = &cache->paths[i];
 		NVGpoint* pts = &cache->points[path->first];
-		NVGpoint* p0 = &pts[path->count-1];
-		NVGpoint* p1 = &pts[0];
 		int nleft = 0;
 
-		path->nbevel = 0;
-
-		for (j = 0; j < path->count; j++) {
-			float dlx0, dly0, dlx1, dly1, dmr2, cross, limit;
-			dlx0 = p0->dy;
-			dly0 = -p0->dx;
-			dlx1 = p1->dy;
-			dly1 = -p1->dx;
-			// Calculate extrusions
-			p1->dmx = (dlx0 + dlx1) * 0.5f;
-			p1->dmy = (dly0 + dly1) * 0.5f;
-			dmr2 = p1->dmx*p1->dmx + p1->dmy*p1->dmy;
-			if (dmr2 > 0.000001f) {
-				float scale = 1.0f / dmr2;
-				if (scale > 600.0f) {
-					scale = 600.0f;
-				}
-				p1->dmx *= scale;
-				p1->dmy *= scale;
-			}
-
-			// Clear flags, but keep the corner.
-			p1->flags = (p1->flags & NVG_PT_CORNER) ? NVG_PT_CORNER : 0;
-
-			// Keep track of left turns.
-			cross = p1->dx * p0->dy - p0->dx * p1->dy;
-			if (cross > 0.0f) {
-				nleft++;
-				p1->flags |= NVG_PT_LEFT;
-			}
-
-			// Calculate if we should use bevel or miter for inner join.
-			limit = nvg__maxf(1.01f, nvg__minf(p0->len, p1->len) * iw);
-			if ((dmr2 * limit*limit) < 1.0f)
-				p1->flags |= NVG_PR_INNERBEVEL;
-
-			// Check to see if the corner needs to be beveled.
-			if (p1->flags & NVG_PT_CORNER) {
-				if ((dmr2 * miterLimit*miterLimit) < 1.0f || lineJoin == NVG_BEVEL || lineJoin == NVG_ROUND) {
-					p1->flags |= NVG_PT_BEVEL;
-				}
-			}
-
-			if ((p1->flags & (NVG_PT_BEVEL | NVG_PR_INNERBEVEL)) != 0)
-				path->nbevel++;
-
-			p0 = p1++;
-		}
+		path->nbevel = ctx->kernels->joins(pts, path->count, iw, miterLimit, lineJoin == NVG_BEVEL || lineJoin == NVG_ROUND, &nleft);
 
 		path->convex = (nleft == path->count) ? 1 : 0;
 	}
@@ -1679,18 +2289,23 @@ static int nvg__expandStroke(NVGcontext* ctx, float w, int lineCap, int lineJoin
 				dst = nvg__roundCapStart(dst, p0, dx, dy, w, ncap, aa);
 		}
 
-		for (j = s; j < e; ++j) {
+		for (j = s; j < e; ) {
 			if ((p1->flags & (NVG_PT_BEVEL | NVG_PR_INNERBEVEL)) != 0) {
 				if (lineJoin == NVG_ROUND) {
 					dst = nvg__roundJoin(dst, p0, p1, w, w, 0, 1, ncap, aa);
 				} else {
 					dst = nvg__bevelJoin(dst, p0, p1, w, w, 0, 1, aa);
 				}
+				p0 = p1++;
+				j++;
 			} else {
-				nvg__vset(dst, p1->x + (p1->dmx * w), p1->y + (p1->dmy * w), 0,1); dst++;
-				nvg__vset(dst, p1->x - (p1->dmx * w), p1->y - (p1->dmy * w), 1,1); dst++;
+				// Extrude the run of mitered joins at once.
+				int n = nvg__countRun(p1, e - j, NVG_PT_BEVEL | NVG_PR_INNERBEVEL);
+				dst = ctx->kernels->extrude(dst, p1, n, w, w, 0, 1);
+				p1 += n;
+				p0 = p1 - 1;
+				j += n;
 			}
-			p0 = p1++;
 		}
 
 		if (loop) {
@@ -1760,7 +2375,7 @@ static int nvg__expandFill(NVGcontext* ctx, float w, int lineJoin, float miterLi
 			// Looping
 			p0 = &pts[path->count-1];
 			p1 = &pts[0];
-			for (j = 0; j < path->count; ++j) {
+			for (j = 0; j < path->count; ) {
 				if (p1->flags & NVG_PT_BEVEL) {
 					float dlx0 = p0->dy;
 					float dly0 = -p0->dx;
@@ -1778,10 +2393,15 @@ static int nvg__expandFill(NVGcontext* ctx, float w, int lineJoin, float miterLi
 						nvg__vset(dst, lx0, ly0, 0.5f,1); dst++;
 						nvg__vset(dst, lx1, ly1, 0.5f,1); dst++;
 					}
+					p0 = p1++;
+					j++;
 				} else {
-					nvg__vset(dst, p1->x + (p1->dmx * woff), p1->y + (p1->dmy * woff), 0.5f,1); dst++;
+					int n = nvg__countRun(p1, path->count - j, NVG_PT_BEVEL);
+					dst = ctx->kernels->inset(dst, p1, n, woff, 0.5f);
+					p1 += n;
+					p0 = p1 - 1;
+					j += n;
 				}
-				p0 = p1++;
 			}
 		} else {
 			for (j = 0; j < path->count; ++j) {
@@ -1813,14 +2433,18 @@ static int nvg__expandFill(NVGcontext* ctx, float w, int lineJoin, float miterLi
 			p0 = &pts[path->count-1];
 			p1 = &pts[0];
 
-			for (j = 0; j < path->count; ++j) {
+			for (j = 0; j < path->count; ) {
 				if ((p1->flags & (NVG_PT_BEVEL | NVG_PR_INNERBEVEL)) != 0) {
 					dst = nvg__bevelJoin(dst, p0, p1, lw, rw, lu, ru, ctx->fringeWidth);
+					p0 = p1++;
+					j++;
 				} else {
-					nvg__vset(dst, p1->x + (p1->dmx * lw), p1->y + (p1->dmy * lw), lu,1); dst++;
-					nvg__vset(dst, p1->x - (p1->dmx * rw), p1->y - (p1->dmy * rw), ru,1); dst++;
+					int n = nvg__countRun(p1, path->count - j, NVG_PT_BEVEL | NVG_PR_INNERBEVEL);
+					dst = ctx->kernels->extrude(dst, p1, n, lw, rw, lu, ru);
+					p1 += n;
+					p0 = p1 - 1;
+					j += n;
 				}
-				p0 = p1++;
 			}
 
 			// Loop it
@@ -1843,6 +2467,9 @@ static int nvg__expandFill(NVGcontext* ctx, float w, int lineJoin, float miterLi
 void nvgBeginPath(NVGcontext* ctx)
 {
 	ctx->ncommands = 0;
+	ctx->cachedPath = -1;
+	if (ctx->tessPool != NULL)
+		ctx->tessPool->pathCommands = -1;
 	nvg__clearPathCache(ctx);
 }
 
@@ -2084,91 +2711,1343 @@ void nvgDebugDumpPathCache(NVGcontext* ctx)
 	}
 }
 
-void nvgFill(NVGcontext* ctx)
-{
-	NVGstate* state = nvg__getState(ctx);
-	const NVGpath* path;
-	NVGpaint fillPaint = state->fill;
-	int i;
-
-	nvg__flattenPaths(ctx);
-	if (ctx->params.edgeAntiAlias)
-		nvg__expandFill(ctx, ctx->fringeWidth, NVG_MITER, 2.4f);
-	else
-		nvg__expandFill(ctx, 0.0f, NVG_MITER, 2.4f);
-
-	// Apply global alpha
-	fillPaint.innerColor.a *= state->alpha;
-	fillPaint.outerColor.a *= state->alpha;
-
-	ctx->params.renderFill(ctx->params.userPtr, &fillPaint, &state->scissor, ctx->fringeWidth,
-						   ctx->cache->bounds, ctx->cache->paths, ctx->cache->npaths);
+//
+// Frame memory
+//
 
-	// Count triangles
-	for (i = 0; i < ctx->cache->npaths; i++) {
-		path = &ctx->cache->paths[i];
-		ctx->fillTriCount += path->nfill-2;
-		ctx->fillTriCount += path->nstroke-2;
-		ctx->drawCallCount += 2;
+static int nvg__reservePathCache(NVGpathCache* c, const NVGframeSizes* sizes)
+{
+	if (sizes->points > c->cpoints) {
+		NVGpoint* points = (NVGpoint*)realloc(c->points, sizeof(NVGpoint)*sizes->points);
+		if (points == NULL) return 0;
+		c->points = points;
+		c->cpoints = sizes->points;
 	}
+	if (sizes->paths > c->cpaths) {
+		NVGpath* paths = (NVGpath*)realloc(c->paths, sizeof(NVGpath)*sizes->paths);
+		if (paths == NULL) return 0;
+		c->paths = paths;
+		c->cpaths = sizes->paths;
+	}
+	if (sizes->verts > c->cverts) {
+		NVGvertex* verts = (NVGvertex*)realloc(c->verts, sizeof(NVGvertex)*sizes->verts);
+		if (verts == NULL) return 0;
+		c->verts = verts;
+		c->cverts = sizes->verts;
+	}
+	return 1;
 }
 
-void nvgStroke(NVGcontext* ctx)
+int nvgReserveFrame(NVGcontext* ctx, const NVGframeSizes* sizes)
 {
-	NVGstate* state = nvg__getState(ctx);
-	float scale = nvg__getAverageScale(state->xform);
-	float strokeWidth = nvg__clampf(state->strokeWidth * scale, 0.0f, 200.0f);
-	NVGpaint strokePaint = state->stroke;
-	const NVGpath* path;
 	int i;
 
-	if (strokeWidth < ctx->fringeWidth) {
-		// If the stroke width is less than pixel size, use alpha to emulate coverage.
-		// Since coverage is area, scale by alpha*alpha.
-		float alpha = nvg__clampf(strokeWidth / ctx->fringeWidth, 0.0f, 1.0f);
-		strokePaint.innerColor.a *= alpha*alpha;
-		strokePaint.outerColor.a *= alpha*alpha;
-		strokeWidth = ctx->fringeWidth;
+	if (sizes->commands > ctx->ccommands) {
+		float* commands = (float*)realloc(ctx->commands, sizeof(float)*sizes->commands);
+		if (commands == NULL) return 0;
+		ctx->commands = commands;
+		ctx->ccommands = sizes->commands;
 	}
-
-	// Apply global alpha
-	strokePaint.innerColor.a *= state->alpha;
-	strokePaint.outerColor.a *= state->alpha;
-
-	nvg__flattenPaths(ctx);
-
-	if (ctx->params.edgeAntiAlias)
-		nvg__expandStroke(ctx, strokeWidth*0.5f + ctx->fringeWidth*0.5f, state->lineCap, state->lineJoin, state->miterLimit);
-	else
-		nvg__expandStroke(ctx, strokeWidth*0.5f, state->lineCap, state->lineJoin, state->miterLimit);
-
-	ctx->params.renderStroke(ctx->params.userPtr, &strokePaint, &state->scissor, ctx->fringeWidth,
-							 strokeWidth, ctx->cache->paths, ctx->cache->npaths);
-
-	// Count triangles
-	for (i = 0; i < ctx->cache->npaths; i++) {
-		path = &ctx->cache->paths[i];
-		ctx->strokeTriCount += path->nstroke-2;
-		ctx->drawCallCount++;
+	if (!nvg__reservePathCache(ctx->cache, sizes)) return 0;
+	if (ctx->tessPool != NULL) {
+		for (i = 0; i < ctx->tessPool->nworkers; i++)
+			if (!nvg__reservePathCache(ctx->tessPool->workers[i].cache, sizes)) return 0;
 	}
+	if (ctx->params.renderReserve != NULL)
+		return ctx->params.renderReserve(ctx->params.userPtr, sizes->calls, sizes->callPaths, sizes->callVerts);
+	return 1;
 }
 
-// Add fonts
-int nvgCreateFont(NVGcontext* ctx, const char* name, const char* path)
+void nvgFrameSizes(NVGcontext* ctx, NVGframeSizes* last, NVGframeSizes* peak)
 {
-	return fonsAddFont(ctx->fs, name, path);
+	if (last != NULL) *last = ctx->lastFrameSizes;
+	if (peak != NULL) *peak = ctx->peakFrameSizes;
 }
 
-int nvgCreateFontMem(NVGcontext* ctx, const char* name, unsigned char* data, int ndata, int freeData)
+static void nvg__collectCacheStats(NVGframeStats* stats, NVGpathCache* c)
 {
-	return fonsAddFontMem(ctx->fs, name, data, ndata, freeData);
+	stats->vertReallocs += c->vertReallocs;
+	stats->pathCacheGrowth += c->growth;
+	c->vertReallocs = 0;
+	c->growth = 0;
 }
 
-int nvgFindFont(NVGcontext* ctx, const char* name)
+static void nvg__collectFrameStats(NVGcontext* ctx)
 {
-	if (name == NULL) return -1;
-	return fonsGetFontByName(ctx->fs, name);
-}
+	NVGframeStats* stats = &ctx->frameStats;
+	int i;
+
+	// The tessellation workers are done, their caches can be read.
+	nvg__collectCacheStats(stats, ctx->cache);
+	if (ctx->tessPool != NULL) {
+		for (i = 0; i < ctx->tessPool->nworkers; i++)
+			nvg__collectCacheStats(stats, ctx->tessPool->workers[i].cache);
+	}
+	stats->glyphsRasterized = fonsFrameRasterized(ctx->fs);
+	if (ctx->params.renderFrameStats != NULL)
+		ctx->params.renderFrameStats(ctx->params.userPtr, stats);
+	ctx->lastFrameStats = *stats;
+}
+
+void nvgGetFrameStats(NVGcontext* ctx, NVGframeStats* stats)
+{
+	*stats = ctx->lastFrameStats;
+}
+
+//
+// Recording
+//
+
+NVGrecording* nvgCreateRecording(void)
+{
+	NVGrecording* rec = (NVGrecording*)malloc(sizeof(NVGrecording));
+	if (rec == NULL) return NULL;
+	memset(rec, 0, sizeof(NVGrecording));
+	return rec;
+}
+
+void nvgDeleteRecording(NVGrecording* rec)
+{
+	if (rec == NULL) return;
+	if (rec->calls != NULL) free(rec->calls);
+	if (rec->paths != NULL) free(rec->paths);
+	if (rec->verts != NULL) free(rec->verts);
+	free(rec);
+}
+
+static NVGrecordCall* nvg__recAllocCall(NVGrecording* rec)
+{
+	NVGrecordCall* call;
+	if (rec->ncalls+1 > rec->ccalls) {
+		NVGrecordCall* calls;
+		int ccalls = nvg__maxi(rec->ncalls+1, 16) + rec->ccalls/2; // 1.5x Overallocate
+		calls = (NVGrecordCall*)realloc(rec->calls, sizeof(NVGrecordCall)*ccalls);
+		if (calls == NULL) return NULL;
+		rec->calls = calls;
+		rec->ccalls = ccalls;
+	}
+	call = &rec->calls[rec->ncalls++];
+	memset(call, 0, sizeof(NVGrecordCall));
+	call->job = -1;
+	return call;
+}
+
+static int nvg__recAllocPaths(NVGrecording* rec, int n)
+{
+	int ret;
+	if (rec->npaths+n > rec->cpaths) {
+		NVGpath* paths;
+		int cpaths = nvg__maxi(rec->npaths+n, 16) + rec->cpaths/2; // 1.5x Overallocate
+		paths = (NVGpath*)realloc(rec->paths, sizeof(NVGpath)*cpaths);
+		if (paths == NULL) return -1;
+		rec->paths = paths;
+		rec->cpaths = cpaths;
+	}
+	ret = rec->npaths;
+	rec->npaths += n;
+	return ret;
+}
+
+static int nvg__recAllocVerts(NVGrecording* rec, int n)
+{
+	int ret;
+	if (rec->nverts+n > rec->cverts) {
+		NVGvertex* verts;
+		int cverts = nvg__maxi(rec->nverts+n, 256) + rec->cverts/2; // 1.5x Overallocate
+		verts = (NVGvertex*)realloc(rec->verts, sizeof(NVGvertex)*cverts);
+		if (verts == NULL) return -1;
+		rec->verts = verts;
+		rec->cverts = cverts;
+	}
+	ret = rec->nverts;
+	rec->nverts += n;
+	return ret;
+}
+
+// Copies the paths and their vertices into the recording. While recording, the
+// fill and stroke pointers hold vertex offsets, they are resolved in nvgEndRecording().
+static int nvg__recCopyPaths(NVGrecording* rec, NVGrecordCall* call, const NVGpath* paths, int npaths)
+{
+	int i, nverts = 0, offset;
+	for (i = 0; i < npaths; i++)
+		nverts += paths[i].nfill + paths[i].nstroke;
+	call->pathOffset = nvg__recAllocPaths(rec, npaths);
+	if (call->pathOffset == -1) return 0;
+	call->pathCount = npaths;
+	offset = nvg__recAllocVerts(rec, nverts);
+	if (offset == -1) return 0;
+	for (i = 0; i < npaths; i++) {
+		NVGpath* dst = &rec->paths[call->pathOffset + i];
+		*dst = paths[i];
+		if (paths[i].nfill > 0)
+			memcpy(&rec->verts[offset], paths[i].fill, sizeof(NVGvertex)*paths[i].nfill);
+		dst->fill = (NVGvertex*)(size_t)offset;
+		offset += paths[i].nfill;
+		if (paths[i].nstroke > 0)
+			memcpy(&rec->verts[offset], paths[i].stroke, sizeof(NVGvertex)*paths[i].nstroke);
+		dst->stroke = (NVGvertex*)(size_t)offset;
+		offset += paths[i].nstroke;
+	}
+	return 1;
+}
+
+static int nvg__recFill(NVGrecording* rec, NVGpaint* paint, NVGscissor* scissor, float fringe,
+						const float* bounds, const NVGpath* paths, int npaths)
+{
+	NVGrecordCall* call = nvg__recAllocCall(rec);
+	if (call == NULL)
+		return 0;
+	if (!nvg__recCopyPaths(rec, call, paths, npaths)) {
+		rec->ncalls--;
+		return 0;
+	}
+	call->type = NVG_RECORD_FILL;
+	call->paint = *paint;
+	call->scissor = *scissor;
+	call->fringe = fringe;
+	memcpy(call->bounds, bounds, sizeof(float)*4);
+	return 1;
+}
+
+static int nvg__recStroke(NVGrecording* rec, NVGpaint* paint, NVGscissor* scissor, float fringe,
+						  float strokeWidth, const NVGpath* paths, int npaths)
+{
+	NVGrecordCall* call = nvg__recAllocCall(rec);
+	if (call == NULL)
+		return 0;
+	if (!nvg__recCopyPaths(rec, call, paths, npaths)) {
+		rec->ncalls--;
+		return 0;
+	}
+	call->type = NVG_RECORD_STROKE;
+	call->paint = *paint;
+	call->scissor = *scissor;
+	call->fringe = fringe;
+	call->strokeWidth = strokeWidth;
+	return 1;
+}
+
+static int nvg__recTriangles(NVGrecording* rec, NVGpaint* paint, NVGscissor* scissor,
+							 const NVGvertex* verts, int nverts)
+{
+	NVGrecordCall* call = nvg__recAllocCall(rec);
+	if (call == NULL)
+		return 0;
+	call->vertOffset = nvg__recAllocVerts(rec, nverts);
+	if (call->vertOffset == -1) {
+		rec->ncalls--;
+		return 0;
+	}
+	call->type = NVG_RECORD_TRIANGLES;
+	call->paint = *paint;
+	call->scissor = *scissor;
+	call->vertCount = nverts;
+	memcpy(&rec->verts[call->vertOffset], verts, sizeof(NVGvertex)*nverts);
+	return 1;
+}
+
+// Turns the vertex offsets of the recorded paths into pointers, once the vertex buffer will not move anymore.
+static void nvg__recResolve(NVGrecording* rec)
+{
+	int i;
+	for (i = 0; i < rec->npaths; i++) {
+		NVGpath* path = &rec->paths[i];
+		path->fill = &rec->verts[(size_t)path->fill];
+		path->stroke = &rec->verts[(size_t)path->stroke];
+	}
+}
+
+static void nvg__recordFill(NVGcontext* ctx, NVGpaint* paint, NVGscissor* scissor, float fringe,
+							const float* bounds, const NVGpath* paths, int npaths)
+{
+	NVGrecording* rec;
+	for (rec = ctx->recording; rec != NULL; rec = rec->parent)
+		if (!nvg__recFill(rec, paint, scissor, fringe, bounds, paths, npaths))
+			rec->valid = 0;
+}
+
+static void nvg__recordStroke(NVGcontext* ctx, NVGpaint* paint, NVGscissor* scissor, float fringe,
+							  float strokeWidth, const NVGpath* paths, int npaths)
+{
+	NVGrecording* rec;
+	for (rec = ctx->recording; rec != NULL; rec = rec->parent)
+		if (!nvg__recStroke(rec, paint, scissor, fringe, strokeWidth, paths, npaths))
+			rec->valid = 0;
+}
+
+static void nvg__recordTriangles(NVGcontext* ctx, NVGpaint* paint, NVGscissor* scissor,
+								 const NVGvertex* verts, int nverts)
+{
+	NVGrecording* rec;
+	for (rec = ctx->recording; rec != NULL; rec = rec->parent)
+		if (!nvg__recTriangles(rec, paint, scissor, verts, nverts))
+			rec->valid = 0;
+}
+
+// The render functions below pass tessellated geometry to the back-end and to the active
+// recordings. While tessellation is deferred, the geometry is queued instead, so that it
+// is rendered in order with the deferred paths.
+
+// Counts a call passed to the back-end in the frame sizes.
+static void nvg__countCall(NVGcontext* ctx, const NVGpath* paths, int npaths, int nverts)
+{
+	int i;
+	for (i = 0; i < npaths; i++)
+		nverts += paths[i].nfill + paths[i].nstroke;
+	ctx->frameSizes.calls++;
+	ctx->frameSizes.callPaths += npaths;
+	ctx->frameSizes.callVerts += nverts;
+}
+
+static void nvg__renderFill(NVGcontext* ctx, NVGpaint* paint, NVGscissor* scissor, float fringe,
+							const float* bounds, const NVGpath* paths, int npaths)
+{
+	nvg__countCall(ctx, paths, npaths, 0);
+	if (ctx->recording != NULL)
+		nvg__recordFill(ctx, paint, scissor, fringe, bounds, paths, npaths);
+	if (ctx->tessPool != NULL)
+		nvg__recFill(&ctx->tessPool->queue, paint, scissor, fringe, bounds, paths, npaths);
+	else
+		ctx->params.renderFill(ctx->params.userPtr, paint, scissor, fringe, bounds, paths, npaths);
+}
+
+static void nvg__renderStroke(NVGcontext* ctx, NVGpaint* paint, NVGscissor* scissor, float fringe,
+							  float strokeWidth, const NVGpath* paths, int npaths)
+{
+	nvg__countCall(ctx, paths, npaths, 0);
+	if (ctx->recording != NULL)
+		nvg__recordStroke(ctx, paint, scissor, fringe, strokeWidth, paths, npaths);
+	if (ctx->tessPool != NULL)
+		nvg__recStroke(&ctx->tessPool->queue, paint, scissor, fringe, strokeWidth, paths, npaths);
+	else
+		ctx->params.renderStroke(ctx->params.userPtr, paint, scissor, fringe, strokeWidth, paths, npaths);
+}
+
+static void nvg__renderTriangles(NVGcontext* ctx, NVGpaint* paint, NVGscissor* scissor,
+								 const NVGvertex* verts, int nverts)
+{
+	nvg__countCall(ctx, NULL, 0, nverts);
+	if (ctx->recording != NULL)
+		nvg__recordTriangles(ctx, paint, scissor, verts, nverts);
+	if (ctx->tessPool != NULL)
+		nvg__recTriangles(&ctx->tessPool->queue, paint, scissor, verts, nverts);
+	else
+		ctx->params.renderTriangles(ctx->params.userPtr, paint, scissor, verts, nverts);
+}
+
+// Keeps the atlas pages of text drawn from cached quads from being evicted in this frame.
+static void nvg__touchAtlasPages(NVGcontext* ctx, unsigned int pages)
+{
+	NVGrecording* rec;
+	fonsTouchPages(ctx->fs, pages);
+	for (rec = ctx->recording; rec != NULL; rec = rec->parent)
+		rec->atlasPages |= pages;
+}
+
+void nvgBeginRecording(NVGcontext* ctx, NVGrecording* rec)
+{
+	NVGstate* state = nvg__getState(ctx);
+	rec->ncalls = 0;
+	rec->npaths = 0;
+	rec->nverts = 0;
+	memcpy(rec->xform, state->xform, sizeof(float)*6);
+	rec->scissor = state->scissor;
+	rec->alpha = state->alpha;
+	rec->devicePxRatio = ctx->devicePxRatio;
+	rec->atlasGeneration = ctx->atlasGeneration;
+	rec->atlasPages = 0;
+	rec->valid = 1;
+	rec->parent = ctx->recording;
+	ctx->recording = rec;
+}
+
+void nvgEndRecording(NVGcontext* ctx)
+{
+	NVGrecording* rec = ctx->recording;
+	if (rec == NULL) return;
+	ctx->recording = rec->parent;
+	rec->parent = NULL;
+	nvg__recResolve(rec);
+	// Text was laid out on an atlas which does not exist anymore.
+	if (rec->atlasGeneration != ctx->atlasGeneration)
+		rec->valid = 0;
+}
+
+static int nvg__recordingValid(NVGcontext* ctx, NVGrecording* rec)
+{
+	NVGstate* state = nvg__getState(ctx);
+	if (!rec->valid) return 0;
+	if (rec->atlasGeneration != ctx->atlasGeneration) return 0;
+	if (rec->devicePxRatio != ctx->devicePxRatio) return 0;
+	if (rec->alpha != state->alpha) return 0;
+	if (memcmp(rec->xform, state->xform, sizeof(float)*6) != 0) return 0;
+	if (memcmp(&rec->scissor, &state->scissor, sizeof(NVGscissor)) != 0) return 0;
+	return 1;
+}
+
+int nvgReplayRecording(NVGcontext* ctx, NVGrecording* rec)
+{
+	int i;
+	if (rec == NULL || !nvg__recordingValid(ctx, rec)) return 0;
+	nvg__touchAtlasPages(ctx, rec->atlasPages);
+
+	for (i = 0; i < rec->ncalls; i++) {
+		NVGrecordCall* call = &rec->calls[i];
+		const NVGpath* paths = &rec->paths[call->pathOffset];
+		switch (call->type) {
+		case NVG_RECORD_FILL:
+			nvg__renderFill(ctx, &call->paint, &call->scissor, call->fringe, call->bounds, paths, call->pathCount);
+			break;
+		case NVG_RECORD_STROKE:
+			nvg__renderStroke(ctx, &call->paint, &call->scissor, call->fringe, call->strokeWidth, paths, call->pathCount);
+			break;
+		case NVG_RECORD_TRIANGLES:
+			nvg__renderTriangles(ctx, &call->paint, &call->scissor, &rec->verts[call->vertOffset], call->vertCount);
+			break;
+		}
+	}
+	return 1;
+}
+
+// Cached paths
+
+static void* nvg__growBuffer(void* buf, int* cap, int n, int size)
+{
+	if (n <= *cap && buf != NULL) return buf;
+	buf = realloc(buf, (size_t)nvg__maxi(n, 1) * size);
+	if (buf != NULL) *cap = nvg__maxi(n, 1);
+	return buf;
+}
+
+static int nvg__cachedPathBytes(NVGcachedPath* e)
+{
+	return e->cpoints * (int)sizeof(NVGpoint) + e->cpaths * (int)sizeof(NVGpath) +
+		(e->fill.cpaths + e->stroke.cpaths) * (int)sizeof(NVGpath) +
+		(e->fill.cverts + e->stroke.cverts) * (int)sizeof(NVGvertex);
+}
+
+static void nvg__updateCachedPathBytes(NVGcachedPaths* pc, NVGcachedPath* e)
+{
+	pc->bytes -= e->bytes;
+	e->bytes = nvg__cachedPathBytes(e);
+	pc->bytes += e->bytes;
+}
+
+static void nvg__freeCachedShape(NVGcachedShape* s)
+{
+	free(s->paths);
+	free(s->verts);
+	memset(s, 0, sizeof(*s));
+}
+
+static unsigned int nvg__cachedPathBucket(unsigned int key)
+{
+	return (key ^ (key >> 16)) & (NVG_PATH_CACHE_BUCKETS-1);
+}
+
+static void nvg__cachedPathUnlink(NVGcachedPaths* pc, int i)
+{
+	NVGcachedPath* e = &pc->entries[i];
+	if (e->lruPrev != -1) pc->entries[e->lruPrev].lruNext = e->lruNext;
+	else pc->lruHead = e->lruNext;
+	if (e->lruNext != -1) pc->entries[e->lruNext].lruPrev = e->lruPrev;
+	else pc->lruTail = e->lruPrev;
+}
+
+static void nvg__cachedPathPushFront(NVGcachedPaths* pc, int i)
+{
+	NVGcachedPath* e = &pc->entries[i];
+	e->lruPrev = -1;
+	e->lruNext = pc->lruHead;
+	if (pc->lruHead != -1) pc->entries[pc->lruHead].lruPrev = i;
+	else pc->lruTail = i;
+	pc->lruHead = i;
+}
+
+static void nvg__evictCachedPath(NVGcontext* ctx, int i)
+{
+	NVGcachedPaths* pc = ctx->cachedPaths;
+	NVGcachedPath* e = &pc->entries[i];
+	int* link = &pc->buckets[nvg__cachedPathBucket(e->key)];
+
+	nvg__cachedPathUnlink(pc, i);
+	while (*link != i)
+		link = &pc->entries[*link].next;
+	*link = e->next;
+
+	free(e->points);
+	free(e->paths);
+	nvg__freeCachedShape(&e->fill);
+	nvg__freeCachedShape(&e->stroke);
+	pc->bytes -= e->bytes;
+	memset(e, 0, sizeof(*e));
+
+	e->next = pc->freeList;
+	pc->freeList = i;
+	pc->count--;
+	pc->evictions++;
+	if (ctx->cachedPath == i)
+		ctx->cachedPath = -1;
+}
+
+// Evicts least recently used paths until the cache is within its limits.
+// The path being drawn is kept even if it alone exceeds the memory limit.
+static void nvg__trimCachedPaths(NVGcontext* ctx)
+{
+	NVGcachedPaths* pc = ctx->cachedPaths;
+	int i = pc->lruTail;
+	while (i != -1 && (pc->count > pc->maxPaths || pc->bytes > pc->maxBytes)) {
+		int prev = pc->entries[i].lruPrev;
+		if (i != ctx->cachedPath)
+			nvg__evictCachedPath(ctx, i);
+		i = prev;
+	}
+}
+
+static unsigned int nvg__hashPathKey(unsigned int shape, const float* vals, int nvals)
+{
+	const unsigned char* p = (const unsigned char*)vals;
+	unsigned int h = (2166136261u ^ shape) * 16777619u;
+	int i;
+	for (i = 0; i < nvals*(int)sizeof(float); i++)
+		h = (h ^ p[i]) * 16777619u;
+	return h;
+}
+
+// Paths are matched on their values, not just on the hash, so a collision never replays another path.
+static int nvg__findCachedPath(NVGcachedPaths* pc, unsigned int key, unsigned int shape, const float* vals, int nvals)
+{
+	int i = pc->buckets[nvg__cachedPathBucket(key)];
+	while (i != -1) {
+		const NVGcachedPath* e = &pc->entries[i];
+		if (e->key == key && e->shape == shape && e->nvals == nvals &&
+			memcmp(e->vals, vals, sizeof(float)*nvals) == 0)
+			break;
+		i = e->next;
+	}
+	return i;
+}
+
+static int nvg__addCachedPath(NVGcontext* ctx, unsigned int key, unsigned int shape, const float* vals, int nvals)
+{
+	NVGcachedPaths* pc = ctx->cachedPaths;
+	NVGcachedPath* e;
+	unsigned int bucket = nvg__cachedPathBucket(key);
+	int i;
+
+	if (pc->maxPaths <= 0) return -1;
+
+	ctx->cachedPath = -1;
+	while (pc->count >= pc->maxPaths)
+		nvg__evictCachedPath(ctx, pc->lruTail);
+
+	if (pc->freeList != -1) {
+		i = pc->freeList;
+		pc->freeList = pc->entries[i].next;
+	} else {
+		i = pc->nentries++;
+	}
+	e = &pc->entries[i];
+	e->key = key;
+	e->shape = shape;
+	memcpy(e->vals, vals, sizeof(float)*nvals);
+	e->nvals = nvals;
+	e->next = pc->buckets[bucket];
+	pc->buckets[bucket] = i;
+	nvg__cachedPathPushFront(pc, i);
+	pc->count++;
+	return i;
+}
+
+// Stores the flattened current path, before it is expanded.
+static void nvg__storeCachedPoints(NVGcontext* ctx, NVGcachedPath* e)
+{
+	NVGpathCache* cache = ctx->cache;
+	void* buf;
+
+	buf = nvg__growBuffer(e->points, &e->cpoints, cache->npoints, sizeof(NVGpoint));
+	if (buf == NULL) return;
+	e->points = (NVGpoint*)buf;
+	buf = nvg__growBuffer(e->paths, &e->cpaths, cache->npaths, sizeof(NVGpath));
+	if (buf == NULL) return;
+	e->paths = (NVGpath*)buf;
+
+	memcpy(e->points, cache->points, sizeof(NVGpoint)*cache->npoints);
+	memcpy(e->paths, cache->paths, sizeof(NVGpath)*cache->npaths);
+	memcpy(e->bounds, cache->bounds, sizeof(float)*4);
+	e->npoints = cache->npoints;
+	e->npaths = cache->npaths;
+	e->valid = 1;
+	nvg__updateCachedPathBytes(ctx->cachedPaths, e);
+}
+
+// Makes the cached path the current path, translated by ox,oy.
+static int nvg__restoreCachedPoints(NVGcontext* ctx, NVGcachedPath* e, float ox, float oy)
+{
+	NVGpathCache* cache = ctx->cache;
+	void* buf;
+	int i;
+
+	buf = nvg__growBuffer(cache->points, &cache->cpoints, e->npoints, sizeof(NVGpoint));
+	if (buf == NULL) return 0;
+	cache->points = (NVGpoint*)buf;
+	buf = nvg__growBuffer(cache->paths, &cache->cpaths, e->npaths, sizeof(NVGpath));
+	if (buf == NULL) return 0;
+	cache->paths = (NVGpath*)buf;
+
+	for (i = 0; i < e->npoints; i++) {
+		cache->points[i] = e->points[i];
+		cache->points[i].x += ox;
+		cache->points[i].y += oy;
+	}
+	memcpy(cache->paths, e->paths, sizeof(NVGpath)*e->npaths);
+	cache->bounds[0] = e->bounds[0] + ox;
+	cache->bounds[1] = e->bounds[1] + oy;
+	cache->bounds[2] = e->bounds[2] + ox;
+	cache->bounds[3] = e->bounds[3] + oy;
+	cache->npoints = e->npoints;
+	cache->npaths = e->npaths;
+	ctx->ncommands = 0;
+	return 1;
+}
+
+static NVGvertex* nvg__copyVerts(NVGvertex* dst, const NVGvertex* src, int nverts, float ox, float oy)
+{
+	int i;
+	for (i = 0; i < nverts; i++) {
+		nvg__vset(dst, src[i].x + ox, src[i].y + oy, src[i].u, src[i].v);
+		dst++;
+	}
+	return dst;
+}
+
+// Stores the vertices of the expanded current path, moved back by the path offset.
+static void nvg__storeCachedShape(NVGcontext* ctx, NVGcachedShape* s, float ox, float oy)
+{
+	NVGpathCache* cache = ctx->cache;
+	NVGvertex* dst;
+	void* buf;
+	int i, nverts = 0;
+
+	s->valid = 0;
+	for (i = 0; i < cache->npaths; i++)
+		nverts += cache->paths[i].nfill + cache->paths[i].nstroke;
+
+	buf = nvg__growBuffer(s->paths, &s->cpaths, cache->npaths, sizeof(NVGpath));
+	if (buf == NULL) return;
+	s->paths = (NVGpath*)buf;
+	buf = nvg__growBuffer(s->verts, &s->cverts, nverts, sizeof(NVGvertex));
+	if (buf == NULL) return;
+	s->verts = (NVGvertex*)buf;
+
+	dst = s->verts;
+	for (i = 0; i < cache->npaths; i++) {
+		const NVGpath* src = &cache->paths[i];
+		s->paths[i] = *src;
+		s->paths[i].fill = (NVGvertex*)(size_t)(dst - s->verts);
+		dst = nvg__copyVerts(dst, src->fill, src->nfill, -ox, -oy);
+		s->paths[i].stroke = (NVGvertex*)(size_t)(dst - s->verts);
+		dst = nvg__copyVerts(dst, src->stroke, src->nstroke, -ox, -oy);
+	}
+	s->nverts = nverts;
+	s->valid = 1;
+}
+
+// Sets up the current path with the cached vertices instead of expanding it.
+static int nvg__restoreCachedShape(NVGcontext* ctx, NVGcachedShape* s, float ox, float oy)
+{
+	NVGpathCache* cache = ctx->cache;
+	NVGvertex* verts = nvg__allocTempVerts(ctx, s->nverts);
+	int i;
+
+	if (verts == NULL) return 0;
+	nvg__copyVerts(verts, s->verts, s->nverts, ox, oy);
+
+	for (i = 0; i < cache->npaths; i++) {
+		const NVGpath* src = &s->paths[i];
+		NVGpath* dst = &cache->paths[i];
+		dst->fill = src->nfill > 0 ? &verts[(size_t)src->fill] : NULL;
+		dst->nfill = src->nfill;
+		dst->stroke = src->nstroke > 0 ? &verts[(size_t)src->stroke] : NULL;
+		dst->nstroke = src->nstroke;
+		dst->nbevel = src->nbevel;
+		dst->convex = src->convex;
+	}
+	return 1;
+}
+
+// Expands the flattened current path for fill or stroke, using the cached vertices
+// when the path comes from nvgCachedPath() and was expanded with the same parameters before.
+static void nvg__expandPath(NVGcontext* ctx, int stroke, float w, int lineCap, int lineJoin, float miterLimit)
+{
+	NVGcachedPath* e = NULL;
+	NVGcachedShape* s = NULL;
+	float ox = ctx->cachedOffset[0], oy = ctx->cachedOffset[1];
+
+	if (ctx->cachedPath != -1) {
+		e = &ctx->cachedPaths->entries[ctx->cachedPath];
+		if (!e->valid)
+			nvg__storeCachedPoints(ctx, e);
+		s = stroke ? &e->stroke : &e->fill;
+		if (s->valid && s->width == w && s->lineCap == lineCap &&
+			s->lineJoin == lineJoin && s->miterLimit == miterLimit &&
+			nvg__restoreCachedShape(ctx, s, ox, oy))
+			return;
+	}
+
+	if (stroke)
+		nvg__expandStroke(ctx, w, lineCap, lineJoin, miterLimit);
+	else
+		nvg__expandFill(ctx, w, lineJoin, miterLimit);
+
+	if (e != NULL && e->valid) {
+		nvg__storeCachedShape(ctx, s, ox, oy);
+		s->width = w;
+		s->lineCap = lineCap;
+		s->lineJoin = lineJoin;
+		s->miterLimit = miterLimit;
+		nvg__updateCachedPathBytes(ctx->cachedPaths, e);
+		nvg__trimCachedPaths(ctx);
+	}
+}
+
+int nvgCachedPath(NVGcontext* ctx, unsigned int shape, const float* vals, int nvals)
+{
+	NVGstate* state = nvg__getState(ctx);
+	NVGcachedPaths* pc = ctx->cachedPaths;
+	NVGcachedPath* e;
+	unsigned int key;
+	int i;
+
+	ctx->cachedOffset[0] = ctx->cachedOffset[1] = 0.0f;
+	ctx->cachedPath = -1;
+	if (nvals < 0 || nvals > NVG_PATH_CACHE_MAX_VALS) return 0;
+
+	key = nvg__hashPathKey(shape, vals, nvals);
+	i = nvg__findCachedPath(pc, key, shape, vals, nvals);
+
+	if (i != -1) {
+		e = &pc->entries[i];
+		nvg__cachedPathUnlink(pc, i);
+		nvg__cachedPathPushFront(pc, i);
+		// Points are flattened in view space, only a change of the translation can be applied to them.
+		if (e->valid && e->devicePxRatio == ctx->devicePxRatio &&
+			memcmp(e->xform, state->xform, sizeof(float)*4) == 0) {
+			float ox = state->xform[4] - e->xform[4];
+			float oy = state->xform[5] - e->xform[5];
+			if (nvg__restoreCachedPoints(ctx, e, ox, oy)) {
+				ctx->cachedPath = i;
+				ctx->cachedOffset[0] = ox;
+				ctx->cachedOffset[1] = oy;
+				pc->hits++;
+				return 1;
+			}
+		}
+		e->valid = 0;
+		e->fill.valid = 0;
+		e->stroke.valid = 0;
+	} else {
+		i = nvg__addCachedPath(ctx, key, shape, vals, nvals);
+	}
+
+	pc->misses++;
+	ctx->cachedPath = i;
+	if (i != -1) {
+		e = &pc->entries[i];
+		memcpy(e->xform, state->xform, sizeof(float)*6);
+		e->devicePxRatio = ctx->devicePxRatio;
+	}
+	return 0;
+}
+
+void nvgCachedPathLimits(NVGcontext* ctx, int maxPaths, int maxBytes)
+{
+	ctx->cachedPaths->maxPaths = nvg__clampi(maxPaths, 0, NVG_PATH_CACHE_SIZE);
+	ctx->cachedPaths->maxBytes = nvg__maxi(maxBytes, 0);
+	ctx->cachedPath = -1;
+	nvg__trimCachedPaths(ctx);
+}
+
+void nvgCachedPathStats(NVGcontext* ctx, int* hits, int* misses, int* evictions, int* bytes)
+{
+	if (hits != NULL) *hits = ctx->cachedPaths->hits;
+	if (misses != NULL) *misses = ctx->cachedPaths->misses;
+	if (evictions != NULL) *evictions = ctx->cachedPaths->evictions;
+	if (bytes != NULL) *bytes = ctx->cachedPaths->bytes;
+}
+
+void nvgClearCachedPaths(NVGcontext* ctx)
+{
+	NVGcachedPaths* pc = ctx->cachedPaths;
+	int i;
+	for (i = 0; i < pc->nentries; i++) {
+		free(pc->entries[i].points);
+		free(pc->entries[i].paths);
+		nvg__freeCachedShape(&pc->entries[i].fill);
+		nvg__freeCachedShape(&pc->entries[i].stroke);
+	}
+	memset(pc->entries, 0, sizeof(pc->entries));
+	for (i = 0; i < NVG_PATH_CACHE_BUCKETS; i++)
+		pc->buckets[i] = -1;
+	pc->nentries = 0;
+	pc->count = 0;
+	pc->freeList = -1;
+	pc->lruHead = pc->lruTail = -1;
+	pc->bytes = 0;
+	pc->hits = pc->misses = pc->evictions = 0;
+	ctx->cachedPath = -1;
+}
+
+//
+// Deferred tessellation
+
+#ifndef NVG_NO_THREADS
+#ifdef _WIN32
+static void nvg__mutexInit(NVGmutex* m) { InitializeCriticalSection(m); }
+static void nvg__mutexDelete(NVGmutex* m) { DeleteCriticalSection(m); }
+static void nvg__mutexLock(NVGmutex* m) { EnterCriticalSection(m); }
+static void nvg__mutexUnlock(NVGmutex* m) { LeaveCriticalSection(m); }
+static void nvg__condInit(NVGcond* c) { InitializeConditionVariable(c); }
+static void nvg__condDelete(NVGcond* c) { NVG_NOTUSED(c); }
+static void nvg__condWait(NVGcond* c, NVGmutex* m) { SleepConditionVariableCS(c, m, INFINITE); }
+static void nvg__condSignal(NVGcond* c) { WakeConditionVariable(c); }
+static void nvg__condBroadcast(NVGcond* c) { WakeAllConditionVariable(c); }
+#else
+static void nvg__mutexInit(NVGmutex* m) { pthread_mutex_init(m, NULL); }
+static void nvg__mutexDelete(NVGmutex* m) { pthread_mutex_destroy(m); }
+static void nvg__mutexLock(NVGmutex* m) { pthread_mutex_lock(m); }
+static void nvg__mutexUnlock(NVGmutex* m) { pthread_mutex_unlock(m); }
+static void nvg__condInit(NVGcond* c) { pthread_cond_init(c, NULL); }
+static void nvg__condDelete(NVGcond* c) { pthread_cond_destroy(c); }
+static void nvg__condWait(NVGcond* c, NVGmutex* m) { pthread_cond_wait(c, m); }
+static void nvg__condSignal(NVGcond* c) { pthread_cond_signal(c); }
+static void nvg__condBroadcast(NVGcond* c) { pthread_cond_broadcast(c); }
+#endif
+#endif
+
+// Flattens and expands one deferred path into the output of the worker.
+static void nvg__tessellateJob(NVGworker* w, NVGtessJob* job)
+{
+	NVGcontext* tess = &w->tess;
+	NVGrecordCall call;
+	int ok;
+
+	tess->commands = &w->pool->commands[job->commandOffset];
+	tess->ncommands = job->commandCount;
+	nvg__clearPathCache(tess);
+	nvg__flattenPaths(tess);
+	if (job->stroke)
+		ok = nvg__expandStroke(tess, job->w, job->lineCap, job->lineJoin, job->miterLimit);
+	else
+		ok = nvg__expandFill(tess, job->w, job->lineJoin, job->miterLimit);
+
+	job->worker = w->index;
+	job->pathCount = -1;
+	if (ok && nvg__recCopyPaths(&w->out, &call, tess->cache->paths, tess->cache->npaths)) {
+		job->pathOffset = call.pathOffset;
+		job->pathCount = call.pathCount;
+	}
+	memcpy(job->bounds, tess->cache->bounds, sizeof(float)*4);
+}
+
+// Claims batches of jobs until none are left. Threads which finish early take
+// over the remaining jobs, so expensive paths do not hold up the others.
+static void nvg__runJobs(NVGworker* w)
+{
+	NVGtessPool* pool = w->pool;
+	int i, first, last;
+	for (;;) {
+#ifndef NVG_NO_THREADS
+		nvg__mutexLock(&pool->mutex);
+#endif
+		first = pool->nextJob;
+		pool->nextJob += NVG_TESS_JOB_BATCH;
+#ifndef NVG_NO_THREADS
+		nvg__mutexUnlock(&pool->mutex);
+#endif
+		if (first >= pool->njobs) break;
+		last = nvg__mini(first + NVG_TESS_JOB_BATCH, pool->njobs);
+		for (i = first; i < last; i++)
+			nvg__tessellateJob(w, &pool->jobs[i]);
+	}
+}
+
+#ifndef NVG_NO_THREADS
+static void nvg__workerLoop(NVGworker* w)
+{
+	NVGtessPool* pool = w->pool;
+	nvg__mutexLock(&pool->mutex);
+	for (;;) {
+		while (!pool->quit && w->generation == pool->generation)
+			nvg__condWait(&pool->wake, &pool->mutex);
+		if (pool->quit) break;
+		w->generation = pool->generation;
+		nvg__mutexUnlock(&pool->mutex);
+
+		nvg__runJobs(w);
+
+		nvg__mutexLock(&pool->mutex);
+		if (--pool->pending == 0)
+			nvg__condSignal(&pool->done);
+	}
+	nvg__mutexUnlock(&pool->mutex);
+}
+
+#ifdef _WIN32
+static DWORD WINAPI nvg__workerMain(LPVOID arg)
+{
+	nvg__workerLoop((NVGworker*)arg);
+	return 0;
+}
+#else
+static void* nvg__workerMain(void* arg)
+{
+	nvg__workerLoop((NVGworker*)arg);
+	return NULL;
+}
+#endif
+#endif
+
+static void nvg__resetDeferred(NVGcontext* ctx)
+{
+	NVGtessPool* pool = ctx->tessPool;
+	if (pool == NULL) return;
+	pool->queue.ncalls = 0;
+	pool->queue.npaths = 0;
+	pool->queue.nverts = 0;
+	pool->njobs = 0;
+	pool->ncommands = 0;
+	pool->pathCommands = -1;
+}
+
+// Tessellates the deferred paths of the frame in parallel, then passes all
+// queued render calls to the back-end in the order they were made.
+static void nvg__runDeferred(NVGcontext* ctx)
+{
+	NVGtessPool* pool = ctx->tessPool;
+	int i;
+
+	if (pool == NULL) return;
+
+	if (pool->njobs > 0) {
+		for (i = 0; i < pool->nworkers; i++) {
+			NVGworker* w = &pool->workers[i];
+			w->tess = *ctx;
+			w->tess.cache = w->cache;
+			w->tess.tessPool = NULL;
+			w->out.ncalls = 0;
+			w->out.npaths = 0;
+			w->out.nverts = 0;
+		}
+		pool->nextJob = 0;
+#ifndef NVG_NO_THREADS
+		if (pool->nworkers > 1 && pool->njobs >= NVG_TESS_MIN_PARALLEL) {
+			nvg__mutexLock(&pool->mutex);
+			pool->generation++;
+			pool->pending = pool->nworkers-1;
+			nvg__condBroadcast(&pool->wake);
+			nvg__mutexUnlock(&pool->mutex);
+
+			nvg__runJobs(&pool->workers[0]);
+
+			nvg__mutexLock(&pool->mutex);
+			while (pool->pending > 0)
+				nvg__condWait(&pool->done, &pool->mutex);
+			nvg__mutexUnlock(&pool->mutex);
+		} else
+#endif
+		{
+			nvg__runJobs(&pool->workers[0]);
+		}
+		for (i = 0; i < pool->nworkers; i++) {
+			nvg__recResolve(&pool->workers[i].out);
+			nvg__maxSizes(&ctx->frameSizes, &pool->workers[i].tess.frameSizes);
+		}
+	}
+	nvg__recResolve(&pool->queue);
+
+	for (i = 0; i < pool->queue.ncalls; i++) {
+		NVGrecordCall* call = &pool->queue.calls[i];
+		const NVGpath* paths = &pool->queue.paths[call->pathOffset];
+		const float* bounds = call->bounds;
+		int npaths = call->pathCount;
+
+		if (call->job != -1) {
+			NVGtessJob* job = &pool->jobs[call->job];
+			if (job->pathCount == -1) continue;
+			paths = &pool->workers[job->worker].out.paths[job->pathOffset];
+			npaths = job->pathCount;
+			bounds = job->bounds;
+			nvg__countCall(ctx, paths, npaths, 0);
+		}
+
+		switch (call->type) {
+		case NVG_RECORD_FILL:
+			ctx->params.renderFill(ctx->params.userPtr, &call->paint, &call->scissor, call->fringe,
+								   bounds, paths, npaths);
+			break;
+		case NVG_RECORD_STROKE:
+			ctx->params.renderStroke(ctx->params.userPtr, &call->paint, &call->scissor, call->fringe,
+									 call->strokeWidth, paths, npaths);
+			break;
+		case NVG_RECORD_TRIANGLES:
+			ctx->params.renderTriangles(ctx->params.userPtr, &call->paint, &call->scissor,
+										&pool->queue.verts[call->vertOffset], call->vertCount);
+			break;
+		}
+	}
+
+	nvg__resetDeferred(ctx);
+}
+
+// Queues the current path to be tessellated at the end of the frame. Returns 0 if the path
+// has to be tessellated now: when tessellation is not deferred, when the path is recorded
+// or cached (both need the geometry right away), or when it was already flattened.
+static int nvg__deferPath(NVGcontext* ctx, int stroke, NVGpaint* paint, float strokeWidth,
+						  float w, int lineCap, int lineJoin, float miterLimit)
+{
+	NVGtessPool* pool = ctx->tessPool;
+	NVGstate* state = nvg__getState(ctx);
+	NVGrecordCall* call;
+	NVGtessJob* job;
+
+	if (pool == NULL || ctx->recording != NULL || ctx->cachedPath != -1 || ctx->cache->npaths > 0)
+		return 0;
+
+	// Fill and stroke of the same path share the commands.
+	if (pool->pathCommands == -1) {
+		if (pool->ncommands+ctx->ncommands > pool->ccommands) {
+			float* commands;
+			int ccommands = nvg__maxi(pool->ncommands+ctx->ncommands, 256) + pool->ccommands/2; // 1.5x Overallocate
+			commands = (float*)realloc(pool->commands, sizeof(float)*ccommands);
+			if (commands == NULL) return 0;
+			pool->commands = commands;
+			pool->ccommands = ccommands;
+		}
+		memcpy(&pool->commands[pool->ncommands], ctx->commands, sizeof(float)*ctx->ncommands);
+		pool->pathCommands = pool->ncommands;
+		pool->ncommands += ctx->ncommands;
+	}
+
+	if (pool->njobs+1 > pool->cjobs) {
+		NVGtessJob* jobs;
+		int cjobs = nvg__maxi(pool->njobs+1, 64) + pool->cjobs/2; // 1.5x Overallocate
+		jobs = (NVGtessJob*)realloc(pool->jobs, sizeof(NVGtessJob)*cjobs);
+		if (jobs == NULL) return 0;
+		pool->jobs = jobs;
+		pool->cjobs = cjobs;
+	}
+
+	call = nvg__recAllocCall(&pool->queue);
+	if (call == NULL) return 0;
+	call->type = stroke ? NVG_RECORD_STROKE : NVG_RECORD_FILL;
+	call->paint = *paint;
+	call->scissor = state->scissor;
+	call->fringe = ctx->fringeWidth;
+	call->strokeWidth = strokeWidth;
+	call->job = pool->njobs;
+
+	job = &pool->jobs[pool->njobs++];
+	memset(job, 0, sizeof(*job));
+	job->stroke = stroke;
+	job->commandOffset = pool->pathCommands;
+	job->commandCount = ctx->ncommands;
+	job->w = w;
+	job->lineCap = lineCap;
+	job->lineJoin = lineJoin;
+	job->miterLimit = miterLimit;
+	return 1;
+}
+
+static void nvg__deleteTessPool(NVGtessPool* pool)
+{
+	int i;
+#ifndef NVG_NO_THREADS
+	nvg__mutexLock(&pool->mutex);
+	pool->quit = 1;
+	nvg__condBroadcast(&pool->wake);
+	nvg__mutexUnlock(&pool->mutex);
+	for (i = 1; i < pool->nworkers; i++) {
+#ifdef _WIN32
+		WaitForSingleObject(pool->workers[i].thread, INFINITE);
+		CloseHandle(pool->workers[i].thread);
+#else
+		pthread_join(pool->workers[i].thread, NULL);
+#endif
+	}
+	nvg__condDelete(&pool->done);
+	nvg__condDelete(&pool->wake);
+	nvg__mutexDelete(&pool->mutex);
+#endif
+	for (i = 0; i < NVG_MAX_THREADS; i++) {
+		NVGworker* w = &pool->workers[i];
+		nvg__deletePathCache(w->cache);
+		free(w->out.calls);
+		free(w->out.paths);
+		free(w->out.verts);
+	}
+	free(pool->queue.calls);
+	free(pool->queue.paths);
+	free(pool->queue.verts);
+	free(pool->jobs);
+	free(pool->commands);
+	free(pool);
+}
+
+int nvgDeferTessellation(NVGcontext* ctx, int nthreads)
+{
+	NVGtessPool* pool;
+	int i;
+
+	if (ctx->tessPool != NULL) {
+		nvg__deleteTessPool(ctx->tessPool);
+		ctx->tessPool = NULL;
+	}
+	if (nthreads <= 0) return 0;
+
+	pool = (NVGtessPool*)malloc(sizeof(NVGtessPool));
+	if (pool == NULL) return 0;
+	memset(pool, 0, sizeof(NVGtessPool));
+	pool->pathCommands = -1;
+
+#ifdef NVG_NO_THREADS
+	nthreads = 1;
+#else
+	nthreads = nvg__mini(nthreads, NVG_MAX_THREADS);
+	nvg__mutexInit(&pool->mutex);
+	nvg__condInit(&pool->wake);
+	nvg__condInit(&pool->done);
+#endif
+
+	for (i = 0; i < nthreads; i++) {
+		NVGworker* w = &pool->workers[i];
+		w->pool = pool;
+		w->index = i;
+		w->cache = nvg__allocPathCache();
+		if (w->cache == NULL) break;
+#ifndef NVG_NO_THREADS
+		if (i > 0) {
+#ifdef _WIN32
+			w->thread = CreateThread(NULL, 0, nvg__workerMain, w, 0, NULL);
+			if (w->thread == NULL) break;
+#else
+			if (pthread_create(&w->thread, NULL, nvg__workerMain, w) != 0) break;
+#endif
+		}
+#endif
+		pool->nworkers++;
+	}
+
+	if (pool->nworkers == 0) {
+		nvg__deleteTessPool(pool);
+		return 0;
+	}
+	ctx->tessPool = pool;
+	return pool->nworkers;
+}
+
+void nvgFill(NVGcontext* ctx)
+{
+	NVGstate* state = nvg__getState(ctx);
+	NVGpaint fillPaint = state->fill;
+	float w = ctx->params.edgeAntiAlias ? ctx->fringeWidth : 0.0f;
+
+	// Apply global alpha
+	fillPaint.innerColor.a *= state->alpha;
+	fillPaint.outerColor.a *= state->alpha;
+
+	if (nvg__deferPath(ctx, 0, &fillPaint, 0.0f, w, NVG_BUTT, NVG_MITER, 2.4f))
+		return;
+
+	nvg__flattenPaths(ctx);
+	nvg__expandPath(ctx, 0, w, NVG_BUTT, NVG_MITER, 2.4f);
+
+	nvg__renderFill(ctx, &fillPaint, &state->scissor, ctx->fringeWidth,
+					ctx->cache->bounds, ctx->cache->paths, ctx->cache->npaths);
+}
+
+void nvgStroke(NVGcontext* ctx)
+{
+	NVGstate* state = nvg__getState(ctx);
+	float scale = nvg__getAverageScale(state->xform);
+	float strokeWidth = nvg__clampf(state->strokeWidth * scale, 0.0f, 200.0f);
+	NVGpaint strokePaint = state->stroke;
+	float w;
+
+	if (strokeWidth < ctx->fringeWidth) {
+		// If the stroke width is less than pixel size, use alpha to emulate coverage.
+		// Since coverage is area, scale by alpha*alpha.
+		float alpha = nvg__clampf(strokeWidth / ctx->fringeWidth, 0.0f, 1.0f);
+		strokePaint.innerColor.a *= alpha*alpha;
+		strokePaint.outerColor.a *= alpha*alpha;
+		strokeWidth = ctx->fringeWidth;
+	}
+
+	// Apply global alpha
+	strokePaint.innerColor.a *= state->alpha;
+	strokePaint.outerColor.a *= state->alpha;
+
+	w = strokeWidth*0.5f;
+	if (ctx->params.edgeAntiAlias)
+		w += ctx->fringeWidth*0.5f;
+
+	if (nvg__deferPath(ctx, 1, &strokePaint, strokeWidth, w, state->lineCap, state->lineJoin, state->miterLimit))
+		return;
+
+	nvg__flattenPaths(ctx);
+	nvg__expandPath(ctx, 1, w, state->lineCap, state->lineJoin, state->miterLimit);
+
+	nvg__renderStroke(ctx, &strokePaint, &state->scissor, ctx->fringeWidth,
+					  strokeWidth, ctx->cache->paths, ctx->cache->npaths);
+}
+
+// Fills a convex polygon given in local coordinates with the paint, skipping path
+// flattening and expansion. The polygon gets no fringe, the paint provides the edges.
+static void nvg__fillConvex(NVGcontext* ctx, NVGpaint* paint, const float* pts, int npts)
+{
+	NVGstate* state = nvg__getState(ctx);
+	NVGvertex* verts = nvg__allocTempVerts(ctx, npts);
+	NVGpath path;
+	float bounds[4], area = 0.0f;
+	int i;
+
+	if (verts == NULL) return;
+
+	bounds[0] = bounds[1] = 1e6f;
+	bounds[2] = bounds[3] = -1e6f;
+	for (i = 0; i < npts; i++) {
+		float x, y;
+		nvgTransformPoint(&x, &y, state->xform, pts[i*2], pts[i*2+1]);
+		nvg__vset(&verts[i], x, y, 0.5f, 1.0f);
+		bounds[0] = nvg__minf(bounds[0], x);
+		bounds[1] = nvg__minf(bounds[1], y);
+		bounds[2] = nvg__maxf(bounds[2], x);
+		bounds[3] = nvg__maxf(bounds[3], y);
+	}
+
+	// Enforce the same winding as solid paths, the transform may have flipped it.
+	for (i = 2; i < npts; i++)
+		area += nvg__triarea2(verts[0].x,verts[0].y, verts[i-1].x,verts[i-1].y, verts[i].x,verts[i].y);
+	if (area < 0.0f) {
+		for (i = 0; i < npts/2; i++) {
+			NVGvertex tmp = verts[i];
+			verts[i] = verts[npts-1-i];
+			verts[npts-1-i] = tmp;
+		}
+	}
+
+	memset(&path, 0, sizeof(path));
+	path.count = npts;
+	path.closed = 1;
+	path.fill = verts;
+	path.nfill = npts;
+	path.winding = NVG_CCW;
+	path.convex = 1;
+
+	nvg__renderFill(ctx, paint, &state->scissor, ctx->fringeWidth, bounds, &path, 1);
+}
+
+void nvgFillRoundedRectFast(NVGcontext* ctx, float x, float y, float w, float h, float r, NVGcolor color)
+{
+	NVGstate* state = nvg__getState(ctx);
+	float scale = nvg__getAverageScale(state->xform);
+	float f, quad[8];
+	NVGpaint paint;
+
+	if (w < 0.0f) { x += w; w = -w; }
+	if (h < 0.0f) { y += h; h = -h; }
+	r = nvg__clampf(r, 0.0f, nvg__minf(w, h) * 0.5f);
+
+	// One pixel wide edge, like the fringe of nvgFill().
+	f = ctx->params.edgeAntiAlias && scale > 0.0f ? ctx->fringeWidth / scale : 0.001f;
+
+	memset(&paint, 0, sizeof(paint));
+	nvgTransformIdentity(paint.xform);
+	paint.xform[4] = x+w*0.5f;
+	paint.xform[5] = y+h*0.5f;
+	nvgTransformMultiply(paint.xform, state->xform);
+	paint.extent[0] = w*0.5f;
+	paint.extent[1] = h*0.5f;
+	paint.radius = r;
+	paint.feather = f;
+	paint.innerColor = color;
+	paint.outerColor = color;
+	paint.innerColor.a *= state->alpha;
+	paint.outerColor.a = 0.0f;
+
+	quad[0] = x-f; quad[1] = y-f;
+	quad[2] = x-f; quad[3] = y+h+f;
+	quad[4] = x+w+f; quad[5] = y+h+f;
+	quad[6] = x+w+f; quad[7] = y-f;
+	nvg__fillConvex(ctx, &paint, quad, 4);
+}
+
+void nvgDropShadowFast(NVGcontext* ctx, float x, float y, float w, float h, float r, float spread, NVGpaint paint)
+{
+	NVGstate* state = nvg__getState(ctx);
+	float scale = nvg__getAverageScale(state->xform);
+	float x0, y0, x1, y1, pts[(16+2)*2];
+	int i, j, ndivs;
+
+	if (w < 0.0f) { x += w; w = -w; }
+	if (h < 0.0f) { y += h; h = -h; }
+	r = nvg__clampf(r, 0.0f, nvg__minf(w, h) * 0.5f);
+	x0 = x - spread;
+	y0 = y - spread;
+	x1 = x + w + spread;
+	y1 = y + h + spread;
+
+	nvgTransformMultiply(paint.xform, state->xform);
+	paint.innerColor.a *= state->alpha;
+	paint.outerColor.a *= state->alpha;
+
+	// Frame around the rectangle: top, bottom, left and right.
+	pts[0] = x0; pts[1] = y0; pts[2] = x0; pts[3] = y; pts[4] = x1; pts[5] = y; pts[6] = x1; pts[7] = y0;
+	nvg__fillConvex(ctx, &paint, pts, 4);
+	pts[0] = x0; pts[1] = y+h; pts[2] = x0; pts[3] = y1; pts[4] = x1; pts[5] = y1; pts[6] = x1; pts[7] = y+h;
+	nvg__fillConvex(ctx, &paint, pts, 4);
+	pts[0] = x0; pts[1] = y; pts[2] = x0; pts[3] = y+h; pts[4] = x; pts[5] = y+h; pts[6] = x; pts[7] = y;
+	nvg__fillConvex(ctx, &paint, pts, 4);
+	pts[0] = x+w; pts[1] = y; pts[2] = x+w; pts[3] = y+h; pts[4] = x1; pts[5] = y+h; pts[6] = x1; pts[7] = y;
+	nvg__fillConvex(ctx, &paint, pts, 4);
+
+	// The corners of the rectangle outside of the rounding, as fans around the corner point.
+	if (r * scale < 0.5f)
+		return;
+	ndivs = nvg__clampi(nvg__curveDivs(r * scale, NVG_PI*0.5f, ctx->tessTol), 1, 16);
+	for (i = 0; i < 4; i++) {
+		float cx = (i == 0 || i == 3) ? x : x+w;
+		float cy = (i < 2) ? y : y+h;
+		float ox = (i == 0 || i == 3) ? x+r : x+w-r;
+		float oy = (i < 2) ? y+r : y+h-r;
+		float a0 = NVG_PI + i * NVG_PI*0.5f;
+		pts[0] = cx;
+		pts[1] = cy;
+		for (j = 0; j <= ndivs; j++) {
+			float a = a0 + j * NVG_PI*0.5f / ndivs;
+			pts[2+j*2] = ox + nvg__cosf(a) * r;
+			pts[2+j*2+1] = oy + nvg__sinf(a) * r;
+		}
+		nvg__fillConvex(ctx, &paint, pts, ndivs + 2);
+	}
+}
+
+// Add fonts
+int nvgCreateFont(NVGcontext* ctx, const char* name, const char* path)
+{
+	return fonsAddFont(ctx->fs, name, path);
+}
+
+int nvgCreateFontMem(NVGcontext* ctx, const char* name, unsigned char* data, int ndata, int freeData)
+{
+	return fonsAddFontMem(ctx->fs, name, data, ndata, freeData);
+}
+
+int nvgFindFont(NVGcontext* ctx, const char* name)
+{
+	if (name == NULL) return -1;
+	return fonsGetFontByName(ctx->fs, name);
+}
 
 // State setting
 void nvgFontSize(NVGcontext* ctx, float size)
@@ -2238,31 +4117,328 @@ static void nvg__flushTextTexture(NVGcontext* ctx)
 			int w = dirty[2] - dirty[0];
 			int h = dirty[3] - dirty[1];
 			ctx->params.renderUpdateTexture(ctx->params.userPtr, fontImage, x,y, w,h, data);
+			ctx->frameStats.atlasUploads++;
 		}
 	}
+	nvg__dispatchGlyphs(ctx);
 }
 
-static int nvg__allocTextAtlas(NVGcontext* ctx)
+//
+// Asynchronous glyph rasterization
+
+#ifndef NVG_NO_THREADS
+static void nvg__glyphLoop(NVGglyphPool* pool)
+{
+	FONSjob* job;
+	nvg__mutexLock(&pool->mutex);
+	for (;;) {
+		// Finish the queue before quitting, nvgAsyncGlyphs(ctx, 0) commits everything.
+		while (pool->nextJob == pool->nqueue && !pool->quit)
+			nvg__condWait(&pool->wake, &pool->mutex);
+		if (pool->nextJob == pool->nqueue)
+			break;
+		job = pool->queue[pool->nextJob++];
+		nvg__mutexUnlock(&pool->mutex);
+
+		fonsRunJob(job);
+
+		nvg__mutexLock(&pool->mutex);
+		pool->done[pool->ndone++] = job;
+		pool->pending--;
+	}
+	nvg__mutexUnlock(&pool->mutex);
+}
+
+#ifdef _WIN32
+static DWORD WINAPI nvg__glyphMain(LPVOID arg)
 {
-	int iw, ih;
-	nvg__flushTextTexture(ctx);
-	if (ctx->fontImageIdx >= NVG_MAX_FONTIMAGES-1)
+	nvg__glyphLoop((NVGglyphPool*)arg);
+	return 0;
+}
+#else
+static void* nvg__glyphMain(void* arg)
+{
+	nvg__glyphLoop((NVGglyphPool*)arg);
+	return NULL;
+}
+#endif
+#endif
+
+// Hands the glyphs fontstash queued to the threads.
+static void nvg__dispatchGlyphs(NVGcontext* ctx)
+{
+#ifndef NVG_NO_THREADS
+	NVGglyphPool* pool = ctx->glyphPool;
+	FONSjob* job;
+	int n = 0;
+
+	if (pool == NULL) return;
+
+	nvg__mutexLock(&pool->mutex);
+	if (pool->nextJob == pool->nqueue)
+		pool->nextJob = pool->nqueue = 0;
+	while ((job = fonsTakeJob(ctx->fs)) != NULL) {
+		if (pool->nqueue+1 > pool->cqueue) {
+			int cqueue = nvg__maxi(pool->nqueue+1, 64) + pool->cqueue/2; // 1.5x Overallocate
+			FONSjob** queue = (FONSjob**)realloc(pool->queue, sizeof(FONSjob*)*cqueue);
+			if (queue == NULL) break;
+			pool->queue = queue;
+			pool->cqueue = cqueue;
+		}
+		// Every job ends up in done, the threads do not allocate.
+		if (pool->ndone+pool->pending+1 > pool->cdone) {
+			int cdone = nvg__maxi(pool->ndone+pool->pending+1, 64) + pool->cdone/2; // 1.5x Overallocate
+			FONSjob** done = (FONSjob**)realloc(pool->done, sizeof(FONSjob*)*cdone);
+			if (done == NULL) break;
+			pool->done = done;
+			pool->cdone = cdone;
+		}
+		pool->queue[pool->nqueue++] = job;
+		pool->pending++;
+		n++;
+	}
+	if (job != NULL) {
+		// Out of memory, rasterize it here then.
+		fonsRunJob(job);
+		fonsCommitJob(ctx->fs, job);
+	}
+	if (n > 0)
+		nvg__condBroadcast(&pool->wake);
+	nvg__mutexUnlock(&pool->mutex);
+#else
+	NVG_NOTUSED(ctx);
+#endif
+}
+
+// Copies the glyphs rasterized since the last frame into the atlas, uploading them at once.
+static void nvg__commitGlyphs(NVGcontext* ctx)
+{
+#ifndef NVG_NO_THREADS
+	NVGglyphPool* pool = ctx->glyphPool;
+	int i, ndone, committed = 0;
+
+	if (pool == NULL) return;
+
+	nvg__mutexLock(&pool->mutex);
+	ndone = pool->ndone;
+	for (i = 0; i < ndone; i++)
+		committed += fonsCommitJob(ctx->fs, pool->done[i]);
+	pool->ndone = 0;
+	nvg__mutexUnlock(&pool->mutex);
+
+	if (committed > 0) {
+		// Text runs and recordings may still use the placeholders.
+		ctx->atlasGeneration++;
+		nvg__flushTextTexture(ctx);
+	}
+#else
+	NVG_NOTUSED(ctx);
+#endif
+}
+
+static void nvg__deleteGlyphPool(NVGcontext* ctx, NVGglyphPool* pool)
+{
+#ifndef NVG_NO_THREADS
+	int i;
+	nvg__mutexLock(&pool->mutex);
+	pool->quit = 1;
+	nvg__condBroadcast(&pool->wake);
+	nvg__mutexUnlock(&pool->mutex);
+	for (i = 0; i < pool->nthreads; i++) {
+#ifdef _WIN32
+		WaitForSingleObject(pool->threads[i], INFINITE);
+		CloseHandle(pool->threads[i]);
+#else
+		pthread_join(pool->threads[i], NULL);
+#endif
+	}
+	// Jobs which never got a thread are run here.
+	for (i = pool->nextJob; i < pool->nqueue; i++) {
+		fonsRunJob(pool->queue[i]);
+		pool->done[pool->ndone++] = pool->queue[i];
+	}
+	for (i = 0; i < pool->ndone; i++)
+		fonsCommitJob(ctx->fs, pool->done[i]);
+	nvg__condDelete(&pool->wake);
+	nvg__mutexDelete(&pool->mutex);
+	free(pool->queue);
+	free(pool->done);
+#else
+	NVG_NOTUSED(ctx);
+#endif
+	free(pool);
+}
+
+int nvgAsyncGlyphs(NVGcontext* ctx, int nthreads)
+{
+	NVGglyphPool* pool;
+
+	if (ctx->fs == NULL) return 0;
+	if (ctx->glyphPool != NULL) {
+		nvg__deleteGlyphPool(ctx, ctx->glyphPool);
+		ctx->glyphPool = NULL;
+		fonsSetAsync(ctx->fs, 0);
+		// Text runs and recordings may still use the placeholders.
+		ctx->atlasGeneration++;
+	}
+#ifdef NVG_NO_THREADS
+	NVG_NOTUSED(pool);
+	return 0;
+#else
+	if (nthreads <= 0) return 0;
+
+	pool = (NVGglyphPool*)malloc(sizeof(NVGglyphPool));
+	if (pool == NULL) return 0;
+	memset(pool, 0, sizeof(NVGglyphPool));
+	nvg__mutexInit(&pool->mutex);
+	nvg__condInit(&pool->wake);
+
+	nthreads = nvg__mini(nthreads, NVG_MAX_THREADS);
+	while (pool->nthreads < nthreads) {
+#ifdef _WIN32
+		pool->threads[pool->nthreads] = CreateThread(NULL, 0, nvg__glyphMain, pool, 0, NULL);
+		if (pool->threads[pool->nthreads] == NULL) break;
+#else
+		if (pthread_create(&pool->threads[pool->nthreads], NULL, nvg__glyphMain, pool) != 0) break;
+#endif
+		pool->nthreads++;
+	}
+
+	if (pool->nthreads == 0 || !fonsSetAsync(ctx->fs, 1)) {
+		nvg__deleteGlyphPool(ctx, pool);
 		return 0;
-	// if next fontImage already have a texture
-	if (ctx->fontImages[ctx->fontImageIdx+1] != 0)
-		nvgImageSize(ctx, ctx->fontImages[ctx->fontImageIdx+1], &iw, &ih);
-	else { // calculate the new font image size and create it.
-		nvgImageSize(ctx, ctx->fontImages[ctx->fontImageIdx], &iw, &ih);
-		if (iw > ih)
-			ih *= 2;
-		else
-			iw *= 2;
-		if (iw > NVG_MAX_FONTIMAGE_SIZE || ih > NVG_MAX_FONTIMAGE_SIZE)
-			iw = ih = NVG_MAX_FONTIMAGE_SIZE;
-		ctx->fontImages[ctx->fontImageIdx+1] = ctx->params.renderCreateTexture(ctx->params.userPtr, NVG_TEXTURE_ALPHA, iw, ih, 0, NULL);
 	}
-	++ctx->fontImageIdx;
+	ctx->glyphPool = pool;
+	return pool->nthreads;
+#endif
+}
+
+int nvgPendingGlyphs(NVGcontext* ctx)
+{
+	return fonsPendingGlyphs(ctx->fs);
+}
+
+int nvgTextSDF(NVGcontext* ctx, int enabled)
+{
+	int i, iw, ih, image;
+	int flags = enabled ? NVG_IMAGE_SDF : 0;
+
+	if (ctx->fs == NULL) return 0;
+	if (ctx->fontImageFlags == flags) return 1;
+
+	// The glyphs of the two modes need different shading, start over with a new atlas.
+	nvgImageSize(ctx, ctx->fontImages[ctx->fontImageIdx], &iw, &ih);
+	image = ctx->params.renderCreateTexture(ctx->params.userPtr, NVG_TEXTURE_ALPHA, iw, ih, flags, NULL);
+	if (image == 0) return 0;
+	for (i = 0; i < NVG_MAX_FONTIMAGES; i++) {
+		if (ctx->fontImages[i] != 0)
+			nvgDeleteImage(ctx, ctx->fontImages[i]);
+		ctx->fontImages[i] = 0;
+	}
+	ctx->fontImages[0] = image;
+	ctx->fontImageIdx = 0;
+	ctx->fontImageFlags = flags;
+
+	fonsSetSDF(ctx->fs, enabled);
 	fonsResetAtlas(ctx->fs, iw, ih);
+	// Measurements differ slightly, glyph quads point to the old atlas.
+	nvgClearTextCache(ctx);
+	ctx->atlasGeneration++;
+	return 1;
+}
+
+int nvgSaveFontAtlas(NVGcontext* ctx, const char* path, float devicePixelRatio)
+{
+	if (ctx->fs == NULL) return 0;
+	return fonsSaveAtlas(ctx->fs, path, devicePixelRatio);
+}
+
+int nvgLoadFontAtlas(NVGcontext* ctx, const char* path, float devicePixelRatio)
+{
+	int i, iw, ih, w = 0, h = 0;
+	int image = ctx->fontImages[ctx->fontImageIdx];
+
+	if (ctx->fs == NULL) return 0;
+	nvgImageSize(ctx, image, &iw, &ih);
+	if (!fonsLoadAtlas(ctx->fs, path, devicePixelRatio)) {
+		// The atlas may have been emptied.
+		ctx->atlasGeneration++;
+		return 0;
+	}
+
+	fonsGetAtlasSize(ctx->fs, &w, &h);
+	if (w != iw || h != ih) {
+		image = ctx->params.renderCreateTexture(ctx->params.userPtr, NVG_TEXTURE_ALPHA, w, h, ctx->fontImageFlags, NULL);
+		if (image == 0) {
+			fonsResetAtlas(ctx->fs, iw, ih);
+			ctx->atlasGeneration++;
+			return 0;
+		}
+	}
+	for (i = 0; i < NVG_MAX_FONTIMAGES; i++) {
+		if (ctx->fontImages[i] != 0 && ctx->fontImages[i] != image)
+			nvgDeleteImage(ctx, ctx->fontImages[i]);
+		ctx->fontImages[i] = 0;
+	}
+	ctx->fontImages[0] = image;
+	ctx->fontImageIdx = 0;
+
+	// Uploads the whole atlas in one go.
+	nvg__flushTextTexture(ctx);
+	ctx->atlasGeneration++;
+	return 1;
+}
+
+static int nvg__nextFontImage(NVGcontext* ctx, int w, int h)
+{
+	int image = ctx->fontImages[ctx->fontImageIdx+1];
+	if (image != 0) {
+		int iw, ih;
+		nvgImageSize(ctx, image, &iw, &ih);
+		if (iw != w || ih != h) {
+			nvgDeleteImage(ctx, image);
+			image = 0;
+		}
+	}
+	if (image == 0)
+		image = ctx->params.renderCreateTexture(ctx->params.userPtr, NVG_TEXTURE_ALPHA, w, h, ctx->fontImageFlags, NULL);
+	ctx->fontImages[ctx->fontImageIdx+1] = image;
+	if (image == 0) return 0;
+	++ctx->fontImageIdx;
+	return 1;
+}
+
+// Called when a glyph does not fit into the atlas. Text drawn so far in the frame keeps
+// using the current font image, so the atlas grows into a new image, keeping its glyphs.
+// At full size the least recently used pages which were not drawn from in this frame are
+// evicted, and only when every page is in use the atlas starts over in a new image.
+static int nvg__allocTextAtlas(NVGcontext* ctx)
+{
+	int iw, ih, nw, nh;
+	nvg__flushTextTexture(ctx);
+	nvgImageSize(ctx, ctx->fontImages[ctx->fontImageIdx], &iw, &ih);
+	nw = iw; nh = ih;
+	if (nw > nh)
+		nh *= 2;
+	else
+		nw *= 2;
+	if (nw > NVG_MAX_FONTIMAGE_SIZE || nh > NVG_MAX_FONTIMAGE_SIZE)
+		nw = nh = NVG_MAX_FONTIMAGE_SIZE;
+	if ((nw != iw || nh != ih) && ctx->fontImageIdx < NVG_MAX_FONTIMAGES-1) {
+		if (!nvg__nextFontImage(ctx, nw, nh))
+			return 0;
+		fonsExpandAtlas(ctx->fs, nw, nh);
+	} else if (fonsEvictAtlas(ctx->fs)) {
+		// The evicted pages were not used in this frame, text drawn so far is not affected.
+	} else {
+		if (ctx->fontImageIdx >= NVG_MAX_FONTIMAGES-1)
+			return 0;
+		if (!nvg__nextFontImage(ctx, nw, nh))
+			return 0;
+		fonsResetAtlas(ctx->fs, nw, nh);
+	}
+	// Glyph quads recorded so far point to the old atlas.
+	ctx->atlasGeneration++;
 	return 1;
 }
 
@@ -2273,15 +4449,18 @@ static void nvg__renderText(NVGcontext* ctx, NVGvertex* verts, int nverts)
 
 	// Render triangles.
 	paint.image = ctx->fontImages[ctx->fontImageIdx];
+	if (ctx->fontImageFlags & NVG_IMAGE_SDF) {
+		// Half width of the edge in field units, half a pixel plus the blur.
+		float scale = nvg__getFontScale(state) * ctx->devicePxRatio;
+		float texels = FONS_SDF_SIZE / nvg__maxf(state->fontSize * scale, 1.0f);
+		paint.feather = nvg__minf((0.5f + state->fontBlur * scale) * texels / (2.0f * FONS_SDF_PAD), 0.5f);
+	}
 
 	// Apply global alpha
 	paint.innerColor.a *= state->alpha;
 	paint.outerColor.a *= state->alpha;
 
-	ctx->params.renderTriangles(ctx->params.userPtr, &paint, &state->scissor, verts, nverts);
-
-	ctx->drawCallCount++;
-	ctx->textTriCount += nverts/3;
+	nvg__renderTriangles(ctx, &paint, &state->scissor, verts, nverts);
 }
 
 float nvgText(NVGcontext* ctx, float x, float y, const char* string, const char* end)
@@ -2294,6 +4473,7 @@ float nvgText(NVGcontext* ctx, float x, float y, const char* string, const char*
 	float invscale = 1.0f / scale;
 	int cverts = 0;
 	int nverts = 0;
+	unsigned int pages = 0;
 
 	if (end == NULL)
 		end = string + strlen(string);
@@ -2315,18 +4495,21 @@ float nvgText(NVGcontext* ctx, float x, float y, const char* string, const char*
 	while (fonsTextIterNext(ctx->fs, &iter, &q)) {
 		float c[4*2];
 		if (iter.prevGlyphIndex == -1) { // can not retrieve glyph?
-			if (!nvg__allocTextAtlas(ctx))
-				break; // no memory :(
+			// Render the glyphs so far with the font image they were laid out on.
 			if (nverts != 0) {
+				nvg__flushTextTexture(ctx);
 				nvg__renderText(ctx, verts, nverts);
 				nverts = 0;
 			}
+			if (!nvg__allocTextAtlas(ctx))
+				break; // no memory :(
 			iter = prevIter;
 			fonsTextIterNext(ctx->fs, &iter, &q); // try again
 			if (iter.prevGlyphIndex == -1) // still can not find glyph?
 				break;
 		}
 		prevIter = iter;
+		pages |= 1u << (iter.page & 31);
 		// Transform corners.
 		nvgTransformPoint(&c[0],&c[1], state->xform, q.x0*invscale, q.y0*invscale);
 		nvgTransformPoint(&c[2],&c[3], state->xform, q.x1*invscale, q.y0*invscale);
@@ -2346,11 +4529,165 @@ float nvgText(NVGcontext* ctx, float x, float y, const char* string, const char*
 	// TODO: add back-end bit to do this just once per frame. 
 	nvg__flushTextTexture(ctx);
 
+	nvg__touchAtlasPages(ctx, pages);
 	nvg__renderText(ctx, verts, nverts);
 
 	return iter.x;
 }
 
+static void nvg__textKey(NVGcontext* ctx, NVGtextKey* key, int type, float x, float y, float breakRowWidth)
+{
+	NVGstate* state = nvg__getState(ctx);
+	memset(key, 0, sizeof(*key));
+	key->type = type;
+	key->fontId = state->fontId;
+	key->textAlign = state->textAlign;
+	key->fontSize = state->fontSize;
+	key->letterSpacing = state->letterSpacing;
+	key->fontBlur = state->fontBlur;
+	key->lineHeight = type == NVG_MEASURE_BOX_BOUNDS ? state->lineHeight : 0.0f;
+	key->scale = nvg__getFontScale(state) * ctx->devicePxRatio;
+	key->x = x;
+	key->y = y;
+	key->breakRowWidth = breakRowWidth;
+}
+
+NVGtextRun* nvgCreateTextRun(void)
+{
+	NVGtextRun* run = (NVGtextRun*)malloc(sizeof(NVGtextRun));
+	if (run == NULL) return NULL;
+	memset(run, 0, sizeof(NVGtextRun));
+	return run;
+}
+
+void nvgDeleteTextRun(NVGtextRun* run)
+{
+	if (run == NULL) return;
+	free(run->str);
+	free(run->quads);
+	free(run);
+}
+
+static int nvg__buildTextRun(NVGcontext* ctx, NVGtextRun* run, float x, float y, const char* string, const char* end)
+{
+	FONStextIter iter;
+	FONSquad q;
+	int retried = 0;
+	int cquads = (int)(end - string);
+
+	if (cquads > run->cquads) {
+		float* quads = (float*)realloc(run->quads, sizeof(float)*8*cquads);
+		if (quads == NULL) return 0;
+		run->quads = quads;
+		run->cquads = cquads;
+	}
+
+restart:
+	run->nquads = 0;
+	run->atlasPages = 0;
+	fonsTextIterInit(ctx->fs, &iter, x, y, string, end);
+	while (fonsTextIterNext(ctx->fs, &iter, &q)) {
+		float* quad;
+		if (iter.prevGlyphIndex == -1) { // can not retrieve glyph?
+			// Start over in a new atlas, the quads so far refer to the old one.
+			if (retried || !nvg__allocTextAtlas(ctx))
+				return 0;
+			retried = 1;
+			goto restart;
+		}
+		if (run->nquads >= run->cquads)
+			break;
+		quad = &run->quads[run->nquads*8];
+		quad[0] = q.x0 - floorf(x); quad[1] = q.y0 - floorf(y);
+		quad[2] = q.x1 - floorf(x); quad[3] = q.y1 - floorf(y);
+		quad[4] = q.s0; quad[5] = q.t0;
+		quad[6] = q.s1; quad[7] = q.t1;
+		run->nquads++;
+		run->atlasPages |= 1u << (iter.page & 31);
+	}
+	run->advance = iter.x - floorf(x);
+	return 1;
+}
+
+float nvgTextRun(NVGcontext* ctx, NVGtextRun* run, float x, float y, const char* string, const char* end)
+{
+	NVGstate* state = nvg__getState(ctx);
+	NVGvertex* verts;
+	NVGtextKey key;
+	float scale = nvg__getFontScale(state) * ctx->devicePxRatio;
+	float invscale = 1.0f / scale;
+	float sx = x*scale, sy = y*scale;
+	float ox = floorf(sx), oy = floorf(sy);
+	int len, i, nverts = 0;
+
+	if (run == NULL) return nvgText(ctx, x, y, string, end);
+
+	if (end == NULL)
+		end = string + strlen(string);
+	len = (int)(end - string);
+
+	if (state->fontId == FONS_INVALID) return x;
+
+	nvg__textKey(ctx, &key, NVG_MEASURE_RUN, sx - ox, sy - oy, 0.0f);
+	if (!run->valid || run->ctx != ctx || run->atlasGeneration != ctx->atlasGeneration ||
+		run->len != len || memcmp(&run->key, &key, sizeof(NVGtextKey)) != 0 ||
+		(len > 0 && memcmp(run->str, string, len) != 0)) {
+
+		run->valid = 0;
+		if (len > run->cstr) {
+			char* str = (char*)realloc(run->str, len);
+			if (str == NULL) return nvgText(ctx, x, y, string, end);
+			run->str = str;
+			run->cstr = len;
+		}
+
+		fonsSetSize(ctx->fs, state->fontSize*scale);
+		fonsSetSpacing(ctx->fs, state->letterSpacing*scale);
+		fonsSetBlur(ctx->fs, state->fontBlur*scale);
+		fonsSetAlign(ctx->fs, state->textAlign);
+		fonsSetFont(ctx->fs, state->fontId);
+		if (!nvg__buildTextRun(ctx, run, sx, sy, string, end))
+			return nvgText(ctx, x, y, string, end);
+
+		if (len > 0)
+			memcpy(run->str, string, len);
+		run->len = len;
+		run->key = key;
+		run->ctx = ctx;
+		run->atlasGeneration = ctx->atlasGeneration;
+		run->valid = 1;
+	}
+
+	verts = nvg__allocTempVerts(ctx, nvg__maxi(1, run->nquads) * 6);
+	if (verts == NULL) return x;
+
+	for (i = 0; i < run->nquads; i++) {
+		const float* q = &run->quads[i*8];
+		float x0 = (q[0] + ox) * invscale, y0 = (q[1] + oy) * invscale;
+		float x1 = (q[2] + ox) * invscale, y1 = (q[3] + oy) * invscale;
+		float c[4*2];
+		// Transform corners.
+		nvgTransformPoint(&c[0],&c[1], state->xform, x0, y0);
+		nvgTransformPoint(&c[2],&c[3], state->xform, x1, y0);
+		nvgTransformPoint(&c[4],&c[5], state->xform, x1, y1);
+		nvgTransformPoint(&c[6],&c[7], state->xform, x0, y1);
+		// Create triangles
+		nvg__vset(&verts[nverts], c[0], c[1], q[4], q[5]); nverts++;
+		nvg__vset(&verts[nverts], c[4], c[5], q[6], q[7]); nverts++;
+		nvg__vset(&verts[nverts], c[2], c[3], q[6], q[5]); nverts++;
+		nvg__vset(&verts[nverts], c[0], c[1], q[4], q[5]); nverts++;
+		nvg__vset(&verts[nverts], c[6], c[7], q[4], q[7]); nverts++;
+		nvg__vset(&verts[nverts], c[4], c[5], q[6], q[7]); nverts++;
+	}
+
+	nvg__flushTextTexture(ctx);
+
+	nvg__touchAtlasPages(ctx, run->atlasPages);
+	nvg__renderText(ctx, verts, nverts);
+
+	return ox + run->advance;
+}
+
 void nvgTextBox(NVGcontext* ctx, float x, float y, float breakRowWidth, const char* string, const char* end)
 {
 	NVGstate* state = nvg__getState(ctx);
@@ -2631,31 +4968,171 @@ int nvgTextBreakLines(NVGcontext* ctx, const char* string, const char* end, floa
 	return nrows;
 }
 
+static unsigned int nvg__hashText(const NVGtextKey* key, const char* string, int len)
+{
+	// FNV-1a
+	const unsigned char* p = (const unsigned char*)key;
+	unsigned int h = 2166136261u;
+	int i;
+	for (i = 0; i < (int)sizeof(NVGtextKey); i++)
+		h = (h ^ p[i]) * 16777619u;
+	p = (const unsigned char*)string;
+	for (i = 0; i < len; i++)
+		h = (h ^ p[i]) * 16777619u;
+	return h;
+}
+
+static void nvg__textCacheUnlink(NVGtextCache* tc, int i)
+{
+	NVGtextMeasure* m = &tc->measures[i];
+	if (m->lruPrev != -1) tc->measures[m->lruPrev].lruNext = m->lruNext;
+	else tc->lruHead = m->lruNext;
+	if (m->lruNext != -1) tc->measures[m->lruNext].lruPrev = m->lruPrev;
+	else tc->lruTail = m->lruPrev;
+}
+
+static void nvg__textCachePushFront(NVGtextCache* tc, int i)
+{
+	NVGtextMeasure* m = &tc->measures[i];
+	m->lruPrev = -1;
+	m->lruNext = tc->lruHead;
+	if (tc->lruHead != -1) tc->measures[tc->lruHead].lruPrev = i;
+	else tc->lruTail = i;
+	tc->lruHead = i;
+}
+
+static NVGtextMeasure* nvg__findTextMeasure(NVGtextCache* tc, const NVGtextKey* key, unsigned int hash, const char* string, int len)
+{
+	int i = tc->buckets[hash & (NVG_TEXT_CACHE_BUCKETS-1)];
+	while (i != -1) {
+		NVGtextMeasure* m = &tc->measures[i];
+		if (m->hash == hash && m->len == len &&
+			memcmp(&m->key, key, sizeof(NVGtextKey)) == 0 &&
+			(len == 0 || memcmp(m->str, string, len) == 0)) {
+			nvg__textCacheUnlink(tc, i);
+			nvg__textCachePushFront(tc, i);
+			tc->hits++;
+			return m;
+		}
+		i = m->next;
+	}
+	tc->misses++;
+	return NULL;
+}
+
+static NVGtextMeasure* nvg__addTextMeasure(NVGtextCache* tc, const NVGtextKey* key, unsigned int hash, const char* string, int len)
+{
+	NVGtextMeasure* m;
+	int i, *link;
+
+	if (tc->nmeasures < NVG_TEXT_CACHE_SIZE) {
+		i = tc->nmeasures++;
+	} else {
+		// Evict the least recently used measure.
+		i = tc->lruTail;
+		nvg__textCacheUnlink(tc, i);
+		link = &tc->buckets[tc->measures[i].hash & (NVG_TEXT_CACHE_BUCKETS-1)];
+		while (*link != i)
+			link = &tc->measures[*link].next;
+		*link = tc->measures[i].next;
+	}
+	m = &tc->measures[i];
+
+	m->len = len;
+	if (m->cstr < len) {
+		char* str = (char*)realloc(m->str, len);
+		if (str != NULL) {
+			m->str = str;
+			m->cstr = len;
+		} else {
+			m->len = -1; // Never matches, gets evicted eventually.
+		}
+	}
+	if (m->len > 0)
+		memcpy(m->str, string, len);
+	m->key = *key;
+	m->hash = hash;
+	m->next = tc->buckets[hash & (NVG_TEXT_CACHE_BUCKETS-1)];
+	tc->buckets[hash & (NVG_TEXT_CACHE_BUCKETS-1)] = i;
+	nvg__textCachePushFront(tc, i);
+	return m->len == len ? m : NULL;
+}
+
+void nvgTextCacheStats(NVGcontext* ctx, int* hits, int* misses)
+{
+	if (hits != NULL) *hits = ctx->textCache->hits;
+	if (misses != NULL) *misses = ctx->textCache->misses;
+}
+
+void nvgTextAtlasStats(NVGcontext* ctx, int* rasterized, int* evicted, int* glyphs)
+{
+	fonsAtlasStats(ctx->fs, rasterized, evicted, glyphs);
+}
+
+void nvgClearTextCache(NVGcontext* ctx)
+{
+	NVGtextCache* tc = ctx->textCache;
+	int i;
+	for (i = 0; i < NVG_TEXT_CACHE_BUCKETS; i++)
+		tc->buckets[i] = -1;
+	tc->nmeasures = 0;
+	tc->lruHead = tc->lruTail = -1;
+	tc->hits = tc->misses = 0;
+}
+
 float nvgTextBounds(NVGcontext* ctx, float x, float y, const char* string, const char* end, float* bounds)
 {
 	NVGstate* state = nvg__getState(ctx);
 	float scale = nvg__getFontScale(state) * ctx->devicePxRatio;
 	float invscale = 1.0f / scale;
 	float width;
+	float measured[4];
+	NVGtextKey key;
+	NVGtextMeasure* m = NULL;
+	unsigned int hash = 0;
+	int len;
 
 	if (state->fontId == FONS_INVALID) return 0;
 
+	if (end == NULL)
+		end = string + strlen(string);
+	len = (int)(end - string);
+	if (len <= NVG_TEXT_CACHE_MAX_STRING) {
+		nvg__textKey(ctx, &key, NVG_MEASURE_BOUNDS, x, y, 0.0f);
+		hash = nvg__hashText(&key, string, len);
+		m = nvg__findTextMeasure(ctx->textCache, &key, hash, string, len);
+		if (m != NULL) {
+			if (bounds != NULL)
+				memcpy(bounds, m->bounds, sizeof(float)*4);
+			return m->width;
+		}
+	}
+
 	fonsSetSize(ctx->fs, state->fontSize*scale);
 	fonsSetSpacing(ctx->fs, state->letterSpacing*scale);
 	fonsSetBlur(ctx->fs, state->fontBlur*scale);
 	fonsSetAlign(ctx->fs, state->textAlign);
 	fonsSetFont(ctx->fs, state->fontId);
 
-	width = fonsTextBounds(ctx->fs, x*scale, y*scale, string, end, bounds);
-	if (bounds != NULL) {
-		// Use line bounds for height.
-		fonsLineBounds(ctx->fs, y*scale, &bounds[1], &bounds[3]);
-		bounds[0] *= invscale;
-		bounds[1] *= invscale;
-		bounds[2] *= invscale;
-		bounds[3] *= invscale;
+	width = fonsTextBounds(ctx->fs, x*scale, y*scale, string, end, measured);
+	// Use line bounds for height.
+	fonsLineBounds(ctx->fs, y*scale, &measured[1], &measured[3]);
+	measured[0] *= invscale;
+	measured[1] *= invscale;
+	measured[2] *= invscale;
+	measured[3] *= invscale;
+	width *= invscale;
+
+	if (len <= NVG_TEXT_CACHE_MAX_STRING) {
+		m = nvg__addTextMeasure(ctx->textCache, &key, hash, string, len);
+		if (m != NULL) {
+			m->width = width;
+			memcpy(m->bounds, measured, sizeof(float)*4);
+		}
 	}
-	return width * invscale;
+	if (bounds != NULL)
+		memcpy(bounds, measured, sizeof(float)*4);
+	return width;
 }
 
 void nvgTextBoxBounds(NVGcontext* ctx, float x, float y, float breakRowWidth, const char* string, const char* end, float* bounds)
@@ -2670,6 +5147,10 @@ void nvgTextBoxBounds(NVGcontext* ctx, float x, float y, float breakRowWidth, co
 	int valign = state->textAlign & (NVG_ALIGN_TOP | NVG_ALIGN_MIDDLE | NVG_ALIGN_BOTTOM | NVG_ALIGN_BASELINE);
 	float lineh = 0, rminy = 0, rmaxy = 0;
 	float minx, miny, maxx, maxy;
+	NVGtextKey key;
+	NVGtextMeasure* m = NULL;
+	unsigned int hash = 0;
+	int len;
 
 	if (state->fontId == FONS_INVALID) {
 		if (bounds != NULL)
@@ -2677,6 +5158,20 @@ void nvgTextBoxBounds(NVGcontext* ctx, float x, float y, float breakRowWidth, co
 		return;
 	}
 
+	if (end == NULL)
+		end = string + strlen(string);
+	len = (int)(end - string);
+	if (len <= NVG_TEXT_CACHE_MAX_STRING) {
+		nvg__textKey(ctx, &key, NVG_MEASURE_BOX_BOUNDS, x, y, breakRowWidth);
+		hash = nvg__hashText(&key, string, len);
+		m = nvg__findTextMeasure(ctx->textCache, &key, hash, string, len);
+		if (m != NULL) {
+			if (bounds != NULL)
+				memcpy(bounds, m->bounds, sizeof(float)*4);
+			return;
+		}
+	}
+
 	nvgTextMetrics(ctx, NULL, NULL, &lineh);
 
 	state->textAlign = NVG_ALIGN_LEFT | valign;
@@ -2719,6 +5214,17 @@ void nvgTextBoxBounds(NVGcontext* ctx, float x, float y, float breakRowWidth, co
 
 	state->textAlign = oldAlign;
 
+	if (len <= NVG_TEXT_CACHE_MAX_STRING) {
+		m = nvg__addTextMeasure(ctx->textCache, &key, hash, string, len);
+		if (m != NULL) {
+			m->width = maxx - minx;
+			m->bounds[0] = minx;
+			m->bounds[1] = miny;
+			m->bounds[2] = maxx;
+			m->bounds[3] = maxy;
+		}
+	}
+
 	if (bounds != NULL) {
 		bounds[0] = minx;
 		bounds[1] = miny;
@@ -31,6 +31,7 @@ extern "C" {
 #endif
 
 typedef struct NVGcontext NVGcontext;
+typedef struct NVGrecording NVGrecording;
 
 struct NVGcolor
 {
@@ -116,6 +117,7 @@ enum NVGimageFlags
    NVG_IMAGE_REPEATY			= 1 << 2,		// Repeat image in Y direction.
    NVG_IMAGE_FLIPY				= 1 << 3,		// Flips (inverses) image in Y direction when rendered.
    NVG_IMAGE_PREMULTIPLIED		= 1 << 4,		// Image data has premultiplied alpha.
+   NVG_IMAGE_SDF				= 1 << 5,		// Alpha image is a distance field with the edge at 0.5, smoothed over +-feather of the paint.
 };
 
 // Begin drawing a new frame
@@ -460,6 +462,55 @@ void nvgFill (NVGcontext * ctx);
 // Fills the current path with current stroke style.
 void nvgStroke (NVGcontext * ctx);
 
+// Fills a rounded rectangle with the color without touching the current path. The shape is
+// drawn as a single quad, its edges are anti-aliased by the distance field of a box gradient
+// paint instead of tessellated fringes, which is cheaper and never needs the stencil buffer.
+void nvgFillRoundedRectFast (NVGcontext * ctx, float x, float y, float w, float h, float r, NVGcolor color);
+
+// Fills the area around the rounded rectangle x,y,w,h,r, out to spread units from it, with the
+// paint (usually a shadow made with nvgBoxGradient()). Equivalent to filling nvgRect() grown by
+// spread with nvgRoundedRect() as a hole, but built from a few quads and corner fans which need
+// no tessellation nor stencil. Does not touch the current path.
+void nvgDropShadowFast (NVGcontext * ctx, float x, float y, float w, float h, float r, float spread, NVGpaint paint);
+
+//
+// Cached paths
+//
+// Shapes which are drawn with the same geometry every frame can keep their flattened points and
+// the vertices of their last fill and stroke in a cache, keyed by the values which define them:
+//
+//		float rect[5] = {x,y,w,h,r};
+//		nvgBeginPath(vg);
+//		if (!nvgCachedPath(vg, ROUNDED_RECT, rect, 5))
+//			nvgRoundedRect(vg, x,y,w,h,r);
+//		nvgFill(vg);
+//
+// A cached path is reused while the scale and rotation of the transform and the device pixel
+// ratio stay the same, a different translation just moves it. Fill and stroke vertices are
+// reused while the stroke style is the same too. The least recently used paths are evicted
+// when the cache exceeds its limits.
+
+// Makes the path stored under key the current path and returns 1, in which case the path
+// commands must not be issued. Otherwise returns 0; the path built by the following commands
+// is flattened, expanded and stored under key by nvgFill() and nvgStroke(). Call it right after
+// nvgBeginPath(), and do not change the transform until the path is drawn. The nvals values
+// (at most 16, e.g. the arguments of nvgRoundedRect()) have to define the geometry of the path
+// in local coordinates, and shape is chosen by the caller to tell apart paths built by other
+// commands from the same number of values. Both are stored and compared exactly, paths with
+// more values are not cached.
+int nvgCachedPath (NVGcontext * ctx, unsigned int shape, const float * vals, int nvals);
+
+// Sets the max number of cached paths (at most 256, 0 disables the cache) and the max memory
+// they may use in bytes. Defaults are 256 paths and 4MB.
+void nvgCachedPathLimits (NVGcontext * ctx, int maxPaths, int maxBytes);
+
+// Returns the number of cache hits, misses and evictions since the context was created or
+// nvgClearCachedPaths() was called, and the memory used by the cached paths in bytes.
+void nvgCachedPathStats (NVGcontext * ctx, int * hits, int * misses, int * evictions, int * bytes);
+
+// Empties the path cache and resets its counters.
+void nvgClearCachedPaths (NVGcontext * ctx);
+
 
 //
 // Text
@@ -558,6 +609,177 @@ void nvgTextMetrics (NVGcontext * ctx, float * ascender, float * descender, floa
 // Words longer than the max width are slit at nearest character (i.e. no hyphenation).
 int nvgTextBreakLines (NVGcontext * ctx, const char * string, const char * end, float breakRowWidth, NVGtextRow * rows, int maxRows);
 
+// Results of nvgTextBounds() and nvgTextBoxBounds() are kept in a least recently used cache,
+// keyed on the text style (font, size, spacing, blur, align, line height), the current
+// font scale, the position, the row width and the string. Returns the number of cache
+// hits and misses since the context was created or nvgClearTextCache() was called.
+void nvgTextCacheStats (NVGcontext * ctx, int * hits, int * misses);
+
+// Empties the text measurement cache and resets its hit and miss counters.
+void nvgClearTextCache (NVGcontext * ctx);
+
+// The font atlas is managed in pages of horizontal bands. When it is full at its maximum size,
+// the least recently used pages which were not drawn from in the current frame are evicted,
+// instead of starting over with an empty atlas. Returns the number of glyphs rasterized and
+// pages evicted in the previous frame, and the number of glyphs currently in the atlas.
+void nvgTextAtlasStats (NVGcontext * ctx, int * rasterized, int * evicted, int * glyphs);
+
+// Rasterizes glyphs missing from the font atlas on nthreads background threads. Text is laid out
+// right away, but a new glyph is drawn from the closest size of the same glyph already in the
+// atlas, or left blank, until it is rasterized. Finished glyphs are uploaded at once in the next
+// nvgBeginFrame(). Pass 0 to rasterize glyphs when they are first drawn again. Returns the number
+// of threads in use, 0 when compiled with NVG_NO_THREADS or FONS_USE_FREETYPE.
+// Must be called outside of a frame.
+int nvgAsyncGlyphs (NVGcontext * ctx, int nthreads);
+
+// Returns the number of glyphs drawn with a placeholder which are not in the atlas yet.
+// Anything drawn with them needs to be drawn again once this drops.
+int nvgPendingGlyphs (NVGcontext * ctx);
+
+// Draws text from signed distance field glyphs. Each glyph is rasterized once and shared by
+// all font sizes, blurs and scales, the edge and the blur are computed when shading. Switching
+// the mode clears the font atlas. Returns 0 if the new atlas could not be created.
+// Must be called outside of a frame.
+int nvgTextSDF (NVGcontext * ctx, int enabled);
+
+// Saves the glyphs in the font atlas and its bitmap to a file, along with the device pixel ratio
+// of the frames they were drawn in. Returns 0 if the file could not be written, or if glyphs are
+// still being rasterized by nvgAsyncGlyphs().
+int nvgSaveFontAtlas (NVGcontext * ctx, const char * path, float devicePixelRatio);
+
+// Replaces the font atlas with one saved by nvgSaveFontAtlas() and uploads it at once. The same
+// fonts have to be created in the same order, and the nvgTextSDF() mode and (unless distance
+// field glyphs are used) the device pixel ratio have to match, else the file is ignored and 0 is
+// returned. Must be called outside of a frame.
+int nvgLoadFontAtlas (NVGcontext * ctx, const char * path, float devicePixelRatio);
+
+//
+// Text runs
+//
+// A text run keeps the glyph quads of the string last drawn with it. Drawing the same
+// string again with the same text style and font scale only transforms and copies the
+// quads, the glyphs are not looked up again. The quads are rebuilt when the string, the
+// text style, the font scale or the sub-pixel offset of the position change, and after
+// the font atlas was reset. Useful for static captions which are drawn every frame.
+
+typedef struct NVGtextRun NVGtextRun;
+
+// Creates an empty text run.
+NVGtextRun * nvgCreateTextRun (void);
+
+// Deletes a text run.
+void nvgDeleteTextRun (NVGtextRun * run);
+
+// Draws text string at specified location like nvgText(), reusing the quads stored in the run when possible.
+float nvgTextRun (NVGcontext * ctx, NVGtextRun * run, float x, float y, const char * string, const char * end);
+
+//
+// Recording
+//
+// A recording captures the tessellated geometry and paints which are passed to the
+// render back-end between nvgBeginRecording() and nvgEndRecording(). Drawing the same
+// content again can then be done with nvgReplayRecording(), which skips path flattening,
+// tessellation and text layout. Recordings can be nested, anything drawn (or replayed)
+// while a recording is active is captured by all active recordings.
+// A recording only stays valid while the transform, scissor and global alpha are the
+// same as when it was recorded, and until the font atlas is reset.
+
+// Creates an empty recording.
+NVGrecording * nvgCreateRecording (void);
+
+// Deletes recording and the geometry captured in it.
+void nvgDeleteRecording (NVGrecording * rec);
+
+// Starts capturing render calls into the recording, the calls are still rendered.
+void nvgBeginRecording (NVGcontext * ctx, NVGrecording * rec);
+
+// Stops capturing into the most recently begun recording.
+void nvgEndRecording (NVGcontext * ctx);
+
+// Renders the recorded calls again. Returns 0 (and draws nothing) if the recording
+// was never recorded or is not valid for the current state, in which case it should be recorded again.
+int nvgReplayRecording (NVGcontext * ctx, NVGrecording * rec);
+
+//
+// Tessellation
+//
+// The per point loops of path tessellation (segment directions, joins and fringe vertices)
+// run on SSE2 kernels when the library is compiled for a CPU which has them, the scalar
+// kernels are used otherwise. Both produce the same geometry, up to rounding when the
+// compiler contracts the scalar math into fused multiply-adds. Define NVG_NO_SIMD when
+// compiling nanovg.c to leave the SIMD kernels out.
+
+// Selects the SIMD kernels if enable is non-zero and they were compiled in, otherwise the scalar ones.
+// Returns 1 if the SIMD kernels are in use. The SIMD kernels are selected when the context is created.
+int nvgUseSimd (NVGcontext * ctx, int enable);
+
+// Defers tessellation of fills and strokes to nvgEndFrame(), where the paths of the frame are
+// flattened and expanded in parallel on nthreads threads, the thread calling nvgEndFrame()
+// being one of them. nvgFill() and nvgStroke() then only copy the path commands, and all
+// render calls reach the back-end in their original order at the end of the frame.
+// Paths drawn while recording or with nvgCachedPath() are still tessellated right away.
+// Pass 0 to tessellate immediately again. Returns the number of threads in use, which is at
+// most 16, and 1 when compiled with NVG_NO_THREADS. Must be called outside of a frame.
+int nvgDeferTessellation (NVGcontext * ctx, int nthreads);
+
+//
+// Frame memory
+//
+// Path commands, flattened points and vertices, and the render calls of the back-end are
+// built in scratch buffers which are reset each frame but keep their memory. The buffers
+// grow when a frame needs more than any frame before, e.g. when a large popup opens for the
+// first time, which may take several reallocations within that frame. The context tracks
+// how much of each buffer a frame uses, so the buffers can be sized up front instead.
+
+struct NVGframeSizes
+{
+   int commands;     // Path commands of the largest path, in floats.
+   int points;       // Flattened points of the largest path.
+   int paths;        // Sub-paths of the largest path.
+   int verts;        // Vertices of the largest tessellated path or text.
+   int calls;        // Render calls passed to the back-end in the frame.
+   int callPaths;    // Paths of all render calls.
+   int callVerts;    // Vertices of all render calls.
+};
+typedef struct NVGframeSizes NVGframeSizes;
+
+// Returns the sizes used by the last finished frame and the largest sizes used by any frame.
+void nvgFrameSizes (NVGcontext * ctx, NVGframeSizes * last, NVGframeSizes * peak);
+
+// Grows the scratch buffers of the context and of the render back-end, so that frames up to
+// sizes do not reallocate, e.g. with the peak sizes of a previous run. Returns 0 if out of memory.
+int nvgReserveFrame (NVGcontext * ctx, const NVGframeSizes * sizes);
+
+//
+// Frame statistics
+//
+// Counters of the work done for a frame, from nvgBeginFrame() to the end of nvgEndFrame().
+// Back-end counters are 0 when the render back-end does not report them. New counters are only
+// ever added at the end of the struct.
+
+struct NVGframeStats
+{
+   int drawCalls;        // Draw calls issued by the back-end, after batching.
+   int convexFills;      // Fills of a single convex path, drawn directly.
+   int stencilFills;     // Fills drawn through the stencil buffer.
+   int strokes;          // Strokes drawn directly.
+   int stencilStrokes;   // Strokes drawn through the stencil buffer (NVG_STENCIL_STROKES).
+   int triangles;        // Triangle calls, i.e. text.
+   int verts;            // Vertices uploaded by the back-end.
+   int uniformBytes;     // Bytes of fragment uniforms uploaded by the back-end.
+   int textureBinds;     // Texture binds by the back-end.
+   int glyphsRasterized; // Glyphs rasterized into the font atlas.
+   int atlasUploads;     // Updates of the font atlas texture.
+   int vertReallocs;     // Reallocations of the temporary vertex buffers.
+   int pathCacheGrowth;  // Reallocations of the path commands, points and paths.
+};
+typedef struct NVGframeStats NVGframeStats;
+
+// Returns the counters of the last finished frame, i.e. between the last nvgBeginFrame() and
+// nvgEndFrame() pair. Callers drawing several frames per displayed image (e.g. to a framebuffer
+// and then to the screen) have to add up the counters of each.
+void nvgGetFrameStats (NVGcontext * ctx, NVGframeStats * stats);
+
 //
 // Internal Render API
 //
@@ -611,6 +833,11 @@ struct NVGparams
    void (*renderStroke) (void * uptr, NVGpaint * paint, NVGscissor * scissor, float fringe, float strokeWidth, const NVGpath * paths, int npaths);
    void (*renderTriangles) (void * uptr, NVGpaint * paint, NVGscissor * scissor, const NVGvertex * verts, int nverts);
    void (*renderDelete) (void * uptr);
+   // Optional, grows the per frame buffers of the back-end for a frame of ncalls render calls
+   // with npaths paths and nverts vertices in total. Returns 0 if out of memory.
+   int (*renderReserve) (void * uptr, int ncalls, int npaths, int nverts);
+   // Optional, adds the counters of the back-end since the previous call to stats, and resets them.
+   void (*renderFrameStats) (void * uptr, NVGframeStats * stats);
 };
 typedef struct NVGparams NVGparams;
 
@@ -33,6 +33,15 @@ enum NVGcreateFlags
    NVG_STENCIL_STROKES	= 1 << 1,
    // Flag indicating that additional debug checks are done.
    NVG_DEBUG 			= 1 << 2,
+   // Flag indicating that vertex and uniform data is uploaded into a triple-buffered ring of
+   // buffer segments guarded by fences, instead of reallocating the buffers every frame.
+   // Segments are written with glMapBufferRange(), or glBufferSubData() if mapping fails.
+   // Only available on GL3 and GLES3, ignored otherwise.
+   NVG_RING_BUFFER		= 1 << 3,
+   // Flag indicating that consecutive convex fills, strokes and triangles using the same texture
+   // are merged into single indexed draw calls. Each vertex selects its own paint uniforms.
+   // Calls are never reordered. Only available on GL3, ignored otherwise.
+   NVG_BATCH_CALLS		= 1 << 4,
 };
 
 #if defined NANOVG_GL2_IMPLEMENTATION
@@ -52,6 +61,14 @@ enum NVGcreateFlags
 
 #define NANOVG_GL_USE_STATE_FILTER (1)
 
+#if defined NANOVG_GL3 || defined NANOVG_GLES3
+#  define NANOVG_GL_USE_RING_BUFFER 1
+#endif
+
+#if NANOVG_GL_USE_UNIFORMBUFFER
+#  define NANOVG_GL_USE_BATCHING 1
+#endif
+
 // Creates NanoVG contexts for different OpenGL (ES) versions.
 // Flags should be combination of the create flags above.
 
@@ -92,6 +109,17 @@ enum NVGimageFlagsGL
 int nvglCreateImageFromHandle (NVGcontext * ctx, GLuint textureId, int w, int h, int flags);
 GLuint nvglImageHandle (NVGcontext * ctx, int image);
 
+// Restricts all rendering of the following frames to a rectangle of the render target.
+// The rectangle is in framebuffer pixels with the origin at the bottom-left corner,
+// as passed to glScissor(). Unlike nvgScissor() it does not change the render state.
+void nvglClipRect (NVGcontext * ctx, int x, int y, int w, int h);
+// Removes the clip rectangle set with nvglClipRect().
+void nvglResetClipRect (NVGcontext * ctx);
+
+// Returns the number of render calls of the last flush, and the number of batches
+// they were drawn in after merging (see NVG_BATCH_CALLS). Either pointer may be NULL.
+void nvglBatchStats (NVGcontext * ctx, int * calls, int * batches);
+
 
 #ifdef __cplusplus
 }
@@ -107,6 +135,12 @@ GLuint nvglImageHandle (NVGcontext * ctx, int image);
 #include <math.h>
 #include "nanovg.h"
 
+// Scope marker timing the render flush, e.g. a profiler zone when included from C++.
+// Expands to a statement, placed after the declarations.
+#ifndef NVGL_PROFILE_ZONE
+#  define NVGL_PROFILE_ZONE(name) ((void)0)
+#endif
+
 enum GLNVGuniformLoc
 {
    GLNVG_LOC_VIEWSIZE,
@@ -167,6 +201,8 @@ struct GLNVGcall
    int triangleOffset;
    int triangleCount;
    int uniformOffset;
+   int elementOffset;
+   int elementCount;
 };
 typedef struct GLNVGcall GLNVGcall;
 
@@ -223,6 +259,23 @@ struct GLNVGfragUniforms
 };
 typedef struct GLNVGfragUniforms GLNVGfragUniforms;
 
+#if NANOVG_GL_USE_BATCHING
+// Upper bound of the uniforms a single batch can index.
+#define GLNVG_MAX_BATCH 64
+#endif
+
+#if NANOVG_GL_USE_RING_BUFFER
+#define GLNVG_RING_SEGMENTS 3
+
+struct GLNVGring
+{
+   int segmentSize;
+   int segment;
+   GLsync fences[GLNVG_RING_SEGMENTS];
+};
+typedef struct GLNVGring GLNVGring;
+#endif
+
 struct GLNVGcontext
 {
    GLNVGshader shader;
@@ -240,6 +293,28 @@ struct GLNVGcontext
 #endif
    int fragSize;
    int flags;
+#if NANOVG_GL_USE_RING_BUFFER
+   GLNVGring vertRing;
+   GLNVGring fragRing;
+#endif
+   int vertBase;
+   int fragBase;
+   int clip;
+   int clipRect[4];
+#if NANOVG_GL_USE_BATCHING
+   GLuint indexBuf;
+   GLuint elementBuf;
+#if NANOVG_GL_USE_RING_BUFFER
+   GLNVGring indexRing;
+   GLNVGring elementRing;
+#endif
+   int indexBase;
+   int elementBase;
+   int batchSize;
+#endif
+   int callsFlushed;
+   int batchesFlushed;
+   NVGframeStats stats;   // Counters since the last glnvg__renderFrameStats().
 
    // Per frame buffers
    GLNVGcall * calls;
@@ -254,6 +329,13 @@ struct GLNVGcontext
    unsigned char * uniforms;
    int cuniforms;
    int nuniforms;
+#if NANOVG_GL_USE_BATCHING
+   float * indices;
+   int cindices;
+   GLuint * elements;
+   int celements;
+   int nelements;
+#endif
 
    // cached state
 #if NANOVG_GL_USE_STATE_FILTER
@@ -271,6 +353,11 @@ static int glnvg__maxi (int a, int b)
    return a > b ? a : b;
 }
 
+static int glnvg__mini (int a, int b)
+{
+   return a < b ? a : b;
+}
+
 #ifdef NANOVG_GLES2
 static unsigned int glnvg__nearestPow2 (unsigned int num)
 {
@@ -292,12 +379,20 @@ static void glnvg__bindTexture (GLNVGcontext * gl, GLuint tex)
    {
       gl->boundTexture = tex;
       glBindTexture (GL_TEXTURE_2D, tex);
+      gl->stats.textureBinds++;
    }
 #else
    glBindTexture (GL_TEXTURE_2D, tex);
+   gl->stats.textureBinds++;
 #endif
 }
 
+static void glnvg__drawArrays (GLNVGcontext * gl, GLenum mode, GLint first, GLsizei count)
+{
+   glDrawArrays (mode, first, count);
+   gl->stats.drawCalls++;
+}
+
 static void glnvg__stencilMask (GLNVGcontext * gl, GLuint mask)
 {
 #if NANOVG_GL_USE_STATE_FILTER
@@ -448,6 +543,9 @@ static int glnvg__createShader (GLNVGshader * shader, const char * name, const c
    glAttachShader (prog, frag);
    glBindAttribLocation (prog, 0, "vertex");
    glBindAttribLocation (prog, 1, "tcoord");
+#if NANOVG_GL_USE_UNIFORMBUFFER
+   glBindAttribLocation (prog, 2, "uniformIndex");
+#endif
    glLinkProgram (prog);
    glGetProgramiv (prog, GL_LINK_STATUS, &status);
    if (status != GL_TRUE)
@@ -486,6 +584,10 @@ static int glnvg__renderCreate (void * uptr)
 {
    GLNVGcontext * gl = (GLNVGcontext *)uptr;
    int align = 4;
+#if NANOVG_GL_USE_BATCHING
+   GLint maxBlockSize = 16384;
+   char opts[128];
+#endif
    // TODO: mediump float may not be enough for GLES2 in iOS.
    // see the following discussion: https://github.com/memononen/nanovg/issues/46
    static const char * shaderHeader =
@@ -514,6 +616,10 @@ static int glnvg__renderCreate (void * uptr)
       "	in vec2 tcoord;\n"
       "	out vec2 ftcoord;\n"
       "	out vec2 fpos;\n"
+      "#ifdef USE_UNIFORMBUFFER\n"
+      "	in float uniformIndex;\n"
+      "	flat out int fragIndex;\n"
+      "#endif\n"
       "#else\n"
       "	uniform vec2 viewSize;\n"
       "	attribute vec2 vertex;\n"
@@ -524,6 +630,9 @@ static int glnvg__renderCreate (void * uptr)
       "void main(void) {\n"
       "	ftcoord = tcoord;\n"
       "	fpos = vertex;\n"
+      "#ifdef USE_UNIFORMBUFFER\n"
+      "	fragIndex = int(uniformIndex);\n"
+      "#endif\n"
       "	gl_Position = vec4(2.0*vertex.x/viewSize.x - 1.0, 1.0 - 2.0*vertex.y/viewSize.y, 0, 1);\n"
       "}\n";
    static const char * fillFragShader =
@@ -536,7 +645,7 @@ static int glnvg__renderCreate (void * uptr)
       "#endif\n"
       "#ifdef NANOVG_GL3\n"
       "#ifdef USE_UNIFORMBUFFER\n"
-      "	layout(std140) uniform frag {\n"
+      "	struct Frag {\n"
       "		mat3 scissorMat;\n"
       "		mat3 paintMat;\n"
       "		vec4 innerCol;\n"
@@ -550,7 +659,14 @@ static int glnvg__renderCreate (void * uptr)
       "		float strokeThr;\n"
       "		int texType;\n"
       "		int type;\n"
+      "#if FRAG_PADDING > 0\n"
+      "		vec4 padding[FRAG_PADDING];\n"
+      "#endif\n"
+      "	};\n"
+      "	layout(std140) uniform frag {\n"
+      "		Frag frags[BATCH_SIZE];\n"
       "	};\n"
+      "	flat in int fragIndex;\n"
       "#else\n" // NANOVG_GL3 && !USE_UNIFORMBUFFER
       "	uniform vec4 frag[UNIFORMARRAY_SIZE];\n"
       "#endif\n"
@@ -564,7 +680,21 @@ static int glnvg__renderCreate (void * uptr)
       "	varying vec2 ftcoord;\n"
       "	varying vec2 fpos;\n"
       "#endif\n"
-      "#ifndef USE_UNIFORMBUFFER\n"
+      "#ifdef USE_UNIFORMBUFFER\n"
+      "	#define scissorMat frags[fragIndex].scissorMat\n"
+      "	#define paintMat frags[fragIndex].paintMat\n"
+      "	#define innerCol frags[fragIndex].innerCol\n"
+      "	#define outerCol frags[fragIndex].outerCol\n"
+      "	#define scissorExt frags[fragIndex].scissorExt\n"
+      "	#define scissorScale frags[fragIndex].scissorScale\n"
+      "	#define extent frags[fragIndex].extent\n"
+      "	#define radius frags[fragIndex].radius\n"
+      "	#define feather frags[fragIndex].feather\n"
+      "	#define strokeMult frags[fragIndex].strokeMult\n"
+      "	#define strokeThr frags[fragIndex].strokeThr\n"
+      "	#define texType frags[fragIndex].texType\n"
+      "	#define type frags[fragIndex].type\n"
+      "#else\n"
       "	#define scissorMat mat3(frag[0].xyz, frag[1].xyz, frag[2].xyz)\n"
       "	#define paintMat mat3(frag[3].xyz, frag[4].xyz, frag[5].xyz)\n"
       "	#define innerCol frag[6]\n"
@@ -625,6 +755,7 @@ static int glnvg__renderCreate (void * uptr)
       "#endif\n"
       "		if (texType == 1) color = vec4(color.xyz*color.w,color.w);"
       "		if (texType == 2) color = vec4(color.x);"
+      "		if (texType == 3) color = vec4(smoothstep(0.5 - feather, 0.5 + feather, color.x));"
       "		// Apply color tint and alpha.\n"
       "		color *= innerCol;\n"
       "		// Combine alpha\n"
@@ -640,6 +771,7 @@ static int glnvg__renderCreate (void * uptr)
       "#endif\n"
       "		if (texType == 1) color = vec4(color.xyz*color.w,color.w);"
       "		if (texType == 2) color = vec4(color.x);"
+      "		if (texType == 3) color = vec4(smoothstep(0.5 - feather, 0.5 + feather, color.x));"
       "		color *= scissor;\n"
       "		result = color * innerCol;\n"
       "	}\n"
@@ -653,6 +785,21 @@ static int glnvg__renderCreate (void * uptr)
       "#endif\n"
       "}\n";
    glnvg__checkError (gl, "init");
+#if NANOVG_GL_USE_UNIFORMBUFFER
+   glGetIntegerv (GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &align);
+   // The uniforms are also indexed as a std140 array, keep them vec4 aligned.
+   align = glnvg__maxi (align, 16);
+#endif
+   gl->fragSize = sizeof (GLNVGfragUniforms) + align - sizeof (GLNVGfragUniforms) % align;
+#if NANOVG_GL_USE_BATCHING
+   glGetIntegerv (GL_MAX_UNIFORM_BLOCK_SIZE, &maxBlockSize);
+   gl->batchSize = glnvg__maxi (1, glnvg__mini (GLNVG_MAX_BATCH, maxBlockSize / gl->fragSize));
+   snprintf (opts, sizeof (opts), "%s#define BATCH_SIZE %d\n#define FRAG_PADDING %d\n",
+             gl->flags & NVG_ANTIALIAS ? "#define EDGE_AA 1\n" : "", gl->batchSize,
+             (gl->fragSize - (int)sizeof (GLNVGfragUniforms)) / 16);
+   if (glnvg__createShader (&gl->shader, "shader", shaderHeader, opts, fillVertShader, fillFragShader) == 0)
+      return 0;
+#else
    if (gl->flags & NVG_ANTIALIAS)
    {
       if (glnvg__createShader (&gl->shader, "shader", shaderHeader, "#define EDGE_AA 1\n", fillVertShader, fillFragShader) == 0)
@@ -663,6 +810,7 @@ static int glnvg__renderCreate (void * uptr)
       if (glnvg__createShader (&gl->shader, "shader", shaderHeader, NULL, fillVertShader, fillFragShader) == 0)
          return 0;
    }
+#endif
    glnvg__checkError (gl, "uniform locations");
    glnvg__getUniforms (&gl->shader);
    // Create dynamic vertex array
@@ -674,9 +822,11 @@ static int glnvg__renderCreate (void * uptr)
    // Create UBOs
    glUniformBlockBinding (gl->shader.prog, gl->shader.loc[GLNVG_LOC_FRAG], GLNVG_FRAG_BINDING);
    glGenBuffers (1, &gl->fragBuf);
-   glGetIntegerv (GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &align);
 #endif
-   gl->fragSize = sizeof (GLNVGfragUniforms) + align - sizeof (GLNVGfragUniforms) % align;
+#if NANOVG_GL_USE_BATCHING
+   glGenBuffers (1, &gl->indexBuf);
+   glGenBuffers (1, &gl->elementBuf);
+#endif
    glnvg__checkError (gl, "create done");
    glFinish();
    return 1;
@@ -885,7 +1035,14 @@ static int glnvg__convertPaint (GLNVGcontext * gl, GLNVGfragUniforms * frag, NVG
       if (tex->type == NVG_TEXTURE_RGBA)
          frag->texType = (tex->flags & NVG_IMAGE_PREMULTIPLIED) ? 0 : 1;
       else
-         frag->texType = 2;
+         if (tex->flags & NVG_IMAGE_SDF)
+         {
+            // The feather is the half width of the distance field edge.
+            frag->texType = 3;
+            frag->feather = paint->feather > 0.0f ? paint->feather : 0.5f / 255.0f;
+         }
+         else
+            frag->texType = 2;
       //		printf("frag->texType = %d\n", frag->texType);
    }
    else
@@ -904,10 +1061,12 @@ static GLNVGfragUniforms * nvg__fragUniformPtr (GLNVGcontext * gl, int i);
 static void glnvg__setUniforms (GLNVGcontext * gl, int uniformOffset, int image)
 {
 #if NANOVG_GL_USE_UNIFORMBUFFER
-   glBindBufferRange (GL_UNIFORM_BUFFER, GLNVG_FRAG_BINDING, gl->fragBuf, uniformOffset, sizeof (GLNVGfragUniforms));
+   // The whole batch is bound, the buffer is padded so that the range never runs past its end.
+   glBindBufferRange (GL_UNIFORM_BUFFER, GLNVG_FRAG_BINDING, gl->fragBuf, gl->fragBase + uniformOffset, gl->batchSize * gl->fragSize);
 #else
    GLNVGfragUniforms * frag = nvg__fragUniformPtr (gl, uniformOffset);
    glUniform4fv (gl->shader.loc[GLNVG_LOC_FRAG], NANOVG_GL_UNIFORMARRAY_SIZE, & (frag->uniformArray[0][0]));
+   gl->stats.uniformBytes += NANOVG_GL_UNIFORMARRAY_SIZE * 4 * sizeof (float);
 #endif
    if (image != 0)
    {
@@ -942,7 +1101,7 @@ static void glnvg__fill (GLNVGcontext * gl, GLNVGcall * call)
    glStencilOpSeparate (GL_BACK, GL_KEEP, GL_KEEP, GL_DECR_WRAP);
    glDisable (GL_CULL_FACE);
    for (i = 0; i < npaths; i++)
-      glDrawArrays (GL_TRIANGLE_FAN, paths[i].fillOffset, paths[i].fillCount);
+      glnvg__drawArrays (gl, GL_TRIANGLE_FAN, paths[i].fillOffset, paths[i].fillCount);
    glEnable (GL_CULL_FACE);
    // Draw anti-aliased pixels
    glColorMask (GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
@@ -954,12 +1113,12 @@ static void glnvg__fill (GLNVGcontext * gl, GLNVGcall * call)
       glStencilOp (GL_KEEP, GL_KEEP, GL_KEEP);
       // Draw fringes
       for (i = 0; i < npaths; i++)
-         glDrawArrays (GL_TRIANGLE_STRIP, paths[i].strokeOffset, paths[i].strokeCount);
+         glnvg__drawArrays (gl, GL_TRIANGLE_STRIP, paths[i].strokeOffset, paths[i].strokeCount);
    }
    // Draw fill
    glnvg__stencilFunc (gl, GL_NOTEQUAL, 0x0, 0xff);
    glStencilOp (GL_ZERO, GL_ZERO, GL_ZERO);
-   glDrawArrays (GL_TRIANGLES, call->triangleOffset, call->triangleCount);
+   glnvg__drawArrays (gl, GL_TRIANGLES, call->triangleOffset, call->triangleCount);
    glDisable (GL_STENCIL_TEST);
 }
 
@@ -970,12 +1129,12 @@ static void glnvg__convexFill (GLNVGcontext * gl, GLNVGcall * call)
    glnvg__setUniforms (gl, call->uniformOffset, call->image);
    glnvg__checkError (gl, "convex fill");
    for (i = 0; i < npaths; i++)
-      glDrawArrays (GL_TRIANGLE_FAN, paths[i].fillOffset, paths[i].fillCount);
+      glnvg__drawArrays (gl, GL_TRIANGLE_FAN, paths[i].fillOffset, paths[i].fillCount);
    if (gl->flags & NVG_ANTIALIAS)
    {
       // Draw fringes
       for (i = 0; i < npaths; i++)
-         glDrawArrays (GL_TRIANGLE_STRIP, paths[i].strokeOffset, paths[i].strokeCount);
+         glnvg__drawArrays (gl, GL_TRIANGLE_STRIP, paths[i].strokeOffset, paths[i].strokeCount);
    }
 }
 
@@ -993,20 +1152,20 @@ static void glnvg__stroke (GLNVGcontext * gl, GLNVGcall * call)
       glnvg__setUniforms (gl, call->uniformOffset + gl->fragSize, call->image);
       glnvg__checkError (gl, "stroke fill 0");
       for (i = 0; i < npaths; i++)
-         glDrawArrays (GL_TRIANGLE_STRIP, paths[i].strokeOffset, paths[i].strokeCount);
+         glnvg__drawArrays (gl, GL_TRIANGLE_STRIP, paths[i].strokeOffset, paths[i].strokeCount);
       // Draw anti-aliased pixels.
       glnvg__setUniforms (gl, call->uniformOffset, call->image);
       glnvg__stencilFunc (gl, GL_EQUAL, 0x00, 0xff);
       glStencilOp (GL_KEEP, GL_KEEP, GL_KEEP);
       for (i = 0; i < npaths; i++)
-         glDrawArrays (GL_TRIANGLE_STRIP, paths[i].strokeOffset, paths[i].strokeCount);
+         glnvg__drawArrays (gl, GL_TRIANGLE_STRIP, paths[i].strokeOffset, paths[i].strokeCount);
       // Clear stencil buffer.
       glColorMask (GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
       glnvg__stencilFunc (gl, GL_ALWAYS, 0x0, 0xff);
       glStencilOp (GL_ZERO, GL_ZERO, GL_ZERO);
       glnvg__checkError (gl, "stroke fill 1");
       for (i = 0; i < npaths; i++)
-         glDrawArrays (GL_TRIANGLE_STRIP, paths[i].strokeOffset, paths[i].strokeCount);
+         glnvg__drawArrays (gl, GL_TRIANGLE_STRIP, paths[i].strokeOffset, paths[i].strokeCount);
       glColorMask (GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
       glDisable (GL_STENCIL_TEST);
       //		glnvg__convertPaint(gl, nvg__fragUniformPtr(gl, call->uniformOffset + gl->fragSize), paint, scissor, strokeWidth, fringe, 1.0f - 0.5f/255.0f);
@@ -1017,7 +1176,7 @@ static void glnvg__stroke (GLNVGcontext * gl, GLNVGcall * call)
       glnvg__checkError (gl, "stroke fill");
       // Draw Strokes
       for (i = 0; i < npaths; i++)
-         glDrawArrays (GL_TRIANGLE_STRIP, paths[i].strokeOffset, paths[i].strokeCount);
+         glnvg__drawArrays (gl, GL_TRIANGLE_STRIP, paths[i].strokeOffset, paths[i].strokeCount);
    }
 }
 
@@ -1025,7 +1184,7 @@ static void glnvg__triangles (GLNVGcontext * gl, GLNVGcall * call)
 {
    glnvg__setUniforms (gl, call->uniformOffset, call->image);
    glnvg__checkError (gl, "triangles fill");
-   glDrawArrays (GL_TRIANGLES, call->triangleOffset, call->triangleCount);
+   glnvg__drawArrays (gl, GL_TRIANGLES, call->triangleOffset, call->triangleCount);
 }
 
 static void glnvg__renderCancel (void * uptr)
@@ -1037,10 +1196,246 @@ static void glnvg__renderCancel (void * uptr)
    gl->nuniforms = 0;
 }
 
+static void glnvg__renderFrameStats (void * uptr, NVGframeStats * stats)
+{
+   GLNVGcontext * gl = (GLNVGcontext *)uptr;
+   stats->drawCalls += gl->stats.drawCalls;
+   stats->convexFills += gl->stats.convexFills;
+   stats->stencilFills += gl->stats.stencilFills;
+   stats->strokes += gl->stats.strokes;
+   stats->stencilStrokes += gl->stats.stencilStrokes;
+   stats->triangles += gl->stats.triangles;
+   stats->verts += gl->stats.verts;
+   stats->uniformBytes += gl->stats.uniformBytes;
+   stats->textureBinds += gl->stats.textureBinds;
+   memset (&gl->stats, 0, sizeof (gl->stats));
+}
+
+#if NANOVG_GL_USE_RING_BUFFER
+// Copies data into the next segment of a ring buffer and returns its offset in the buffer.
+// The segment holds at least 'capacity' bytes, which may be more than the copied 'size'.
+// The segment is only reused after the GPU signalled the fence of the frame that used it last.
+static int glnvg__ringUpload (GLNVGring * ring, GLenum target, const void * data, int size, int capacity, int granularity)
+{
+   int i, offset;
+   void * ptr;
+   ring->segment = (ring->segment + 1) % GLNVG_RING_SEGMENTS;
+   if (capacity > ring->segmentSize)
+   {
+      // Grow all segments, the old storage is orphaned so no need to wait.
+      int segmentSize = glnvg__maxi (capacity, ring->segmentSize + ring->segmentSize / 2); // 1.5x Overallocate
+      segmentSize = (segmentSize + granularity - 1) / granularity * granularity;
+      for (i = 0; i < GLNVG_RING_SEGMENTS; i++)
+      {
+         if (ring->fences[i] != 0)
+            glDeleteSync (ring->fences[i]);
+         ring->fences[i] = 0;
+      }
+      glBufferData (target, segmentSize * GLNVG_RING_SEGMENTS, NULL, GL_DYNAMIC_DRAW);
+      ring->segmentSize = segmentSize;
+      ring->segment = 0;
+   }
+   else if (ring->fences[ring->segment] != 0)
+   {
+      glClientWaitSync (ring->fences[ring->segment], GL_SYNC_FLUSH_COMMANDS_BIT, (GLuint64)1000000000);
+      glDeleteSync (ring->fences[ring->segment]);
+      ring->fences[ring->segment] = 0;
+   }
+   offset = ring->segment * ring->segmentSize;
+   if (size == 0)
+      return offset;
+   ptr = glMapBufferRange (target, offset, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+   if (ptr != NULL)
+   {
+      memcpy (ptr, data, size);
+      if (glUnmapBuffer (target))
+         return offset;
+   }
+   // Mapping is not available (or the data got lost), copy from the CPU side instead.
+   glBufferSubData (target, offset, size, data);
+   return offset;
+}
+
+static void glnvg__ringFence (GLNVGring * ring)
+{
+   if (ring->fences[ring->segment] != 0)
+      glDeleteSync (ring->fences[ring->segment]);
+   ring->fences[ring->segment] = glFenceSync (GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+static void glnvg__ringDelete (GLNVGring * ring)
+{
+   int i;
+   for (i = 0; i < GLNVG_RING_SEGMENTS; i++)
+   {
+      if (ring->fences[i] != 0)
+         glDeleteSync (ring->fences[i]);
+      ring->fences[i] = 0;
+   }
+}
+#endif
+
+#if NANOVG_GL_USE_BATCHING
+static int glnvg__allocElements (GLNVGcontext * gl, int n)
+{
+   int ret = 0;
+   if (gl->nelements + n > gl->celements)
+   {
+      GLuint * elements;
+      int celements = glnvg__maxi (gl->nelements + n, 4096) + gl->celements / 2; // 1.5x Overallocate
+      elements = (GLuint *)realloc (gl->elements, sizeof (GLuint) * celements);
+      if (elements == NULL) return -1;
+      gl->elements = elements;
+      gl->celements = celements;
+   }
+   ret = gl->nelements;
+   gl->nelements += n;
+   return ret;
+}
+
+static int glnvg__batchable (GLNVGcontext * gl, GLNVGcall * call)
+{
+   if (call->type == GLNVG_CONVEXFILL || call->type == GLNVG_TRIANGLES)
+      return 1;
+   return call->type == GLNVG_STROKE && (gl->flags & NVG_STENCIL_STROKES) == 0;
+}
+
+static GLuint * glnvg__fanElements (GLuint * dst, float * indices, int offset, int count, float index)
+{
+   int i;
+   for (i = 0; i < count; i++)
+      indices[offset + i] = index;
+   for (i = 2; i < count; i++)
+   {
+      *dst++ = offset;
+      *dst++ = offset + i - 1;
+      *dst++ = offset + i;
+   }
+   return dst;
+}
+
+static GLuint * glnvg__stripElements (GLuint * dst, float * indices, int offset, int count, float index)
+{
+   int i;
+   for (i = 0; i < count; i++)
+      indices[offset + i] = index;
+   for (i = 2; i < count; i++)
+   {
+      // Every other triangle of a strip is flipped to keep the winding.
+      *dst++ = offset + i - 2 + (i & 1);
+      *dst++ = offset + i - 1 - (i & 1);
+      *dst++ = offset + i;
+   }
+   return dst;
+}
+
+// Converts the fans and strips of a call into a triangle list in the element buffer,
+// and tags its vertices with the given uniform index.
+static int glnvg__callElements (GLNVGcontext * gl, GLNVGcall * call, float index)
+{
+   GLNVGpath * paths = &gl->paths[call->pathOffset];
+   int i, count = 0, offset;
+   int fills = call->type == GLNVG_CONVEXFILL;
+   int strokes = call->type == GLNVG_STROKE || (fills && (gl->flags & NVG_ANTIALIAS));
+   GLuint * dst;
+   if (call->type == GLNVG_TRIANGLES)
+      count = call->triangleCount;
+   for (i = 0; i < call->pathCount; i++)
+   {
+      if (fills)
+         count += glnvg__maxi (paths[i].fillCount - 2, 0) * 3;
+      if (strokes)
+         count += glnvg__maxi (paths[i].strokeCount - 2, 0) * 3;
+   }
+   offset = glnvg__allocElements (gl, count);
+   if (offset == -1) return 0;
+   dst = &gl->elements[offset];
+   if (call->type == GLNVG_TRIANGLES)
+   {
+      for (i = 0; i < call->triangleCount; i++)
+      {
+         gl->indices[call->triangleOffset + i] = index;
+         *dst++ = call->triangleOffset + i;
+      }
+   }
+   // Same order as glnvg__convexFill(), all fans first and then the fringes.
+   if (fills)
+      for (i = 0; i < call->pathCount; i++)
+         dst = glnvg__fanElements (dst, gl->indices, paths[i].fillOffset, paths[i].fillCount, index);
+   if (strokes)
+      for (i = 0; i < call->pathCount; i++)
+         dst = glnvg__stripElements (dst, gl->indices, paths[i].strokeOffset, paths[i].strokeCount, index);
+   call->elementOffset = offset;
+   call->elementCount = count;
+   return 1;
+}
+
+// Merges runs of batchable calls which use the same texture and whose uniforms fit in one
+// uniform block range. Merged calls are drawn by the first call of the run and marked
+// as GLNVG_NONE. Returns 0 if the per vertex uniform indices could not be allocated.
+static int glnvg__batchCalls (GLNVGcontext * gl)
+{
+   GLNVGcall * batch = NULL;
+   int i, index;
+   gl->nelements = 0;
+   if (gl->nverts > gl->cindices)
+   {
+      float * indices = (float *)realloc (gl->indices, sizeof (float) * gl->cverts);
+      if (indices == NULL) return 0;
+      gl->indices = indices;
+      gl->cindices = gl->cverts;
+   }
+   memset (gl->indices, 0, sizeof (float) * gl->nverts);
+   for (i = 0; i < gl->ncalls; i++)
+   {
+      GLNVGcall * call = &gl->calls[i];
+      if (!glnvg__batchable (gl, call))
+      {
+         batch = NULL;
+         continue;
+      }
+      if (batch != NULL && batch->image == call->image &&
+            call->uniformOffset - batch->uniformOffset < gl->batchSize * gl->fragSize)
+         index = (call->uniformOffset - batch->uniformOffset) / gl->fragSize;
+      else
+      {
+         batch = call;
+         index = 0;
+      }
+      if (!glnvg__callElements (gl, call, (float)index))
+      {
+         // Out of memory, the call is drawn on its own.
+         batch = NULL;
+         continue;
+      }
+      if (batch != call)
+      {
+         batch->elementCount += call->elementCount;
+         call->type = GLNVG_NONE;
+      }
+   }
+   return 1;
+}
+
+static void glnvg__elements (GLNVGcontext * gl, GLNVGcall * call)
+{
+   glnvg__setUniforms (gl, call->uniformOffset, call->image);
+   glnvg__checkError (gl, "batch fill");
+   glDrawElements (GL_TRIANGLES, call->elementCount, GL_UNSIGNED_INT, (const GLvoid *) (size_t) (gl->elementBase + call->elementOffset * sizeof (GLuint)));
+   gl->stats.drawCalls++;
+}
+#endif
+
 static void glnvg__renderFlush (void * uptr)
 {
    GLNVGcontext * gl = (GLNVGcontext *)uptr;
    int i;
+#if NANOVG_GL_USE_BATCHING
+   int batched = 0;
+#endif
+   NVGL_PROFILE_ZONE ("glnvg__renderFlush");
+   gl->callsFlushed = gl->ncalls;
+   gl->batchesFlushed = gl->ncalls;
    if (gl->ncalls > 0)
    {
       // Setup require GL state.
@@ -1051,7 +1446,13 @@ static void glnvg__renderFlush (void * uptr)
       glFrontFace (GL_CCW);
       glEnable (GL_BLEND);
       glDisable (GL_DEPTH_TEST);
-      glDisable (GL_SCISSOR_TEST);
+      if (gl->clip)
+      {
+         glEnable (GL_SCISSOR_TEST);
+         glScissor (gl->clipRect[0], gl->clipRect[1], gl->clipRect[2], gl->clipRect[3]);
+      }
+      else
+         glDisable (GL_SCISSOR_TEST);
       glColorMask (GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
       glStencilMask (0xffffffff);
       glStencilOp (GL_KEEP, GL_KEEP, GL_KEEP);
@@ -1065,21 +1466,65 @@ static void glnvg__renderFlush (void * uptr)
       gl->stencilFuncRef = 0;
       gl->stencilFuncMask = 0xffffffff;
 #endif
+#if NANOVG_GL_USE_BATCHING
+      if (gl->flags & NVG_BATCH_CALLS)
+         batched = glnvg__batchCalls (gl);
+#endif
 #if NANOVG_GL_USE_UNIFORMBUFFER
-      // Upload ubo for frag shaders
+      // Upload ubo for frag shaders, with room for binding a whole batch at the last uniform.
       glBindBuffer (GL_UNIFORM_BUFFER, gl->fragBuf);
-      glBufferData (GL_UNIFORM_BUFFER, gl->nuniforms * gl->fragSize, gl->uniforms, GL_STREAM_DRAW);
+#if NANOVG_GL_USE_RING_BUFFER
+      if (gl->flags & NVG_RING_BUFFER)
+         gl->fragBase = glnvg__ringUpload (&gl->fragRing, GL_UNIFORM_BUFFER, gl->uniforms, gl->nuniforms * gl->fragSize,
+                                           (gl->nuniforms + gl->batchSize) * gl->fragSize, gl->fragSize);
+      else
+#endif
+      {
+         glBufferData (GL_UNIFORM_BUFFER, (gl->nuniforms + gl->batchSize) * gl->fragSize, NULL, GL_STREAM_DRAW);
+         glBufferSubData (GL_UNIFORM_BUFFER, 0, gl->nuniforms * gl->fragSize, gl->uniforms);
+      }
+      gl->stats.uniformBytes += gl->nuniforms * gl->fragSize;
 #endif
       // Upload vertex data
 #if defined NANOVG_GL3
       glBindVertexArray (gl->vertArr);
 #endif
       glBindBuffer (GL_ARRAY_BUFFER, gl->vertBuf);
-      glBufferData (GL_ARRAY_BUFFER, gl->nverts * sizeof (NVGvertex), gl->verts, GL_STREAM_DRAW);
+#if NANOVG_GL_USE_RING_BUFFER
+      if (gl->flags & NVG_RING_BUFFER)
+         gl->vertBase = glnvg__ringUpload (&gl->vertRing, GL_ARRAY_BUFFER, gl->verts, gl->nverts * sizeof (NVGvertex), gl->nverts * sizeof (NVGvertex), sizeof (NVGvertex));
+      else
+#endif
+         glBufferData (GL_ARRAY_BUFFER, gl->nverts * sizeof (NVGvertex), gl->verts, GL_STREAM_DRAW);
+      gl->stats.verts += gl->nverts;
       glEnableVertexAttribArray (0);
       glEnableVertexAttribArray (1);
-      glVertexAttribPointer (0, 2, GL_FLOAT, GL_FALSE, sizeof (NVGvertex), (const GLvoid *) (size_t)0);
-      glVertexAttribPointer (1, 2, GL_FLOAT, GL_FALSE, sizeof (NVGvertex), (const GLvoid *) (0 + 2 * sizeof (float)));
+      glVertexAttribPointer (0, 2, GL_FLOAT, GL_FALSE, sizeof (NVGvertex), (const GLvoid *) (size_t)gl->vertBase);
+      glVertexAttribPointer (1, 2, GL_FLOAT, GL_FALSE, sizeof (NVGvertex), (const GLvoid *) (size_t) (gl->vertBase + 2 * sizeof (float)));
+#if NANOVG_GL_USE_BATCHING
+      if (batched)
+      {
+         // Upload per vertex uniform indices and the triangle lists of the batches.
+         glBindBuffer (GL_ARRAY_BUFFER, gl->indexBuf);
+         glBindBuffer (GL_ELEMENT_ARRAY_BUFFER, gl->elementBuf);
+#if NANOVG_GL_USE_RING_BUFFER
+         if (gl->flags & NVG_RING_BUFFER)
+         {
+            gl->indexBase = glnvg__ringUpload (&gl->indexRing, GL_ARRAY_BUFFER, gl->indices, gl->nverts * sizeof (float), gl->nverts * sizeof (float), sizeof (float));
+            gl->elementBase = glnvg__ringUpload (&gl->elementRing, GL_ELEMENT_ARRAY_BUFFER, gl->elements, gl->nelements * sizeof (GLuint), gl->nelements * sizeof (GLuint), sizeof (GLuint));
+         }
+         else
+#endif
+         {
+            glBufferData (GL_ARRAY_BUFFER, gl->nverts * sizeof (float), gl->indices, GL_STREAM_DRAW);
+            glBufferData (GL_ELEMENT_ARRAY_BUFFER, gl->nelements * sizeof (GLuint), gl->elements, GL_STREAM_DRAW);
+         }
+         glEnableVertexAttribArray (2);
+         glVertexAttribPointer (2, 1, GL_FLOAT, GL_FALSE, sizeof (float), (const GLvoid *) (size_t)gl->indexBase);
+      }
+      else
+         glVertexAttrib1f (2, 0.0f);
+#endif
       // Set view and texture just once per frame.
       glUniform1i (gl->shader.loc[GLNVG_LOC_TEX], 0);
       glUniform2fv (gl->shader.loc[GLNVG_LOC_VIEWSIZE], 1, gl->view);
@@ -1089,6 +1534,18 @@ static void glnvg__renderFlush (void * uptr)
       for (i = 0; i < gl->ncalls; i++)
       {
          GLNVGcall * call = &gl->calls[i];
+#if NANOVG_GL_USE_BATCHING
+         if (call->type == GLNVG_NONE)
+         {
+            gl->batchesFlushed--;
+            continue;
+         }
+         if (batched && call->elementCount > 0)
+         {
+            glnvg__elements (gl, call);
+            continue;
+         }
+#endif
          if (call->type == GLNVG_FILL)
             glnvg__fill (gl, call);
          else
@@ -1101,12 +1558,32 @@ static void glnvg__renderFlush (void * uptr)
                   if (call->type == GLNVG_TRIANGLES)
                      glnvg__triangles (gl, call);
       }
+#if NANOVG_GL_USE_RING_BUFFER
+      if (gl->flags & NVG_RING_BUFFER)
+      {
+#if NANOVG_GL_USE_UNIFORMBUFFER
+         glnvg__ringFence (&gl->fragRing);
+#endif
+#if NANOVG_GL_USE_BATCHING
+         if (batched)
+         {
+            glnvg__ringFence (&gl->indexRing);
+            glnvg__ringFence (&gl->elementRing);
+         }
+#endif
+         glnvg__ringFence (&gl->vertRing);
+      }
+#endif
       glDisableVertexAttribArray (0);
       glDisableVertexAttribArray (1);
+#if NANOVG_GL_USE_BATCHING
+      glDisableVertexAttribArray (2);
+#endif
 #if defined NANOVG_GL3
       glBindVertexArray (0);
 #endif
       glDisable (GL_CULL_FACE);
+      glDisable (GL_SCISSOR_TEST);
       glBindBuffer (GL_ARRAY_BUFFER, 0);
       glUseProgram (0);
       glnvg__bindTexture (gl, 0);
@@ -1197,6 +1674,60 @@ static int glnvg__allocFragUniforms (GLNVGcontext * gl, int n)
    return ret;
 }
 
+// Sizes the per frame buffers for ncalls render calls with npaths paths and nverts vertices.
+// A fill adds up to 6 vertices for its cover quad and uses up to 2 uniform structs per call.
+static int glnvg__renderReserve (void * uptr, int ncalls, int npaths, int nverts)
+{
+   GLNVGcontext * gl = (GLNVGcontext *)uptr;
+   int cverts = nverts + ncalls * 6, cuniforms = ncalls * 2;
+   if (ncalls > gl->ccalls)
+   {
+      GLNVGcall * calls = (GLNVGcall *)realloc (gl->calls, sizeof (GLNVGcall) * ncalls);
+      if (calls == NULL) return 0;
+      gl->calls = calls;
+      gl->ccalls = ncalls;
+   }
+   if (npaths > gl->cpaths)
+   {
+      GLNVGpath * paths = (GLNVGpath *)realloc (gl->paths, sizeof (GLNVGpath) * npaths);
+      if (paths == NULL) return 0;
+      gl->paths = paths;
+      gl->cpaths = npaths;
+   }
+   if (cverts > gl->cverts)
+   {
+      NVGvertex * verts = (NVGvertex *)realloc (gl->verts, sizeof (NVGvertex) * cverts);
+      if (verts == NULL) return 0;
+      gl->verts = verts;
+      gl->cverts = cverts;
+   }
+   if (cuniforms > gl->cuniforms)
+   {
+      unsigned char * uniforms = (unsigned char *)realloc (gl->uniforms, gl->fragSize * cuniforms);
+      if (uniforms == NULL) return 0;
+      gl->uniforms = uniforms;
+      gl->cuniforms = cuniforms;
+   }
+#if NANOVG_GL_USE_BATCHING
+   if (cverts > gl->cindices)
+   {
+      float * indices = (float *)realloc (gl->indices, sizeof (float) * cverts);
+      if (indices == NULL) return 0;
+      gl->indices = indices;
+      gl->cindices = cverts;
+   }
+   // Fans and strips index at most 3 vertices per vertex.
+   if (cverts * 3 > gl->celements)
+   {
+      GLuint * elements = (GLuint *)realloc (gl->elements, sizeof (GLuint) * cverts * 3);
+      if (elements == NULL) return 0;
+      gl->elements = elements;
+      gl->celements = cverts * 3;
+   }
+#endif
+   return 1;
+}
+
 static GLNVGfragUniforms * nvg__fragUniformPtr (GLNVGcontext * gl, int i)
 {
    return (GLNVGfragUniforms *)&gl->uniforms[i];
@@ -1225,7 +1756,12 @@ static void glnvg__renderFill (void * uptr, NVGpaint * paint, NVGscissor * sciss
    call->pathCount = npaths;
    call->image = paint->image;
    if (npaths == 1 && paths[0].convex)
+   {
       call->type = GLNVG_CONVEXFILL;
+      gl->stats.convexFills++;
+   }
+   else
+      gl->stats.stencilFills++;
    // Allocate vertices for all the paths.
    maxverts = glnvg__maxVertCount (paths, npaths) + 6;
    offset = glnvg__allocVerts (gl, maxverts);
@@ -1297,6 +1833,10 @@ static void glnvg__renderStroke (void * uptr, NVGpaint * paint, NVGscissor * sci
    call->type = GLNVG_STROKE;
    call->pathOffset = glnvg__allocPaths (gl, npaths);
    if (call->pathOffset == -1) goto error;
+   if (gl->flags & NVG_STENCIL_STROKES)
+      gl->stats.stencilStrokes++;
+   else
+      gl->stats.strokes++;
    call->pathCount = npaths;
    call->image = paint->image;
    // Allocate vertices for all the paths.
@@ -1347,6 +1887,7 @@ static void glnvg__renderTriangles (void * uptr, NVGpaint * paint, NVGscissor *
    if (call == NULL) return;
    call->type = GLNVG_TRIANGLES;
    call->image = paint->image;
+   gl->stats.triangles++;
    // Allocate vertices for all the paths.
    call->triangleOffset = glnvg__allocVerts (gl, nverts);
    if (call->triangleOffset == -1) goto error;
@@ -1371,6 +1912,14 @@ static void glnvg__renderDelete (void * uptr)
    int i;
    if (gl == NULL) return;
    glnvg__deleteShader (&gl->shader);
+#if NANOVG_GL_USE_RING_BUFFER
+   glnvg__ringDelete (&gl->vertRing);
+   glnvg__ringDelete (&gl->fragRing);
+#if NANOVG_GL_USE_BATCHING
+   glnvg__ringDelete (&gl->indexRing);
+   glnvg__ringDelete (&gl->elementRing);
+#endif
+#endif
 #if NANOVG_GL3
 #if NANOVG_GL_USE_UNIFORMBUFFER
    if (gl->fragBuf != 0)
@@ -1381,6 +1930,14 @@ static void glnvg__renderDelete (void * uptr)
 #endif
    if (gl->vertBuf != 0)
       glDeleteBuffers (1, &gl->vertBuf);
+#if NANOVG_GL_USE_BATCHING
+   if (gl->indexBuf != 0)
+      glDeleteBuffers (1, &gl->indexBuf);
+   if (gl->elementBuf != 0)
+      glDeleteBuffers (1, &gl->elementBuf);
+   free (gl->indices);
+   free (gl->elements);
+#endif
    for (i = 0; i < gl->ntextures; i++)
    {
       if (gl->textures[i].tex != 0 && (gl->textures[i].flags & NVG_IMAGE_NODELETE) == 0)
@@ -1423,6 +1980,8 @@ static void glnvg__renderDelete (void * uptr)
    params.renderStroke = glnvg__renderStroke;
    params.renderTriangles = glnvg__renderTriangles;
    params.renderDelete = glnvg__renderDelete;
+   params.renderReserve = glnvg__renderReserve;
+   params.renderFrameStats = glnvg__renderFrameStats;
    params.userPtr = gl;
    params.edgeAntiAlias = flags & NVG_ANTIALIAS ? 1 : 0;
    gl->flags = flags;
@@ -1468,4 +2027,27 @@ GLuint nvglImageHandle (NVGcontext * ctx, int image)
    return tex->tex;
 }
 
+void nvglClipRect (NVGcontext * ctx, int x, int y, int w, int h)
+{
+   GLNVGcontext * gl = (GLNVGcontext *)nvgInternalParams (ctx)->userPtr;
+   gl->clip = 1;
+   gl->clipRect[0] = x;
+   gl->clipRect[1] = y;
+   gl->clipRect[2] = glnvg__maxi (w, 0);
+   gl->clipRect[3] = glnvg__maxi (h, 0);
+}
+
+void nvglResetClipRect (NVGcontext * ctx)
+{
+   GLNVGcontext * gl = (GLNVGcontext *)nvgInternalParams (ctx)->userPtr;
+   gl->clip = 0;
+}
+
+void nvglBatchStats (NVGcontext * ctx, int * calls, int * batches)
+{
+   GLNVGcontext * gl = (GLNVGcontext *)nvgInternalParams (ctx)->userPtr;
+   if (calls != NULL) *calls = gl->callsFlushed;
+   if (batches != NULL) *batches = gl->batchesFlushed;
+}
+
 #endif /* NANOVG_GL_IMPLEMENTATION */
@@ -0,0 +1,902 @@
+//
+// Copyright (c) 2009-2013 Mikko Mononen memon@inside.org
+//
+// This software is provided 'as-is', without any express or implied
+// warranty.  In no event will the authors be held liable for any damages
+// arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+//
+#ifndef NANOVG_SW_H
+#define NANOVG_SW_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Software (CPU) render back-end. Draws into an RGBA8 buffer of the given size
+// without touching OpenGL, so it can be used on machines without a GPU.
+// Edges are anti-aliased by computing exact area coverage per pixel, the paint
+// and scissor model is the same as the one used by the GL back-end.
+
+NVGcontext * nvgCreateSW (int width, int height);
+void nvgDeleteSW (NVGcontext * ctx);
+
+// Returns the pixel buffer of the context. Pixels are premultiplied RGBA8,
+// rows are stored top to bottom with a stride of width * 4 bytes.
+unsigned char * nvgswPixels (NVGcontext * ctx, int * width, int * height);
+
+// Fills the whole pixel buffer with color (the glClear() equivalent).
+void nvgswClear (NVGcontext * ctx, NVGcolor color);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NANOVG_SW_H */
+
+#ifdef NANOVG_SW_IMPLEMENTATION
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "nanovg.h"
+
+enum SWNVGshaderType
+{
+   SWNVG_SHADER_FILLGRAD,
+   SWNVG_SHADER_FILLIMG,
+   SWNVG_SHADER_IMG
+};
+
+struct SWNVGtexture
+{
+   int id;
+   unsigned char * data;
+   int width, height;
+   int type;
+   int flags;
+};
+typedef struct SWNVGtexture SWNVGtexture;
+
+// CPU counterpart of GLNVGfragUniforms.
+struct SWNVGpaint
+{
+   float scissorMat[6];
+   float paintMat[6];
+   NVGcolor innerCol;
+   NVGcolor outerCol;
+   float scissorExt[2];
+   float scissorScale[2];
+   float extent[2];
+   float radius;
+   float feather;
+   int texType;
+   int type;
+   int solid;
+   int scissor;
+   SWNVGtexture * tex;
+};
+typedef struct SWNVGpaint SWNVGpaint;
+
+struct SWNVGcontext
+{
+   SWNVGtexture * textures;
+   float view[2];
+   int ntextures;
+   int ctextures;
+   int textureId;
+
+   // Target buffer
+   unsigned char * pixels;
+   int width;
+   int height;
+
+   // Coverage accumulation buffer, reused between draw calls.
+   float * cover;
+   int ccover;
+   int coverX, coverY, coverW, coverH;
+
+   // Counters since the last swnvg__renderFrameStats(), fills are classified as the GL
+   // back-end would draw them. Draw calls are the calls which covered any pixels. There is
+   // no stencil buffer, uniform upload or texture binding, so stencilStrokes, uniformBytes
+   // and textureBinds stay 0.
+   NVGframeStats stats;
+};
+typedef struct SWNVGcontext SWNVGcontext;
+
+static int swnvg__maxi (int a, int b)
+{
+   return a > b ? a : b;
+}
+
+static int swnvg__mini (int a, int b)
+{
+   return a < b ? a : b;
+}
+
+static float swnvg__clampf (float a, float mn, float mx)
+{
+   return a < mn ? mn : (a > mx ? mx : a);
+}
+
+static SWNVGtexture * swnvg__allocTexture (SWNVGcontext * sw)
+{
+   SWNVGtexture * tex = NULL;
+   int i;
+   for (i = 0; i < sw->ntextures; i++)
+   {
+      if (sw->textures[i].id == 0)
+      {
+         tex = &sw->textures[i];
+         break;
+      }
+   }
+   if (tex == NULL)
+   {
+      if (sw->ntextures + 1 > sw->ctextures)
+      {
+         SWNVGtexture * textures;
+         int ctextures = swnvg__maxi (sw->ntextures + 1, 4) +  sw->ctextures / 2; // 1.5x Overallocate
+         textures = (SWNVGtexture *)realloc (sw->textures, sizeof (SWNVGtexture) * ctextures);
+         if (textures == NULL) return NULL;
+         sw->textures = textures;
+         sw->ctextures = ctextures;
+      }
+      tex = &sw->textures[sw->ntextures++];
+   }
+   memset (tex, 0, sizeof (*tex));
+   tex->id = ++sw->textureId;
+   return tex;
+}
+
+static SWNVGtexture * swnvg__findTexture (SWNVGcontext * sw, int id)
+{
+   int i;
+   for (i = 0; i < sw->ntextures; i++)
+      if (sw->textures[i].id == id)
+         return &sw->textures[i];
+   return NULL;
+}
+
+static int swnvg__renderCreate (void * uptr)
+{
+   NVG_NOTUSED (uptr);
+   return 1;
+}
+
+static int swnvg__renderCreateTexture (void * uptr, int type, int w, int h, int imageFlags, const unsigned char * data)
+{
+   SWNVGcontext * sw = (SWNVGcontext *)uptr;
+   SWNVGtexture * tex = swnvg__allocTexture (sw);
+   int bpp = type == NVG_TEXTURE_RGBA ? 4 : 1;
+   if (tex == NULL) return 0;
+   tex->data = (unsigned char *)malloc (w * h * bpp);
+   if (tex->data == NULL)
+   {
+      memset (tex, 0, sizeof (*tex));
+      return 0;
+   }
+   if (data != NULL)
+      memcpy (tex->data, data, w * h * bpp);
+   else
+      memset (tex->data, 0, w * h * bpp);
+   tex->width = w;
+   tex->height = h;
+   tex->type = type;
+   tex->flags = imageFlags;
+   return tex->id;
+}
+
+static int swnvg__renderDeleteTexture (void * uptr, int image)
+{
+   SWNVGcontext * sw = (SWNVGcontext *)uptr;
+   SWNVGtexture * tex = swnvg__findTexture (sw, image);
+   if (tex == NULL) return 0;
+   free (tex->data);
+   memset (tex, 0, sizeof (*tex));
+   return 1;
+}
+
+static int swnvg__renderUpdateTexture (void * uptr, int image, int x, int y, int w, int h, const unsigned char * data)
+{
+   SWNVGcontext * sw = (SWNVGcontext *)uptr;
+   SWNVGtexture * tex = swnvg__findTexture (sw, image);
+   int i, bpp;
+   if (tex == NULL) return 0;
+   // Same layout as the GL upload: data points to the whole image, x,y,w,h is the dirty region.
+   bpp = tex->type == NVG_TEXTURE_RGBA ? 4 : 1;
+   for (i = y; i < y + h; i++)
+      memcpy (&tex->data[ (i * tex->width + x) * bpp], &data[ (i * tex->width + x) * bpp], w * bpp);
+   return 1;
+}
+
+static int swnvg__renderGetTextureSize (void * uptr, int image, int * w, int * h)
+{
+   SWNVGcontext * sw = (SWNVGcontext *)uptr;
+   SWNVGtexture * tex = swnvg__findTexture (sw, image);
+   if (tex == NULL) return 0;
+   *w = tex->width;
+   *h = tex->height;
+   return 1;
+}
+
+static void swnvg__renderViewport (void * uptr, int width, int height)
+{
+   SWNVGcontext * sw = (SWNVGcontext *)uptr;
+   sw->view[0] = (float)width;
+   sw->view[1] = (float)height;
+}
+
+static NVGcolor swnvg__premulColor (NVGcolor c)
+{
+   c.r *= c.a;
+   c.g *= c.a;
+   c.b *= c.a;
+   return c;
+}
+
+static int swnvg__convertPaint (SWNVGcontext * sw, SWNVGpaint * frag, NVGpaint * paint,
+                                NVGscissor * scissor, float fringe)
+{
+   float invxform[6];
+   memset (frag, 0, sizeof (*frag));
+   frag->innerCol = swnvg__premulColor (paint->innerColor);
+   frag->outerCol = swnvg__premulColor (paint->outerColor);
+   if (scissor->extent[0] < -0.5f || scissor->extent[1] < -0.5f)
+   {
+      frag->scissor = 0;
+      frag->scissorExt[0] = 1.0f;
+      frag->scissorExt[1] = 1.0f;
+      frag->scissorScale[0] = 1.0f;
+      frag->scissorScale[1] = 1.0f;
+   }
+   else
+   {
+      frag->scissor = 1;
+      nvgTransformInverse (frag->scissorMat, scissor->xform);
+      frag->scissorExt[0] = scissor->extent[0];
+      frag->scissorExt[1] = scissor->extent[1];
+      frag->scissorScale[0] = sqrtf (scissor->xform[0] * scissor->xform[0] + scissor->xform[2] * scissor->xform[2]) / fringe;
+      frag->scissorScale[1] = sqrtf (scissor->xform[1] * scissor->xform[1] + scissor->xform[3] * scissor->xform[3]) / fringe;
+   }
+   memcpy (frag->extent, paint->extent, sizeof (frag->extent));
+   if (paint->image != 0)
+   {
+      frag->tex = swnvg__findTexture (sw, paint->image);
+      if (frag->tex == NULL) return 0;
+      if ((frag->tex->flags & NVG_IMAGE_FLIPY) != 0)
+      {
+         float flipped[6];
+         nvgTransformScale (flipped, 1.0f, -1.0f);
+         nvgTransformMultiply (flipped, paint->xform);
+         nvgTransformInverse (invxform, flipped);
+      }
+      else
+         nvgTransformInverse (invxform, paint->xform);
+      frag->type = SWNVG_SHADER_FILLIMG;
+      if (frag->tex->type == NVG_TEXTURE_RGBA)
+         frag->texType = (frag->tex->flags & NVG_IMAGE_PREMULTIPLIED) ? 0 : 1;
+      else
+         if (frag->tex->flags & NVG_IMAGE_SDF)
+         {
+            frag->texType = 3;
+            frag->feather = paint->feather > 0.0f ? paint->feather : 0.5f / 255.0f;
+         }
+         else
+            frag->texType = 2;
+   }
+   else
+   {
+      frag->type = SWNVG_SHADER_FILLGRAD;
+      frag->radius = paint->radius;
+      frag->feather = paint->feather;
+      nvgTransformInverse (invxform, paint->xform);
+      frag->solid = memcmp (&frag->innerCol, &frag->outerCol, sizeof (NVGcolor)) == 0;
+   }
+   memcpy (frag->paintMat, invxform, sizeof (invxform));
+   return 1;
+}
+
+static float swnvg__sdroundrect (float px, float py, float ex, float ey, float rad)
+{
+   float dx = fabsf (px) - (ex - rad);
+   float dy = fabsf (py) - (ey - rad);
+   float mx = dx > 0.0f ? dx : 0.0f;
+   float my = dy > 0.0f ? dy : 0.0f;
+   float inside = dx > dy ? dx : dy;
+   return (inside < 0.0f ? inside : 0.0f) + sqrtf (mx * mx + my * my) - rad;
+}
+
+static float swnvg__scissorMask (SWNVGpaint * frag, float x, float y)
+{
+   float sx, sy;
+   if (!frag->scissor) return 1.0f;
+   nvgTransformPoint (&sx, &sy, frag->scissorMat, x, y);
+   sx = 0.5f - (fabsf (sx) - frag->scissorExt[0]) * frag->scissorScale[0];
+   sy = 0.5f - (fabsf (sy) - frag->scissorExt[1]) * frag->scissorScale[1];
+   return swnvg__clampf (sx, 0.0f, 1.0f) * swnvg__clampf (sy, 0.0f, 1.0f);
+}
+
+static int swnvg__wrap (int i, int n, int repeat)
+{
+   if (repeat)
+   {
+      i %= n;
+      return i < 0 ? i + n : i;
+   }
+   return i < 0 ? 0 : (i >= n ? n - 1 : i);
+}
+
+// Bilinear texture fetch with the GL_LINEAR sampling rules, returns premultiplied color.
+static void swnvg__sampleTexture (SWNVGpaint * frag, float u, float v, float * out)
+{
+   SWNVGtexture * tex = frag->tex;
+   float fx = u * tex->width - 0.5f;
+   float fy = v * tex->height - 0.5f;
+   float x0f = floorf (fx);
+   float y0f = floorf (fy);
+   float tx = fx - x0f, ty = fy - y0f;
+   int repx = (tex->flags & NVG_IMAGE_REPEATX) != 0;
+   int repy = (tex->flags & NVG_IMAGE_REPEATY) != 0;
+   int x0 = swnvg__wrap ((int)x0f, tex->width, repx);
+   int x1 = swnvg__wrap ((int)x0f + 1, tex->width, repx);
+   int y0 = swnvg__wrap ((int)y0f, tex->height, repy);
+   int y1 = swnvg__wrap ((int)y0f + 1, tex->height, repy);
+   float w00 = (1.0f - tx) * (1.0f - ty), w10 = tx * (1.0f - ty);
+   float w01 = (1.0f - tx) * ty, w11 = tx * ty;
+   int c;
+   if (tex->type == NVG_TEXTURE_RGBA)
+   {
+      const unsigned char * p00 = &tex->data[ (y0 * tex->width + x0) * 4];
+      const unsigned char * p10 = &tex->data[ (y0 * tex->width + x1) * 4];
+      const unsigned char * p01 = &tex->data[ (y1 * tex->width + x0) * 4];
+      const unsigned char * p11 = &tex->data[ (y1 * tex->width + x1) * 4];
+      for (c = 0; c < 4; c++)
+         out[c] = (p00[c] * w00 + p10[c] * w10 + p01[c] * w01 + p11[c] * w11) * (1.0f / 255.0f);
+      if (frag->texType == 1)
+      {
+         out[0] *= out[3];
+         out[1] *= out[3];
+         out[2] *= out[3];
+      }
+   }
+   else
+   {
+      float a = (tex->data[y0 * tex->width + x0] * w00 + tex->data[y0 * tex->width + x1] * w10 +
+                 tex->data[y1 * tex->width + x0] * w01 + tex->data[y1 * tex->width + x1] * w11) * (1.0f / 255.0f);
+      if (frag->texType == 3)
+      {
+         // smoothstep(0.5 - feather, 0.5 + feather, a)
+         a = swnvg__clampf ((a - 0.5f + frag->feather) / (2.0f * frag->feather), 0.0f, 1.0f);
+         a = a * a * (3.0f - 2.0f * a);
+      }
+      out[0] = out[1] = out[2] = out[3] = a;
+   }
+}
+
+// Evaluates the paint at (x,y) in view coordinates, same math as the GL fragment shader.
+static void swnvg__shade (SWNVGpaint * frag, float x, float y, float * out)
+{
+   float px, py;
+   if (frag->type == SWNVG_SHADER_FILLGRAD)
+   {
+      float d;
+      if (frag->solid)
+      {
+         memcpy (out, frag->innerCol.rgba, sizeof (float) * 4);
+         return;
+      }
+      nvgTransformPoint (&px, &py, frag->paintMat, x, y);
+      d = swnvg__clampf ((swnvg__sdroundrect (px, py, frag->extent[0], frag->extent[1], frag->radius) + frag->feather * 0.5f) / frag->feather, 0.0f, 1.0f);
+      out[0] = frag->innerCol.r + (frag->outerCol.r - frag->innerCol.r) * d;
+      out[1] = frag->innerCol.g + (frag->outerCol.g - frag->innerCol.g) * d;
+      out[2] = frag->innerCol.b + (frag->outerCol.b - frag->innerCol.b) * d;
+      out[3] = frag->innerCol.a + (frag->outerCol.a - frag->innerCol.a) * d;
+   }
+   else
+   {
+      nvgTransformPoint (&px, &py, frag->paintMat, x, y);
+      swnvg__sampleTexture (frag, px / frag->extent[0], py / frag->extent[1], out);
+      out[0] *= frag->innerCol.r;
+      out[1] *= frag->innerCol.g;
+      out[2] *= frag->innerCol.b;
+      out[3] *= frag->innerCol.a;
+   }
+}
+
+// Premultiplied source-over, the equivalent of glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA).
+static void swnvg__blend (unsigned char * dst, const float * src, float alpha)
+{
+   float ia = 1.0f - src[3] * alpha;
+   int c;
+   for (c = 0; c < 4; c++)
+   {
+      float v = src[c] * alpha * 255.0f + dst[c] * ia;
+      dst[c] = (unsigned char) (v > 255.0f ? 255 : (int) (v + 0.5f));
+   }
+}
+
+// Computes pixel bounds of the draw from the vertex bounds, clipped to the target and
+// to the scissor rectangle.
+static int swnvg__beginCover (SWNVGcontext * sw, SWNVGpaint * frag, float minx, float miny, float maxx, float maxy)
+{
+   float sx = sw->width / sw->view[0];
+   float sy = sw->height / sw->view[1];
+   int x0, y0, x1, y1, n;
+   if (frag->scissor)
+   {
+      // Scissor is a transformed rect, clip against its axis aligned bounds (+1px for the soft edge).
+      float inv[6], ex, ey, cx, cy;
+      nvgTransformInverse (inv, frag->scissorMat);
+      ex = fabsf (inv[0] * frag->scissorExt[0]) + fabsf (inv[2] * frag->scissorExt[1]) + 1.0f;
+      ey = fabsf (inv[1] * frag->scissorExt[0]) + fabsf (inv[3] * frag->scissorExt[1]) + 1.0f;
+      cx = inv[4];
+      cy = inv[5];
+      if (minx < cx - ex) minx = cx - ex;
+      if (miny < cy - ey) miny = cy - ey;
+      if (maxx > cx + ex) maxx = cx + ex;
+      if (maxy > cy + ey) maxy = cy + ey;
+   }
+   x0 = swnvg__maxi ((int)floorf (minx * sx), 0);
+   y0 = swnvg__maxi ((int)floorf (miny * sy), 0);
+   x1 = swnvg__mini ((int)ceilf (maxx * sx), sw->width);
+   y1 = swnvg__mini ((int)ceilf (maxy * sy), sw->height);
+   if (x0 >= x1 || y0 >= y1) return 0;
+   sw->coverX = x0;
+   sw->coverY = y0;
+   sw->coverW = x1 - x0;
+   sw->coverH = y1 - y0;
+   // Two extra columns so the accumulation never writes out of the row.
+   n = (sw->coverW + 2) * sw->coverH;
+   if (n > sw->ccover)
+   {
+      float * cover;
+      int ccover = swnvg__maxi (n, 4096) + sw->ccover / 2; // 1.5x Overallocate
+      cover = (float *)realloc (sw->cover, sizeof (float) * ccover);
+      if (cover == NULL) return 0;
+      sw->cover = cover;
+      sw->ccover = ccover;
+   }
+   memset (sw->cover, 0, sizeof (float) * n);
+   return 1;
+}
+
+// Accumulates the signed area of a line segment into the coverage buffer.
+// Coordinates are in pixels relative to the cover rect, x within [0,coverW].
+static void swnvg__accumLine (SWNVGcontext * sw, float x0, float y0, float x1, float y1)
+{
+   int stride = sw->coverW + 2;
+   float w = (float)sw->coverW;
+   float dir, dxdy, x, t;
+   int y, ystart, yend;
+   if (y0 == y1) return;
+   dir = 1.0f;
+   if (y0 > y1)
+   {
+      dir = -1.0f;
+      t = x0;
+      x0 = x1;
+      x1 = t;
+      t = y0;
+      y0 = y1;
+      y1 = t;
+   }
+   dxdy = (x1 - x0) / (y1 - y0);
+   x = x0;
+   if (y0 < 0.0f)
+      x = swnvg__clampf (x - y0 * dxdy, 0.0f, w);
+   ystart = swnvg__maxi ((int)floorf (y0), 0);
+   yend = swnvg__mini ((int)ceilf (y1), sw->coverH);
+   for (y = ystart; y < yend; y++)
+   {
+      float * row = &sw->cover[y * stride];
+      float dy = ((float) (y + 1) < y1 ? (float) (y + 1) : y1) - ((float)y > y0 ? (float)y : y0);
+      float xnext = swnvg__clampf (x + dxdy * dy, 0.0f, w);
+      float d = dy * dir;
+      float xa = x < xnext ? x : xnext;
+      float xb = x < xnext ? xnext : x;
+      float xafloor = floorf (xa);
+      int xai = (int)xafloor;
+      int xbi = (int)ceilf (xb);
+      if (xbi <= xai + 1)
+      {
+         // Segment stays within one pixel column.
+         float xmf = 0.5f * (x + xnext) - xafloor;
+         row[xai] += d - d * xmf;
+         row[xai + 1] += d * xmf;
+      }
+      else
+      {
+         float s = 1.0f / (xb - xa);
+         float xaf = xa - xafloor;
+         float a0 = 0.5f * s * (1.0f - xaf) * (1.0f - xaf);
+         float xbf = xb - (float)xbi + 1.0f;
+         float am = 0.5f * s * xbf * xbf;
+         int xi;
+         row[xai] += d * a0;
+         if (xbi == xai + 2)
+            row[xai + 1] += d * (1.0f - a0 - am);
+         else
+         {
+            float a1 = s * (1.5f - xaf);
+            float a2 = a1 + (float) (xbi - xai - 3) * s;
+            row[xai + 1] += d * (a1 - a0);
+            for (xi = xai + 2; xi < xbi - 1; xi++)
+               row[xi] += d * s;
+            row[xbi - 1] += d * (1.0f - a2 - am);
+         }
+         row[xbi] += d * am;
+      }
+      x = xnext;
+   }
+}
+
+// Adds an edge in view coordinates. Parts left of the cover rect are projected onto
+// its left border, parts right of it cannot affect visible pixels and are dropped.
+static void swnvg__addEdge (SWNVGcontext * sw, float x0, float y0, float x1, float y1)
+{
+   float sx = sw->width / sw->view[0];
+   float sy = sw->height / sw->view[1];
+   float w = (float)sw->coverW;
+   float t, xm, ym;
+   x0 = x0 * sx - sw->coverX;
+   y0 = y0 * sy - sw->coverY;
+   x1 = x1 * sx - sw->coverX;
+   y1 = y1 * sy - sw->coverY;
+   if (y0 == y1) return;
+   if ((y0 <= 0.0f && y1 <= 0.0f) || (y0 >= sw->coverH && y1 >= sw->coverH)) return;
+   if (x0 >= w && x1 >= w) return;
+   if (x0 <= 0.0f && x1 <= 0.0f)
+   {
+      swnvg__accumLine (sw, 0.0f, y0, 0.0f, y1);
+      return;
+   }
+   if ((x0 < 0.0f) != (x1 < 0.0f))
+   {
+      t = (0.0f - x0) / (x1 - x0);
+      ym = y0 + (y1 - y0) * t;
+      if (x0 < 0.0f)
+      {
+         swnvg__accumLine (sw, 0.0f, y0, 0.0f, ym);
+         x0 = 0.0f;
+         y0 = ym;
+      }
+      else
+      {
+         swnvg__accumLine (sw, 0.0f, ym, 0.0f, y1);
+         x1 = 0.0f;
+         y1 = ym;
+      }
+   }
+   if ((x0 > w) != (x1 > w))
+   {
+      t = (w - x0) / (x1 - x0);
+      ym = y0 + (y1 - y0) * t;
+      xm = w;
+      if (x0 > w)
+      {
+         x0 = xm;
+         y0 = ym;
+      }
+      else
+      {
+         x1 = xm;
+         y1 = ym;
+      }
+   }
+   swnvg__accumLine (sw, x0, y0, x1, y1);
+}
+
+// Resolves the accumulated coverage (non-zero winding) and blends the paint into the target.
+static void swnvg__endCover (SWNVGcontext * sw, SWNVGpaint * frag)
+{
+   int stride = sw->coverW + 2;
+   float sx = sw->view[0] / sw->width;
+   float sy = sw->view[1] / sw->height;
+   float color[4];
+   int x, y;
+   if (frag->solid)
+      swnvg__shade (frag, 0.0f, 0.0f, color);
+   for (y = 0; y < sw->coverH; y++)
+   {
+      const float * row = &sw->cover[y * stride];
+      unsigned char * dst = &sw->pixels[ ((sw->coverY + y) * sw->width + sw->coverX) * 4];
+      float fy = (sw->coverY + y + 0.5f) * sy;
+      float acc = 0.0f;
+      for (x = 0; x < sw->coverW; x++, dst += 4)
+      {
+         float fx, alpha;
+         acc += row[x];
+         alpha = fabsf (acc);
+         if (alpha < 1.0f / 512.0f) continue;
+         if (alpha > 1.0f) alpha = 1.0f;
+         fx = (sw->coverX + x + 0.5f) * sx;
+         alpha *= swnvg__scissorMask (frag, fx, fy);
+         if (alpha <= 0.0f) continue;
+         if (!frag->solid)
+            swnvg__shade (frag, fx, fy, color);
+         swnvg__blend (dst, color, alpha);
+      }
+   }
+}
+
+static void swnvg__vertBounds (const NVGvertex * verts, int nverts, float * bounds)
+{
+   int i;
+   for (i = 0; i < nverts; i++)
+   {
+      if (verts[i].x < bounds[0]) bounds[0] = verts[i].x;
+      if (verts[i].y < bounds[1]) bounds[1] = verts[i].y;
+      if (verts[i].x > bounds[2]) bounds[2] = verts[i].x;
+      if (verts[i].y > bounds[3]) bounds[3] = verts[i].y;
+   }
+}
+
+static void swnvg__renderCancel (void * uptr)
+{
+   // Calls are rasterized immediately, there is nothing queued to drop.
+   NVG_NOTUSED (uptr);
+}
+
+static void swnvg__renderFlush (void * uptr)
+{
+   NVG_NOTUSED (uptr);
+}
+
+static void swnvg__renderFrameStats (void * uptr, NVGframeStats * stats)
+{
+   SWNVGcontext * sw = (SWNVGcontext *)uptr;
+   stats->drawCalls += sw->stats.drawCalls;
+   stats->convexFills += sw->stats.convexFills;
+   stats->stencilFills += sw->stats.stencilFills;
+   stats->strokes += sw->stats.strokes;
+   stats->triangles += sw->stats.triangles;
+   stats->verts += sw->stats.verts;
+   memset (&sw->stats, 0, sizeof (sw->stats));
+}
+
+static void swnvg__renderFill (void * uptr, NVGpaint * paint, NVGscissor * scissor, float fringe,
+                               const float * bounds, const NVGpath * paths, int npaths)
+{
+   SWNVGcontext * sw = (SWNVGcontext *)uptr;
+   SWNVGpaint frag;
+   int i, j;
+   if (npaths == 1 && paths[0].convex)
+      sw->stats.convexFills++;
+   else
+      sw->stats.stencilFills++;
+   if (swnvg__convertPaint (sw, &frag, paint, scissor, fringe) == 0) return;
+   if (swnvg__beginCover (sw, &frag, bounds[0], bounds[1], bounds[2], bounds[3]) == 0) return;
+   sw->stats.drawCalls++;
+   for (i = 0; i < npaths; i++)
+      sw->stats.verts += paths[i].nfill + paths[i].nstroke;
+   // The fill vertices of each path are its flattened outline, winding of holes is
+   // reversed by nanovg so accumulating all of them gives the non-zero fill rule.
+   for (i = 0; i < npaths; i++)
+   {
+      const NVGvertex * verts = paths[i].fill;
+      int n = paths[i].nfill;
+      for (j = 0; j < n; j++)
+      {
+         const NVGvertex * a = &verts[j];
+         const NVGvertex * b = &verts[ (j + 1) % n];
+         swnvg__addEdge (sw, a->x, a->y, b->x, b->y);
+      }
+   }
+   swnvg__endCover (sw, &frag);
+}
+
+static void swnvg__renderStroke (void * uptr, NVGpaint * paint, NVGscissor * scissor, float fringe,
+                                 float strokeWidth, const NVGpath * paths, int npaths)
+{
+   SWNVGcontext * sw = (SWNVGcontext *)uptr;
+   SWNVGpaint frag;
+   float bounds[4] = { 1e6f, 1e6f, -1e6f, -1e6f };
+   int i, j;
+   NVG_NOTUSED (strokeWidth);
+   sw->stats.strokes++;
+   if (swnvg__convertPaint (sw, &frag, paint, scissor, fringe) == 0) return;
+   for (i = 0; i < npaths; i++)
+      swnvg__vertBounds (paths[i].stroke, paths[i].nstroke, bounds);
+   if (swnvg__beginCover (sw, &frag, bounds[0], bounds[1], bounds[2], bounds[3]) == 0) return;
+   sw->stats.drawCalls++;
+   for (i = 0; i < npaths; i++)
+      sw->stats.verts += paths[i].nstroke;
+   // Strokes are triangle strips, every triangle is added with the same orientation
+   // so overlapping parts saturate instead of blending twice (like NVG_STENCIL_STROKES).
+   for (i = 0; i < npaths; i++)
+   {
+      const NVGvertex * v = paths[i].stroke;
+      for (j = 0; j + 2 < paths[i].nstroke; j++)
+      {
+         const NVGvertex * a = &v[j];
+         const NVGvertex * b = &v[j + 1];
+         const NVGvertex * c = &v[j + 2];
+         float area = (b->x - a->x) * (c->y - a->y) - (c->x - a->x) * (b->y - a->y);
+         if (area == 0.0f) continue;
+         if (area < 0.0f)
+         {
+            const NVGvertex * t = b;
+            b = c;
+            c = t;
+         }
+         swnvg__addEdge (sw, a->x, a->y, b->x, b->y);
+         swnvg__addEdge (sw, b->x, b->y, c->x, c->y);
+         swnvg__addEdge (sw, c->x, c->y, a->x, a->y);
+      }
+   }
+   swnvg__endCover (sw, &frag);
+}
+
+// Rasterizes a textured triangle with the GL pixel center and top-left rules, triangles
+// are only used for text and glyph quads are already anti-aliased by the atlas.
+static void swnvg__triangle (SWNVGcontext * sw, SWNVGpaint * frag, const NVGvertex * va, const NVGvertex * vb, const NVGvertex * vc)
+{
+   float sx = sw->width / sw->view[0];
+   float sy = sw->height / sw->view[1];
+   float ax = va->x * sx, ay = va->y * sy;
+   float bx = vb->x * sx, by = vb->y * sy;
+   float cx = vc->x * sx, cy = vc->y * sy;
+   float area = (bx - ax) * (cy - ay) - (cx - ax) * (by - ay);
+   float color[4];
+   int x, y, x0, y0, x1, y1;
+   if (area == 0.0f) return;
+   if (area < 0.0f)
+   {
+      const NVGvertex * t = vb;
+      float tx = bx, ty = by;
+      vb = vc;
+      bx = cx;
+      by = cy;
+      vc = t;
+      cx = tx;
+      cy = ty;
+      area = -area;
+   }
+   x0 = swnvg__maxi ((int)floorf (fminf (ax, fminf (bx, cx))), 0);
+   y0 = swnvg__maxi ((int)floorf (fminf (ay, fminf (by, cy))), 0);
+   x1 = swnvg__mini ((int)ceilf (fmaxf (ax, fmaxf (bx, cx))), sw->width);
+   y1 = swnvg__mini ((int)ceilf (fmaxf (ay, fmaxf (by, cy))), sw->height);
+   for (y = y0; y < y1; y++)
+   {
+      float py = y + 0.5f;
+      unsigned char * dst = &sw->pixels[ (y * sw->width + x0) * 4];
+      for (x = x0; x < x1; x++, dst += 4)
+      {
+         float px = x + 0.5f;
+         float w0 = (cx - bx) * (py - by) - (cy - by) * (px - bx);
+         float w1 = (ax - cx) * (py - cy) - (ay - cy) * (px - cx);
+         float w2 = (bx - ax) * (py - ay) - (by - ay) * (px - ax);
+         float u, v, alpha;
+         // Top-left rule: pixels exactly on an edge belong to top or left edges only.
+         if (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f) continue;
+         if (w0 == 0.0f && !((cy == by && cx < bx) || cy < by)) continue;
+         if (w1 == 0.0f && !((ay == cy && ax < cx) || ay < cy)) continue;
+         if (w2 == 0.0f && !((by == ay && bx < ax) || by < ay)) continue;
+         w0 /= area;
+         w1 /= area;
+         w2 /= area;
+         u = va->u * w0 + vb->u * w1 + vc->u * w2;
+         v = va->v * w0 + vb->v * w1 + vc->v * w2;
+         alpha = swnvg__scissorMask (frag, px / sx, py / sy);
+         if (alpha <= 0.0f) continue;
+         swnvg__sampleTexture (frag, u, v, color);
+         color[0] *= frag->innerCol.r;
+         color[1] *= frag->innerCol.g;
+         color[2] *= frag->innerCol.b;
+         color[3] *= frag->innerCol.a;
+         swnvg__blend (dst, color, alpha);
+      }
+   }
+}
+
+static void swnvg__renderTriangles (void * uptr, NVGpaint * paint, NVGscissor * scissor,
+                                    const NVGvertex * verts, int nverts)
+{
+   SWNVGcontext * sw = (SWNVGcontext *)uptr;
+   SWNVGpaint frag;
+   int i;
+   sw->stats.triangles++;
+   if (swnvg__convertPaint (sw, &frag, paint, scissor, 1.0f) == 0) return;
+   if (frag.tex == NULL) return;
+   frag.type = SWNVG_SHADER_IMG;
+   sw->stats.drawCalls++;
+   sw->stats.verts += nverts;
+   for (i = 0; i + 2 < nverts; i += 3)
+      swnvg__triangle (sw, &frag, &verts[i], &verts[i + 1], &verts[i + 2]);
+}
+
+static void swnvg__renderDelete (void * uptr)
+{
+   SWNVGcontext * sw = (SWNVGcontext *)uptr;
+   int i;
+   if (sw == NULL) return;
+   for (i = 0; i < sw->ntextures; i++)
+      free (sw->textures[i].data);
+   free (sw->textures);
+   free (sw->cover);
+   free (sw->pixels);
+   free (sw);
+}
+
+NVGcontext * nvgCreateSW (int width, int height)
+{
+   NVGparams params;
+   NVGcontext * ctx = NULL;
+   SWNVGcontext * sw = (SWNVGcontext *)malloc (sizeof (SWNVGcontext));
+   if (sw == NULL) goto error;
+   memset (sw, 0, sizeof (SWNVGcontext));
+   sw->pixels = (unsigned char *)malloc (width * height * 4);
+   if (sw->pixels == NULL)
+   {
+      free (sw);
+      goto error;
+   }
+   memset (sw->pixels, 0, width * height * 4);
+   sw->width = width;
+   sw->height = height;
+   sw->view[0] = (float)width;
+   sw->view[1] = (float)height;
+   memset (&params, 0, sizeof (params));
+   params.renderCreate = swnvg__renderCreate;
+   params.renderCreateTexture = swnvg__renderCreateTexture;
+   params.renderDeleteTexture = swnvg__renderDeleteTexture;
+   params.renderUpdateTexture = swnvg__renderUpdateTexture;
+   params.renderGetTextureSize = swnvg__renderGetTextureSize;
+   params.renderViewport = swnvg__renderViewport;
+   params.renderCancel = swnvg__renderCancel;
+   params.renderFlush = swnvg__renderFlush;
+   params.renderFill = swnvg__renderFill;
+   params.renderStroke = swnvg__renderStroke;
+   params.renderTriangles = swnvg__renderTriangles;
+   params.renderDelete = swnvg__renderDelete;
+   params.renderFrameStats = swnvg__renderFrameStats;
+   params.userPtr = sw;
+   // Coverage is computed analytically, no fringe geometry is needed.
+   params.edgeAntiAlias = 0;
+   ctx = nvgCreateInternal (&params);
+   if (ctx == NULL) goto error;
+   return ctx;
+error:
+   // 'sw' is freed by nvgDeleteInternal.
+   if (ctx != NULL) nvgDeleteInternal (ctx);
+   return NULL;
+}
+
+void nvgDeleteSW (NVGcontext * ctx)
+{
+   nvgDeleteInternal (ctx);
+}
+
+unsigned char * nvgswPixels (NVGcontext * ctx, int * width, int * height)
+{
+   SWNVGcontext * sw = (SWNVGcontext *)nvgInternalParams (ctx)->userPtr;
+   if (width != NULL) *width = sw->width;
+   if (height != NULL) *height = sw->height;
+   return sw->pixels;
+}
+
+void nvgswClear (NVGcontext * ctx, NVGcolor color)
+{
+   SWNVGcontext * sw = (SWNVGcontext *)nvgInternalParams (ctx)->userPtr;
+   unsigned char c[4];
+   int i;
+   c[0] = (unsigned char) (swnvg__clampf (color.r * color.a, 0.0f, 1.0f) * 255.0f + 0.5f);
+   c[1] = (unsigned char) (swnvg__clampf (color.g * color.a, 0.0f, 1.0f) * 255.0f + 0.5f);
+   c[2] = (unsigned char) (swnvg__clampf (color.b * color.a, 0.0f, 1.0f) * 255.0f + 0.5f);
+   c[3] = (unsigned char) (swnvg__clampf (color.a, 0.0f, 1.0f) * 255.0f + 0.5f);
+   for (i = 0; i < sw->width * sw->height; i++)
+      memcpy (&sw->pixels[i * 4], c, 4);
+}
+
+#endif /* NANOVG_SW_IMPLEMENTATION */
@@ -509,8 +509,19 @@ static stbi_uc * stbi__gif_load (stbi__context * s, int * x, int * y, int * comp
 static int      stbi__gif_info (stbi__context * s, int * x, int * y, int * comp);
 
 
-// this is not threadsafe
-static const char * stbi__g_failure_reason;
+// thread local, so that images can be decoded on several threads at once
+#ifndef STBI_THREAD_LOCAL
+#if defined(__cplusplus) && __cplusplus >= 201103L
+#define STBI_THREAD_LOCAL thread_local
+#elif defined(_MSC_VER)
+#define STBI_THREAD_LOCAL __declspec(thread)
+#elif defined(__GNUC__)
+#define STBI_THREAD_LOCAL __thread
+#else
+#define STBI_THREAD_LOCAL
+#endif
+#endif
+static STBI_THREAD_LOCAL const char * stbi__g_failure_reason;
 
 STBIDEF const char * stbi_failure_reason (void)
 {
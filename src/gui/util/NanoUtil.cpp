@@ -4,31 +4,137 @@
 
 #include "NanoUtil.h"
 #include "../nanovg/nanovg.h"
+#include "../nanovg/stb_image.h"
+#include "../nanogui/profiler.h"
 #include <cinder/Filesystem.h>
+#include <algorithm>
+#include <chrono>
+#include <limits>
 
 using namespace cinder;
 
 std::vector<std::pair<int, std::string>> NanoUtil::loadImageDirectory (NVGcontext * ctx, const std::string & folder)
 {
-   std::vector<std::pair<int, std::string> > result;
+   // Decode in parallel, create the images as soon as they are decoded.
+   ImageDirectoryLoader loader (ctx, folder);
+   while (!loader.done())
+   {
+      loader.wait();
+      loader.update (std::numeric_limits<double>::max());
+   }
+   return loader.images();
+}
+
+ImageDirectoryLoader::ImageDirectoryLoader (NVGcontext * ctx, const std::string & folder, int threads)
+   : mContext (ctx), mNext (0), mCancelled (false)
+{
    fs::path p (folder);
    if (!fs::is_directory (p))
-      return std::vector<std::pair<int, std::string>>();
+      return;
 
+   std::vector<std::string> paths;
    for (fs::directory_iterator it (p); it != fs::directory_iterator(); ++it)
    {
       fs::path imgPath = it->path();
       if (imgPath.extension() == ".png")
+         paths.push_back (imgPath.string());
+   }
+   std::sort (paths.begin(), paths.end());
+   mFiles.resize (paths.size());
+   for (size_t i = 0; i < paths.size(); i++)
+      mFiles[i].path = paths[i];
+
+   // Same settings as nvgCreateImage(), set before the threads start.
+   stbi_set_unpremultiply_on_load (1);
+   stbi_convert_iphone_png_to_rgb (1);
+   if (threads <= 0)
+      threads = std::max (1, (int)std::thread::hardware_concurrency());
+   threads = std::min (threads, (int)mFiles.size());
+   for (int i = 0; i < threads; i++)
+      mThreads.push_back (std::thread (&ImageDirectoryLoader::decode, this));
+}
+
+ImageDirectoryLoader::~ImageDirectoryLoader()
+{
+   cancel();
+}
+
+void ImageDirectoryLoader::decode()
+{
+   for (;;)
+   {
+      size_t i = mNext++;
+      if (i >= mFiles.size() || mCancelled)
+         break;
+      File & file = mFiles[i];
+      int w = 0, h = 0, n;
+      unsigned char * pixels;
+      {
+         nanogui::ProfileZone zone ("stbi_load");
+         pixels = stbi_load (file.path.c_str(), &w, &h, &n, 4);
+      }
       {
-         int img = nvgCreateImage (ctx, imgPath.string().c_str(), 0);
-         if (img == 0)
+         std::lock_guard<std::mutex> lock (mMutex);
+         file.pixels = pixels;
+         file.width = w;
+         file.height = h;
+         file.decoded = true;
+      }
+      mDecodedCond.notify_all();
+   }
+}
+
+int ImageDirectoryLoader::update (double budget)
+{
+   auto start = std::chrono::steady_clock::now();
+   int created = 0;
+   while (!mCancelled && mCreated < mFiles.size())
+   {
+      File & file = mFiles[mCreated];
+      {
+         std::lock_guard<std::mutex> lock (mMutex);
+         if (!file.decoded)
+            break;
+      }
+      if (file.pixels != nullptr)
+      {
+         int img = nvgCreateImageRGBA (mContext, file.width, file.height, 0, file.pixels);
+         stbi_image_free (file.pixels);
+         file.pixels = nullptr;
+         if (img != 0)
          {
-            continue;
+            mImages.push_back (std::make_pair (img, file.path.substr (0, file.path.length() - 4)));
+            created++;
          }
-         result.push_back (
-            std::make_pair (img, imgPath.string().substr (0, imgPath.string().length() - 4)));
       }
+      mCreated++;
+      std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+      if (elapsed.count() >= budget)
+         break;
    }
-   return result;
+   if (created > 0 && mCallback)
+      mCallback (mImages);
+   return created;
 }
 
+void ImageDirectoryLoader::wait()
+{
+   std::unique_lock<std::mutex> lock (mMutex);
+   mDecodedCond.wait (lock, [this]
+   {
+      return mCancelled || mCreated >= mFiles.size() || mFiles[mCreated].decoded;
+   });
+}
+
+void ImageDirectoryLoader::cancel()
+{
+   mCancelled = true;
+   for (auto & thread : mThreads)
+      thread.join();
+   mThreads.clear();
+   for (auto & file : mFiles)
+   {
+      stbi_image_free (file.pixels);
+      file.pixels = nullptr;
+   }
+}
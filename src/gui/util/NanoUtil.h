@@ -5,9 +5,85 @@
 #pragma once
 
 #include "../nanogui/common.h"
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
 
 struct NanoUtil
 {
    static std::vector<std::pair<int, std::string>> loadImageDirectory (NVGcontext * ctx, const std::string & folder);
 
 }; // end class NanoUtil
+
+/**
+   \brief Loads the PNG images of a folder in the background
+
+   The files are decoded by a pool of threads. \ref update() turns the decoded
+   ones into NanoVG images on the UI thread, in file name order, a batch per
+   frame within a time budget. The images belong to the caller, also when the
+   loading is cancelled.
+*/
+class ImageDirectoryLoader
+{
+   public:
+      typedef std::vector<std::pair<int, std::string>> Images;
+
+      /// Start decoding the PNG files of \c folder on \c threads threads (0 uses one per core)
+      ImageDirectoryLoader (NVGcontext * ctx, const std::string & folder, int threads = 0);
+      /// Cancel the loading and wait for the threads
+      ~ImageDirectoryLoader();
+
+      /// Set a function called by \ref update() with all images created so far, when it created some
+      void setCallback (const std::function<void (const Images &)> & callback)
+      {
+         mCallback = callback;
+      }
+
+      /// Create images from the decoded files until \c budget seconds have passed, return how many were created
+      int update (double budget = 0.002);
+      /// Block until another file is decoded or the loading is done
+      void wait();
+      /// Stop decoding, files not created yet are skipped
+      void cancel();
+
+      /// Return whether every file was turned into an image, or the loading was cancelled
+      bool done() const
+      {
+         return mCancelled || mCreated == mFiles.size();
+      }
+      /// Return the number of PNG files in the folder
+      int fileCount() const
+      {
+         return (int)mFiles.size();
+      }
+      /// Return the images created so far, paired with their path without extension
+      const Images & images() const
+      {
+         return mImages;
+      }
+
+   private:
+      struct File
+      {
+         std::string path;
+         unsigned char * pixels = nullptr;
+         int width = 0, height = 0;
+         bool decoded = false;
+      };
+
+      NVGcontext * mContext;
+      std::vector<File> mFiles;
+      std::vector<std::thread> mThreads;
+      std::mutex mMutex;
+      std::condition_variable mDecodedCond;
+      std::atomic<size_t> mNext;
+      std::atomic<bool> mCancelled;
+      size_t mCreated = 0;
+      Images mImages;
+      std::function<void (const Images &)> mCallback;
+
+      void decode();
+
+}; // end class ImageDirectoryLoader
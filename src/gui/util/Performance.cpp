@@ -12,62 +12,101 @@
    #include <iconv.h>
 #endif
 
-// timer query support
-#ifndef GL_ARB_timer_query
-   #define GL_TIME_ELAPSED                   0x88BF
-   //typedef void (APIENTRY *pfnGLGETQUERYOBJECTUI64V)(GLuint id, GLenum pname, GLuint64* params);
-   //pfnGLGETQUERYOBJECTUI64V glGetQueryObjectui64v = 0;
+// timer query support, core since OpenGL 3.3 and not available on OpenGL ES
+#if !defined(CINDER_GL_ES) && defined(GL_TIMESTAMP)
+   #define GPU_TIMER_QUERIES 1
+#endif
+
+#ifdef GPU_TIMER_QUERIES
+// Software rasterizers draw when they flush, their timestamps don't measure the frame
+static int isSoftwareRenderer()
+{
+   static const char * names[] = { "llvmpipe", "softpipe", "SwiftShader", "GDI Generic", "Software" };
+   const char * renderer = (const char *)glGetString (GL_RENDERER);
+   if (renderer == NULL)
+      return 1;
+   for (size_t i = 0; i < sizeof (names) / sizeof (names[0]); i++)
+   {
+      if (strstr (renderer, names[i]) != NULL)
+         return 1;
+   }
+   return 0;
+}
 #endif
 
 void initGPUTimer (GPUtimer * timer)
 {
    memset (timer, 0, sizeof (*timer));
-   /*	timer->supported = glfwExtensionSupported("GL_ARB_timer_query");
-      if (timer->supported) {*/
-   //#ifndef GL_ARB_timer_query
-   //glGetQueryObjectui64v = (pfnGLGETQUERYOBJECTUI64V)glfwGetProcAddress("glGetQueryObjectui64v");
-   ////printf("glGetQueryObjectui64v=%p\n", glGetQueryObjectui64v);
-   //if (!glGetQueryObjectui64v) {
-   //timer->supported = GL_FALSE;
-   //return;
-   //}*/
-   //#endif
-   glGenQueries (GPU_QUERY_COUNT, timer->queries);
-   //}
+#ifdef GPU_TIMER_QUERIES
+   GLint bits = 0;
+   if (isSoftwareRenderer())
+      return;
+   while (glGetError() != GL_NO_ERROR)
+      ;
+   // A counter without bits means the driver can't time
+   glGetQueryiv (GL_TIMESTAMP, GL_QUERY_COUNTER_BITS, &bits);
+   if (glGetError() != GL_NO_ERROR || bits == 0)
+      return;
+   glGenQueries (GPU_QUERY_COUNT * 2, timer->queries);
+   timer->supported = 1;
+#endif
+}
+
+void deleteGPUTimer (GPUtimer * timer)
+{
+#ifdef GPU_TIMER_QUERIES
+   if (timer->supported)
+      glDeleteQueries (GPU_QUERY_COUNT * 2, timer->queries);
+#endif
+   memset (timer, 0, sizeof (*timer));
 }
 
 void startGPUTimer (GPUtimer * timer)
 {
    if (!timer->supported)
       return;
-   glBeginQuery (GL_TIME_ELAPSED, timer->queries[timer->cur % GPU_QUERY_COUNT]);
-   timer->cur++;
+#ifdef GPU_TIMER_QUERIES
+   // All queries still in flight, skip this frame rather than stall
+   timer->skip = timer->cur - timer->ret >= GPU_QUERY_COUNT;
+   if (timer->skip)
+      return;
+   glQueryCounter (timer->queries[ (timer->cur % GPU_QUERY_COUNT) * 2], GL_TIMESTAMP);
+#endif
 }
 
 int stopGPUTimer (GPUtimer * timer, float * times, int maxTimes)
 {
-   NVG_NOTUSED (times);
-   NVG_NOTUSED (maxTimes);
-   GLint available = 1;
    int n = 0;
    if (!timer->supported)
       return 0;
-   glEndQuery (GL_TIME_ELAPSED);
-   while (available && timer->ret <= timer->cur)
+#ifdef GPU_TIMER_QUERIES
+   if (!timer->skip)
+   {
+      glQueryCounter (timer->queries[ (timer->cur % GPU_QUERY_COUNT) * 2 + 1], GL_TIMESTAMP);
+      timer->cur++;
+   }
+   // Results arrive in order, a few frames late
+   while (timer->ret < timer->cur)
    {
-      // check for results if there are any
-      glGetQueryObjectiv (timer->queries[timer->ret % GPU_QUERY_COUNT], GL_QUERY_RESULT_AVAILABLE, &available);
-      if (available)
+      unsigned int * pair = &timer->queries[ (timer->ret % GPU_QUERY_COUNT) * 2];
+      GLint available = 0;
+      glGetQueryObjectiv (pair[1], GL_QUERY_RESULT_AVAILABLE, &available);
+      if (!available)
+         break;
+      GLuint64 start = 0, stop = 0;
+      glGetQueryObjectui64v (pair[0], GL_QUERY_RESULT, &start);
+      glGetQueryObjectui64v (pair[1], GL_QUERY_RESULT, &stop);
+      timer->ret++;
+      if (n < maxTimes)
       {
-         /*			GLuint64 timeElapsed = 0;
-            glGetQueryObjectui64v(timer->queries[timer->ret % GPU_QUERY_COUNT], GL_QUERY_RESULT, &timeElapsed);
-            timer->ret++;
-            if (n < maxTimes) {
-            times[n] = (float)((double)timeElapsed * 1e-9);
-            n++;
-            }*/
+         times[n] = (float) ((double) (stop - start) * 1e-9);
+         n++;
       }
    }
+#else
+   NVG_NOTUSED (times);
+   NVG_NOTUSED (maxTimes);
+#endif
    return n;
 }
 
@@ -95,6 +134,32 @@ float getGraphAverage (PerfGraph * fps)
    return avg / (float)GRAPH_HISTORY_COUNT;
 }
 
+// Returns 1, 2 or 5 times a power of ten, at least v
+static float graphRange (float v)
+{
+   float step = 1.0f;
+   while (step * 10.0f <= v)
+      step *= 10.0f;
+   if (v <= step)
+      return step;
+   if (v <= 2.0f * step)
+      return 2.0f * step;
+   if (v <= 5.0f * step)
+      return 5.0f * step;
+   return 10.0f * step;
+}
+
+static void formatBytes (char * str, size_t size, float bytes)
+{
+   if (bytes >= 1024.0f * 1024.0f)
+      snprintf (str, size, "%.2f MB", bytes / (1024.0f * 1024.0f));
+   else
+      if (bytes >= 1024.0f)
+         snprintf (str, size, "%.1f KB", bytes / 1024.0f);
+      else
+         snprintf (str, size, "%.0f B", bytes);
+}
+
 void renderGraph (NVGcontext * vg, float x, float y, PerfGraph * fps, NVGcolor color)
 {
    int i;
@@ -135,17 +200,33 @@ void renderGraph (NVGcontext * vg, float x, float y, PerfGraph * fps, NVGcolor c
          }
       }
       else
-      {
-         for (i = 0; i < GRAPH_HISTORY_COUNT; i++)
+         if (fps->style == GRAPH_RENDER_COUNT || fps->style == GRAPH_RENDER_BYTES)
          {
-            float v = fps->values[ (fps->head + i) % GRAPH_HISTORY_COUNT] * 1000.0f;
-            float vx, vy;
-            if (v > 20.0f) v = 20.0f;
-            vx = x + ((float)i / (GRAPH_HISTORY_COUNT - 1)) * w;
-            vy = y + h - ((v / 20.0f) * h);
-            nvgLineTo (vg, vx, vy);
+            float range = 0.0f;
+            for (i = 0; i < GRAPH_HISTORY_COUNT; i++)
+               range = fps->values[i] > range ? fps->values[i] : range;
+            range = graphRange (range);
+            for (i = 0; i < GRAPH_HISTORY_COUNT; i++)
+            {
+               float v = fps->values[ (fps->head + i) % GRAPH_HISTORY_COUNT];
+               float vx, vy;
+               vx = x + ((float)i / (GRAPH_HISTORY_COUNT - 1)) * w;
+               vy = y + h - ((v / range) * h);
+               nvgLineTo (vg, vx, vy);
+            }
+         }
+         else
+         {
+            for (i = 0; i < GRAPH_HISTORY_COUNT; i++)
+            {
+               float v = fps->values[ (fps->head + i) % GRAPH_HISTORY_COUNT] * 1000.0f;
+               float vx, vy;
+               if (v > 20.0f) v = 20.0f;
+               vx = x + ((float)i / (GRAPH_HISTORY_COUNT - 1)) * w;
+               vy = y + h - ((v / 20.0f) * h);
+               nvgLineTo (vg, vx, vy);
+            }
          }
-      }
    nvgLineTo (vg, x + w, y + h);
    nvgFillColor (vg, color);
    nvgFill (vg);
@@ -180,11 +261,23 @@ void renderGraph (NVGcontext * vg, float x, float y, PerfGraph * fps, NVGcolor c
          nvgText (vg, x + w - 3, y + 1, str, NULL);
       }
       else
-      {
-         nvgFontSize (vg, 18.0f);
-         nvgTextAlign (vg, NVG_ALIGN_RIGHT | NVG_ALIGN_TOP);
-         nvgFillColor (vg, nvgRGBA (240, 240, 240, 255));
-         sprintf (str, "%.2f ms", avg * 1000.0f);
-         nvgText (vg, x + w - 3, y + 1, str, NULL);
-      }
+         if (fps->style == GRAPH_RENDER_COUNT || fps->style == GRAPH_RENDER_BYTES)
+         {
+            nvgFontSize (vg, 18.0f);
+            nvgTextAlign (vg, NVG_ALIGN_RIGHT | NVG_ALIGN_TOP);
+            nvgFillColor (vg, nvgRGBA (240, 240, 240, 255));
+            if (fps->style == GRAPH_RENDER_BYTES)
+               formatBytes (str, sizeof (str), avg);
+            else
+               sprintf (str, "%.0f", avg);
+            nvgText (vg, x + w - 3, y + 1, str, NULL);
+         }
+         else
+         {
+            nvgFontSize (vg, 18.0f);
+            nvgTextAlign (vg, NVG_ALIGN_RIGHT | NVG_ALIGN_TOP);
+            nvgFillColor (vg, nvgRGBA (240, 240, 240, 255));
+            sprintf (str, "%.2f ms", avg * 1000.0f);
+            nvgText (vg, x + w - 3, y + 1, str, NULL);
+         }
 }
@@ -15,6 +15,8 @@ enum GraphrenderStyle
    GRAPH_RENDER_FPS,
    GRAPH_RENDER_MS,
    GRAPH_RENDER_PERCENT,
+   GRAPH_RENDER_COUNT,   // Plain counts, e.g. of nvgGetFrameStats(), scaled to the largest value
+   GRAPH_RENDER_BYTES,   // Byte counts, scaled to the largest value
 };
 
 #define GRAPH_HISTORY_COUNT 100
@@ -32,17 +34,21 @@ void updateGraph (PerfGraph * fps, float frameTime);
 void renderGraph (NVGcontext * vg, float x, float y, PerfGraph * fps, NVGcolor color = nvgRGBA (128, 128, 0, 128));
 float getGraphAverage (PerfGraph * fps);
 
+// Frames a GPU time may lag behind, the queries of as many frames are in flight
 #define GPU_QUERY_COUNT 5
 struct GPUtimer
 {
    int supported;
-   int cur, ret;
-   unsigned int queries[GPU_QUERY_COUNT];
+   int cur, ret, skip;
+   unsigned int queries[GPU_QUERY_COUNT * 2];
 };
 typedef struct GPUtimer GPUtimer;
 
+// Leaves supported at 0 when the GL can't time, the other calls do nothing then
 void initGPUTimer (GPUtimer * timer);
+void deleteGPUTimer (GPUtimer * timer);
 void startGPUTimer (GPUtimer * timer);
+// Stores the GPU times in seconds of the frames whose results arrived, returns how many
 int stopGPUTimer (GPUtimer * timer, float * times, int maxTimes);
 
 #ifdef __cplusplus